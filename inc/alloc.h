@@ -0,0 +1,84 @@
+//
+// alloc.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Allocator API.
+//
+// Everything that anmat allocates (matrix and vector data, scanned values)
+// goes through an allocator. By default that is the built-in heap, but any
+// other allocator can be installed for the whole library, or given to a
+// single matrix or vector when it is allocated. A matrix or vector remembers
+// the allocator it came from and gives its memory back to that one.
+//
+//   static void *myAlloc(void *context, size_t size) { ... }
+//   ...
+//   static const AnmatAllocator_t myAllocator = {
+//     myAlloc, myAllocAligned, myRealloc, myFree, &myPool,
+//   };
+//   anmatAllocatorSet(&myAllocator);
+//
+
+#ifndef __ALLOC_H__
+#define __ALLOC_H__
+
+// Not anmat.h, which includes this before matrix.h and stat.h.
+#include <stddef.h> // size_t
+
+// -----------------------------------------------------------------------------
+// Structs
+
+// An allocator. Every function gets the context as its first argument.
+// All of the functions must be provided.
+typedef struct {
+  // Allocate size bytes. Returns NULL on failure.
+  void *(*alloc)(void *context, size_t size);
+
+  // Allocate size bytes starting on a multiple of alignment, which is a power
+  // of 2 no bigger than ANMAT_DATA_ALIGNMENT. Returns NULL on failure.
+  void *(*allocAligned)(void *context, size_t size, size_t alignment);
+
+  // Resize memory to size bytes, keeping its contents. Returns NULL on
+  // failure, in which case memory must be left alone. A size of 0 is a
+  // failure (it does not free memory).
+  void *(*realloc)(void *context, void *memory, size_t size);
+
+  // Free memory. Never called with NULL.
+  void (*free)(void *context, void *memory);
+
+  void *context;
+} AnmatAllocator_t;
+
+// The built-in heap.
+extern const AnmatAllocator_t anmatHeapAllocator;
+
+// -----------------------------------------------------------------------------
+// Installation
+
+// Use an allocator for everything that is allocated from now on without an
+// allocator of its own. A NULL allocator puts the built-in heap back.
+// Memory must be freed through the allocator that it came from, so change
+// this when nothing is allocated (or keep the old allocator around).
+// Not thread safe.
+void anmatAllocatorSet(const AnmatAllocator_t *allocator);
+
+// Get the allocator that is in use.
+const AnmatAllocator_t *anmatAllocatorGet(void);
+
+// -----------------------------------------------------------------------------
+// Allocation
+
+// Allocate, resize and free memory through an allocator, or through the
+// installed allocator if allocator is NULL.
+void *anmatAlloc(const AnmatAllocator_t *allocator, size_t size);
+void *anmatAllocAligned(const AnmatAllocator_t *allocator,
+                        size_t size,
+                        size_t alignment);
+void *anmatRealloc(const AnmatAllocator_t *allocator,
+                   void *memory,
+                   size_t size);
+void anmatFree(const AnmatAllocator_t *allocator, void *memory);
+
+#endif /* __ALLOC_H__ */
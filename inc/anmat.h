@@ -31,16 +31,40 @@ typedef enum {
 // TODO: what should this really be?
 #define ANMAT_EPSILON_DEFAULT (1e-6)
 
+// Matrix rows and vector data start on a boundary of this many bytes, so
+// vectorized code can use aligned loads and stores on them.
+#define ANMAT_DATA_ALIGNMENT (64)
+
 // How many times the square root algorithm should iterate.
 #define ANMAT_ROOT_MAX_ITERATIONS 32
 
 // Utilities API.
 #include "util.h"
 
+// Allocator API.
+#include "alloc.h"
+
+// Arena API.
+#include "arena.h"
+
+// SIMD API.
+#include "simd.h"
+
+// Thread API.
+#include "thread.h"
+
 // Matrix API.
 #include "matrix.h"
 
+// Batch API.
+#include "batch.h"
+
 // Statistics API.
 #include "stat.h"
 
+// The sparse (sparse.h), matrix-vector (gemv.h), LU (lu.h), Cholesky
+// (cholesky.h) and QR (qr.h) APIs are not included here, since they are
+// built on the matrix and vector types, and matrix.h and stat.h include this
+// first.
+
 #endif /* __ANMAT_H__ */
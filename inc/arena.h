@@ -0,0 +1,89 @@
+//
+// arena.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Arena API.
+//
+// An arena hands out memory by bumping a pointer through big chunks that it
+// maps from the OS, so it never touches the heap. Nothing is freed on its
+// own; instead, take a mark before some scratch work and reset the arena back
+// to the mark afterwards, which gives back everything allocated since the
+// mark at once. Chunks are kept around for the next allocations.
+//
+//   AnmatArenaMark_t mark = anmatArenaMark(arena);
+//   double *scratch = anmatArenaAlloc(arena, count * sizeof(double));
+//   ...
+//   anmatArenaReset(arena, mark);
+//
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include "anmat.h"
+
+// -----------------------------------------------------------------------------
+// Structs
+
+// Every allocation from an arena starts on a boundary of this many bytes.
+#define ANMAT_ARENA_ALIGNMENT (64)
+
+// The default size of the chunks that an arena maps.
+#define ANMAT_ARENA_CHUNK_SIZE_DEFAULT (1 << 16)
+
+typedef struct AnmatArenaChunk_t AnmatArenaChunk_t;
+
+typedef struct {
+  // The chunks, in the order they were mapped, and the one being bumped.
+  AnmatArenaChunk_t *first, *current;
+
+  // How many bytes of the current chunk are used.
+  size_t used;
+
+  // How big new chunks should be.
+  size_t chunkSize;
+} AnmatArena_t;
+
+// A point in an arena to reset back to.
+typedef struct {
+  AnmatArenaChunk_t *chunk;
+  size_t used;
+} AnmatArenaMark_t;
+
+// -----------------------------------------------------------------------------
+// Memory Management
+
+// Initialize an arena that maps chunks of chunkSize bytes (or of
+// ANMAT_ARENA_CHUNK_SIZE_DEFAULT bytes if chunkSize is 0).
+// No memory is mapped until the first allocation.
+AnmatStatus_t anmatArenaInit(AnmatArena_t *arena,
+                             size_t chunkSize);
+
+// Give all of the memory of an arena back to the OS.
+void anmatArenaFree(AnmatArena_t *arena);
+
+// Allocate count bytes from an arena.
+// Returns NULL on failure.
+void *anmatArenaAlloc(AnmatArena_t *arena,
+                      size_t count);
+
+// -----------------------------------------------------------------------------
+// Scopes
+
+// Remember how much of an arena is in use.
+AnmatArenaMark_t anmatArenaMark(AnmatArena_t *arena);
+
+// Give back everything allocated from an arena since mark was taken.
+// This does not depend on how many allocations there were.
+void anmatArenaReset(AnmatArena_t *arena,
+                     AnmatArenaMark_t mark);
+
+// Get the scratch arena that the library uses for its temporaries.
+// Callers may use it too, as long as every allocation is given back with
+// anmatArenaReset before control returns to the library.
+// With ANMAT_HEAP_THREAD_SAFE, each thread has its own scratch arena.
+AnmatArena_t *anmatArenaScratch(void);
+
+#endif /* __ARENA_H__ */
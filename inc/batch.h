@@ -0,0 +1,72 @@
+//
+// batch.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Batch API.
+//
+// Lots of small, independent problems of the same shape (e.g., 4 x 4
+// transforms) can be done in one call, straight from arrays of doubles (or
+// floats), without allocating a matrix for each one. The kernels work on a
+// vector of problems at a time, instead of on the values of one problem, so
+// even 3 x 3 problems fill the vectors. Square problems of size 2, 3, 4 and 8
+// have kernels of their own, with the loops unrolled all the way.
+//
+
+#ifndef __BATCH_H__
+#define __BATCH_H__
+
+#include "anmat.h"
+
+// -----------------------------------------------------------------------------
+// Layouts
+
+// How the matrices of a batch of count problems are stored. Either way, the
+// values of a matrix are numbered row by row: value (r, c) of an m x n matrix
+// is value (r * n) + c.
+typedef enum {
+  // Problem after problem ("array of structs"). Each matrix is stored whole,
+  // with no padding, and the next problem's matrix starts right after it, so
+  // value v of the m x n matrix of problem p is data[(p * m * n) + v].
+  ANMAT_BATCH_AOS = 0,
+
+  // Value after value ("struct of arrays", or interleaved). Value v of every
+  // problem is stored together, so value v of problem p is
+  // data[(v * count) + p]. This is the fastest layout, since the kernels read
+  // it as it is.
+  ANMAT_BATCH_SOA = 1,
+
+} AnmatBatchLayout_t;
+
+// -----------------------------------------------------------------------------
+// Operations
+
+// Multiply count m x k matrices in a by count k x n matrices in b, and put the
+// count m x n products in c: the product of problem p is a[p] * b[p].
+// All three are stored in the same layout. c must not overlap a or b.
+// Big batches are split up across the thread pool (see thread.h).
+// Returns ANMAT_BAD_ARG if the layout is not one of the above or m, n or k
+// is 0, and ANMAT_MEM_ERR if there is no room for the packed panels of big
+// problems (see gemm.c). Nothing is done for a count of 0.
+AnmatStatus_t anmatBatchMultiply(AnmatBatchLayout_t layout,
+                                 unsigned int count,
+                                 unsigned int m,
+                                 unsigned int n,
+                                 unsigned int k,
+                                 const double *a,
+                                 const double *b,
+                                 double *c);
+
+// The same, for floats.
+AnmatStatus_t anmatBatchMultiplyF(AnmatBatchLayout_t layout,
+                                  unsigned int count,
+                                  unsigned int m,
+                                  unsigned int n,
+                                  unsigned int k,
+                                  const float *a,
+                                  const float *b,
+                                  float *c);
+
+#endif /* __BATCH_H__ */
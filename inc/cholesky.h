@@ -0,0 +1,121 @@
+//
+// cholesky.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Cholesky API.
+//
+// Solves symmetric positive definite linear systems A * X = B (e.g., with
+// covariance matrices, or the normal equations) by factoring A into L * L',
+// where L is lower triangular. This takes half the work of an LU
+// factorization (see lu.h), and needs no pivoting. The factorization can be
+// updated when x * x' is added to (or taken away from) A, without factoring
+// it again.
+//
+
+#ifndef __CHOLESKY_H__
+#define __CHOLESKY_H__
+
+#include "anmat.h"
+#include "matrix.h"
+#include "stat.h"
+
+// -----------------------------------------------------------------------------
+// Structs
+
+// The rows of L are stored in blocks of this many.
+#define ANMAT_CHOLESKY_BLOCK (64)
+
+// The Cholesky factorization of an n x n matrix A.
+// Only the lower triangle of L is stored, a block of rows at a time: the
+// rows of a block are stored one after the other, each as long as the last
+// row of the block (so the block is a matrix, with its own stride), and the
+// next block starts right after them. That is about n^2 / 2 values, and the
+// rows of a block can still be multiplied as a matrix. Use
+// anmatCholeskyRow and anmatCholeskyData, below, to get to the values.
+typedef struct {
+  unsigned int n;
+  double *data;
+
+  // Where the data came from.
+  const AnmatAllocator_t *allocator;
+} AnmatCholesky_t;
+
+// -----------------------------------------------------------------------------
+// Factorization
+
+// Factor an n x n symmetric positive definite matrix into cholesky. Only the
+// lower triangle of the matrix (on and below its diagonal) is read, and the
+// matrix is not changed.
+// The factorization is blocked, so that most of the work is done by
+// multiplies (which are split up across the thread pool).
+// L comes from the installed allocator (see alloc.h).
+// Returns ANMAT_BAD_ARG if the matrix is not square or not positive definite,
+// and ANMAT_MEM_ERR if there is no memory for L (or for the temporaries,
+// from the scratch arena).
+AnmatStatus_t anmatCholeskyFactor(AnmatCholesky_t *cholesky,
+                                  AnmatMatrix_t *matrix);
+
+// Free a factorization back to the allocator that it came from.
+void anmatCholeskyFree(AnmatCholesky_t *cholesky);
+
+// -----------------------------------------------------------------------------
+// Operations
+
+// Solve A * matrixX = matrixB for matrixX, for every column of matrixB.
+// matrixX must already be allocated, with the same dimensions as matrixB,
+// and may be matrixB, to solve in place. Otherwise, it must not overlap it.
+// Returns ANMAT_BAD_ARG if the dimensions do not match, and ANMAT_MEM_ERR if
+// there is no room for the temporaries.
+AnmatStatus_t anmatCholeskySolve(AnmatCholesky_t *cholesky,
+                                 AnmatMatrix_t *matrixB,
+                                 AnmatMatrix_t *matrixX);
+
+// The same, for one right hand side.
+AnmatStatus_t anmatCholeskySolveVector(AnmatCholesky_t *cholesky,
+                                       AnmatVector_t *vectorB,
+                                       AnmatVector_t *vectorX);
+
+// Get the natural log of the determinant of A, which does not overflow like
+// the determinant itself would.
+double anmatCholeskyLogDeterminant(AnmatCholesky_t *cholesky);
+
+// Update the factorization to be of A + (vector * vector'), in O(n^2).
+// The vector is not changed.
+// Returns ANMAT_BAD_ARG if the vector is not n long, and ANMAT_MEM_ERR if
+// there is no room for the temporaries.
+AnmatStatus_t anmatCholeskyUpdate(AnmatCholesky_t *cholesky,
+                                  AnmatVector_t *vector);
+
+// Downdate the factorization to be of A - (vector * vector'), in O(n^2).
+// The vector is not changed.
+// Returns ANMAT_BAD_ARG if the vector is not n long, or if A would not be
+// positive definite anymore (in which case the factorization is not
+// changed), and ANMAT_MEM_ERR if there is no room for the temporaries.
+AnmatStatus_t anmatCholeskyDowndate(AnmatCholesky_t *cholesky,
+                                    AnmatVector_t *vector);
+
+// -----------------------------------------------------------------------------
+// Data Access
+
+// Get where the rows of the b'th block start, and their stride.
+#define anmatCholeskyBlockStart(b)                                            \
+  ((size_t)ANMAT_CHOLESKY_BLOCK * ANMAT_CHOLESKY_BLOCK * (b) * ((b) + 1) / 2)
+#define anmatCholeskyBlockStride(cholesky, b)                                 \
+  (((b) + 1) * ANMAT_CHOLESKY_BLOCK < (cholesky)->n                           \
+   ? ((b) + 1) * ANMAT_CHOLESKY_BLOCK                                         \
+   : (cholesky)->n)
+
+// Get pointer to the m'th row of L, which holds columns 0 through m.
+#define anmatCholeskyRow(cholesky, m)                                         \
+  ((cholesky)->data                                                           \
+   + anmatCholeskyBlockStart((m) / ANMAT_CHOLESKY_BLOCK)                      \
+   + ((size_t)((m) % ANMAT_CHOLESKY_BLOCK)                                    \
+      * anmatCholeskyBlockStride(cholesky, (m) / ANMAT_CHOLESKY_BLOCK)))
+
+// Get the value of L on the m'th row and the n'th column, for n <= m.
+#define anmatCholeskyData(cholesky, m, n) (anmatCholeskyRow(cholesky, m)[n])
+
+#endif /* __CHOLESKY_H__ */
@@ -0,0 +1,56 @@
+//
+// gemv.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Matrix-vector API.
+//
+// Multiplies a matrix by a vector straight from an AnmatMatrix_t and an
+// AnmatVector_t, reading the matrix once, row by row, without building an
+// n x 1 matrix or transposing anything. This is the inner loop of iterative
+// methods, so it should be as cheap as reading the matrix.
+//
+
+#ifndef __GEMV_H__
+#define __GEMV_H__
+
+#include "anmat.h"
+#include "matrix.h"
+#include "stat.h"
+
+// -----------------------------------------------------------------------------
+// Operations
+
+// Which matrix to multiply by: the matrix itself, or its transpose.
+typedef enum {
+  ANMAT_NO_TRANSPOSE = 0,
+  ANMAT_TRANSPOSE    = 1,
+} AnmatTranspose_t;
+
+// vectorY = (alpha * op(matrixA) * vectorX) + (beta * vectorY), where op is
+// the matrix itself or its transpose. vectorY must already be allocated, and
+// must not overlap vectorX. If beta is 0, vectorY is not read, so it does not
+// have to be initialized.
+// Big multiplies are split up by row blocks across the thread pool (see
+// thread.h).
+// Returns ANMAT_BAD_ARG if op is not one of the above or the dimensions do not
+// match, and ANMAT_MEM_ERR if there is no room for the partial sums of a
+// transposed multiply that is split up (from the scratch arena).
+AnmatStatus_t anmatMatrixVectorMultiply(AnmatTranspose_t op,
+                                        double alpha,
+                                        AnmatMatrix_t *matrixA,
+                                        AnmatVector_t *vectorX,
+                                        double beta,
+                                        AnmatVector_t *vectorY);
+
+// The same, for floats.
+AnmatStatus_t anmatMatrixVectorMultiplyF(AnmatTranspose_t op,
+                                         float alpha,
+                                         AnmatMatrixF_t *matrixA,
+                                         AnmatVectorF_t *vectorX,
+                                         float beta,
+                                         AnmatVectorF_t *vectorY);
+
+#endif /* __GEMV_H__ */
@@ -0,0 +1,114 @@
+//
+// lu.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// LU API.
+//
+// Solves square linear systems A * X = B by factoring A into P * L * U once,
+// where P is a permutation, L is lower triangular with 1's on its diagonal,
+// and U is upper triangular. The factorization can then be used to solve for
+// as many right hand sides as needed, each in O(n^2), and to get the
+// determinant and the inverse of A.
+//
+
+#ifndef __LU_H__
+#define __LU_H__
+
+#include "anmat.h"
+#include "matrix.h"
+#include "stat.h"
+
+// -----------------------------------------------------------------------------
+// Structs
+
+// The LU factorization of an n x n matrix A, with partial pivoting.
+typedef struct {
+  // L and U, in one n x n matrix: U is on and above the diagonal, and L is
+  // below it (its diagonal of 1's is not stored).
+  AnmatMatrix_t factors;
+
+  // Row i was swapped with row pivots[i] (which is no less than i), for
+  // i = 0 through n - 1, in order. These come from the same allocator as the
+  // factors.
+  unsigned int *pivots;
+
+  // -1 if there were an odd number of swaps, and 1 if there were an even
+  // number.
+  int sign;
+
+  // Whether A is singular (a value on the diagonal of U is 0), in which case
+  // the factorization can not be solved with.
+  bool singular;
+} AnmatLu_t;
+
+// -----------------------------------------------------------------------------
+// Factorization
+
+// Factor an n x n matrix into lu. The matrix is not changed.
+// The factorization is blocked: a panel of columns is factored at a time,
+// and the rest of the matrix is updated with one multiply (which is split up
+// across the thread pool), so most of the work goes as fast as a multiply.
+// A singular matrix is still factored, but lu->singular is set.
+// The factors come from the installed allocator (see alloc.h).
+// Returns ANMAT_BAD_ARG if the matrix is not square, and ANMAT_MEM_ERR if
+// there is no memory for the factors (or for the packed panels of the
+// multiplies, from the scratch arena).
+AnmatStatus_t anmatLuFactor(AnmatLu_t *lu, AnmatMatrix_t *matrix);
+
+// Free a factorization back to the allocator that it came from.
+void anmatLuFree(AnmatLu_t *lu);
+
+// -----------------------------------------------------------------------------
+// Operations
+
+// Solve A * matrixX = matrixB for matrixX, for every column of matrixB.
+// matrixX must already be allocated, with the same dimensions as matrixB,
+// and may be matrixB, to solve in place. Otherwise, it must not overlap it.
+// Returns ANMAT_BAD_ARG if A is singular or the dimensions do not match, and
+// ANMAT_MEM_ERR if there is no room for the packed panels of the multiplies.
+AnmatStatus_t anmatLuSolve(AnmatLu_t *lu,
+                           AnmatMatrix_t *matrixB,
+                           AnmatMatrix_t *matrixX);
+
+// The same, for one right hand side.
+AnmatStatus_t anmatLuSolveVector(AnmatLu_t *lu,
+                                 AnmatVector_t *vectorB,
+                                 AnmatVector_t *vectorX);
+
+// Get the determinant of A (which is 0 if A is singular).
+double anmatLuDeterminant(AnmatLu_t *lu);
+
+// Put the inverse of A into inverse, which must already be allocated, with
+// the same dimensions as A.
+// Solving with the factorization is faster, and more accurate, than
+// multiplying by the inverse.
+// Returns ANMAT_BAD_ARG if A is singular or the dimensions do not match, and
+// ANMAT_MEM_ERR if there is no room for the packed panels of the multiplies.
+AnmatStatus_t anmatLuInverse(AnmatLu_t *lu, AnmatMatrix_t *inverse);
+
+// -----------------------------------------------------------------------------
+// Triangular Solves
+
+// Which triangle of a matrix to use.
+typedef enum {
+  ANMAT_LOWER = 0,
+  ANMAT_UPPER = 1,
+} AnmatTriangle_t;
+
+// Solve T * matrixB = matrixB for matrixB in place, where T is the triangle of
+// the n x n matrixT (on and below, or on and above, its diagonal). The values
+// on the other side of the diagonal are not read. If unit is true, the
+// diagonal is taken to be all 1's, and is not read either (like L in an LU
+// factorization). matrixB must not overlap matrixT.
+// Returns ANMAT_BAD_ARG if the triangle is not one of the above, matrixT is
+// not square, or the dimensions do not match, and ANMAT_MEM_ERR if there is
+// no room for the packed panels of the multiplies.
+AnmatStatus_t anmatMatrixSolveTriangular(AnmatTriangle_t triangle,
+                                         bool unit,
+                                         AnmatMatrix_t *matrixT,
+                                         AnmatMatrix_t *matrixB);
+
+#endif /* __LU_H__ */
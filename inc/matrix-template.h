@@ -0,0 +1,184 @@
+//
+// matrix-template.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// The matrix API for one precision.
+//
+// This is included by matrix.h once per precision, with these defined:
+//   ANMAT_VALUE      - the type of a value (double or float)
+//   ANMAT_NAME(name) - the name of a function for this precision
+//   ANMAT_TYPE(name) - the name of a type for this precision
+//
+
+// -----------------------------------------------------------------------------
+// Structs
+
+// An m x n matrix.
+// The values are stored row by row in one buffer. Each row starts stride
+// values after the one before it (the leading dimension), so a row may be
+// followed by some padding.
+// A view is a matrix that looks at a block of another matrix's buffer,
+// through that matrix's stride. It can be passed anywhere a matrix can.
+typedef struct {
+  unsigned int rows, cols;
+  unsigned int stride;
+  ANMAT_VALUE *data;
+
+  // Where the data came from, or NULL if this matrix does not own it.
+  const AnmatAllocator_t *allocator;
+} ANMAT_TYPE(AnmatMatrix);
+
+// -----------------------------------------------------------------------------
+// Memory Management
+
+// Allocate a matrix with a number of rows and a number of cols.
+// The matrix comes from the installed allocator (see alloc.h), in one
+// allocation, which starts on a boundary of ANMAT_DATA_ALIGNMENT bytes. Rows
+// that are at least that long are padded so that every row starts on one.
+// The values (and padding) start out as 0.
+AnmatStatus_t ANMAT_NAME(anmatMatrixAlloc)(ANMAT_TYPE(AnmatMatrix) *matrix,
+                                           unsigned int rows,
+                                           unsigned int cols);
+
+// Allocate a matrix from a specific allocator.
+// A NULL allocator is the installed allocator.
+AnmatStatus_t
+ANMAT_NAME(anmatMatrixAllocWith)(ANMAT_TYPE(AnmatMatrix) *matrix,
+                                 unsigned int rows,
+                                 unsigned int cols,
+                                 const AnmatAllocator_t *allocator);
+
+// Free a matrix back to the allocator that it came from.
+// Freeing a view does nothing.
+void ANMAT_NAME(anmatMatrixFree)(ANMAT_TYPE(AnmatMatrix) *matrix);
+
+// -----------------------------------------------------------------------------
+// Views
+
+// Make view look at the rows x cols block of matrix that starts at row rowI
+// and column colI. Nothing is copied, so writing to the view writes to the
+// matrix. The view is only good as long as the matrix is.
+// The rows of a view are not necessarily aligned.
+// Returns ANMAT_BAD_ARG if the block is empty or does not fit in matrix.
+AnmatStatus_t ANMAT_NAME(anmatMatrixView)(ANMAT_TYPE(AnmatMatrix) *view,
+                                          ANMAT_TYPE(AnmatMatrix) *matrix,
+                                          unsigned int rowI,
+                                          unsigned int colI,
+                                          unsigned int rows,
+                                          unsigned int cols);
+
+// -----------------------------------------------------------------------------
+// Elementary operations
+
+// Returns true iff matrixA is equal to matrixB.
+bool ANMAT_NAME(anmatMatrixEquals)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                   ANMAT_TYPE(AnmatMatrix) *matrixB);
+
+// Add matrixA and matrixB and put the result inside matrixC.
+// The matrixC must already be allocated.
+AnmatStatus_t ANMAT_NAME(anmatMatrixAdd)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                         ANMAT_TYPE(AnmatMatrix) *matrixB,
+                                         ANMAT_TYPE(AnmatMatrix) *matrixC);
+
+// Subtract matrixB from matrixA and put the result inside matrixC.
+// The matrixC must already be allocated.
+AnmatStatus_t ANMAT_NAME(anmatMatrixSubtract)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                              ANMAT_TYPE(AnmatMatrix) *matrixB,
+                                              ANMAT_TYPE(AnmatMatrix) *matrixC);
+
+// The element-wise operations below read each input and write matrixC once,
+// in a single pass. The matrixC must already be allocated, and may be the
+// same as an input (but must not partly overlap one).
+
+// matrixC = alpha * matrixA.
+AnmatStatus_t ANMAT_NAME(anmatMatrixScale)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                           ANMAT_VALUE alpha,
+                                           ANMAT_TYPE(AnmatMatrix) *matrixC);
+
+// matrixC = (alpha * matrixA) + matrixB.
+AnmatStatus_t ANMAT_NAME(anmatMatrixAxpy)(ANMAT_VALUE alpha,
+                                          ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                          ANMAT_TYPE(AnmatMatrix) *matrixB,
+                                          ANMAT_TYPE(AnmatMatrix) *matrixC);
+
+// matrixC = (alpha * matrixA) + (beta * matrixB).
+AnmatStatus_t ANMAT_NAME(anmatMatrixAxpby)(ANMAT_VALUE alpha,
+                                           ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                           ANMAT_VALUE beta,
+                                           ANMAT_TYPE(AnmatMatrix) *matrixB,
+                                           ANMAT_TYPE(AnmatMatrix) *matrixC);
+
+// Multiply matrixA and matrixB value by value into matrixC.
+AnmatStatus_t
+ANMAT_NAME(anmatMatrixHadamardMultiply)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                        ANMAT_TYPE(AnmatMatrix) *matrixB,
+                                        ANMAT_TYPE(AnmatMatrix) *matrixC);
+
+// Divide matrixA by matrixB value by value into matrixC.
+AnmatStatus_t
+ANMAT_NAME(anmatMatrixHadamardDivide)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                      ANMAT_TYPE(AnmatMatrix) *matrixB,
+                                      ANMAT_TYPE(AnmatMatrix) *matrixC);
+
+// Put each value of matrixA into matrixC, but no less than low and no more
+// than high. NaN's stay NaN's.
+// Returns ANMAT_BAD_ARG if low is more than high (or either is NaN).
+AnmatStatus_t ANMAT_NAME(anmatMatrixClamp)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                           ANMAT_VALUE low,
+                                           ANMAT_VALUE high,
+                                           ANMAT_TYPE(AnmatMatrix) *matrixC);
+
+// Multiply matrixA by matrixB and put the result inside matrixC.
+// The matrixC must already be allocated, and must not overlap matrixA or
+// matrixB.
+AnmatStatus_t ANMAT_NAME(anmatMatrixMultiply)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                              ANMAT_TYPE(AnmatMatrix) *matrixB,
+                                              ANMAT_TYPE(AnmatMatrix) *matrixC);
+
+// Get a bound on the error of any value of matrixA * matrixB, as computed by
+// anmatMatrixMultiply with the current Strassen config (see matrix.h): the
+// biggest difference there can be between a value that it computes and the
+// exact value (to first order in the unit roundoff of this precision). This
+// is the norm-wise bound from Higham, "Accuracy and Stability of Numerical
+// Algorithms", 2nd ed., chapter 23, in terms of the biggest magnitudes in
+// matrixA and matrixB and the inner dimension. It is usually pessimistic, but
+// it shows how much worse Strassen-Winograd is.
+// Returns a negative number if the dimensions do not match.
+double
+ANMAT_NAME(anmatMatrixMultiplyErrorBound)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                          ANMAT_TYPE(AnmatMatrix) *matrixB);
+
+// -----------------------------------------------------------------------------
+// Matrix Operations
+
+// Build the transpose of matrixA in matrixB.
+// The matrixB must already be allocated, and must not overlap matrixA.
+AnmatStatus_t
+ANMAT_NAME(anmatMatrixTranspose)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                 ANMAT_TYPE(AnmatMatrix) *matrixB);
+
+// Transpose a matrix in place, without a second copy of it.
+// A square matrix (or view) is transposed where it is. A matrix that is not
+// square swaps its rows and cols, and its data is moved around in the memory
+// that it already has. Its rows are only padded (like anmatMatrixAlloc pads
+// them) if they still fit, and are packed together otherwise.
+// Returns ANMAT_BAD_ARG for a view that is not square, and ANMAT_MEM_ERR if
+// there is no room for the bookkeeping (one bit per value, from the scratch
+// arena) of a matrix that is not square.
+AnmatStatus_t
+ANMAT_NAME(anmatMatrixTransposeInPlace)(ANMAT_TYPE(AnmatMatrix) *matrix);
+
+// -----------------------------------------------------------------------------
+// I/O
+
+// Print a matrix to a stream.
+AnmatStatus_t ANMAT_NAME(anmatMatrixPrint)(ANMAT_TYPE(AnmatMatrix) *matrix,
+                                           FILE *stream);
+
+// Scan a matrix from a stream.
+// The matrix will be allocated for the user.
+AnmatStatus_t ANMAT_NAME(anmatMatrixScan)(ANMAT_TYPE(AnmatMatrix) *matrix,
+                                          FILE *stream);
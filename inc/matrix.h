@@ -14,24 +14,52 @@
 #include "anmat.h"
 
 // -----------------------------------------------------------------------------
-// Structs
-
-// An m x n matrix.
-typedef struct {
-  unsigned int rows, cols;
-  double **data;
-} AnmatMatrix_t;
+// Precisions
+
+// Matrices come in two precisions. An AnmatMatrix_t holds doubles, and an
+// AnmatMatrixF_t holds floats, which take half the memory and fill vectors
+// twice as fast. Every anmatMatrix function has a float version with an F on
+// the end (e.g., anmatMatrixMultiplyF), and the macros below work on both.
+// Both are declared (and implemented) from the same template, so they always
+// have the same API. See matrix-template.h for the documentation.
+
+#define ANMAT_VALUE      double
+#define ANMAT_NAME(name) name
+#define ANMAT_TYPE(name) name ## _t
+#include "matrix-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_NAME
+#undef ANMAT_TYPE
+
+#define ANMAT_VALUE      float
+#define ANMAT_NAME(name) name ## F
+#define ANMAT_TYPE(name) name ## F_t
+#include "matrix-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_NAME
+#undef ANMAT_TYPE
+
+// Convert a matrix of doubles to floats (rounding to the nearest float), and
+// back. The destination must already be allocated, with the same dimensions.
+// Returns ANMAT_BAD_ARG if the dimensions do not match.
+AnmatStatus_t anmatMatrixToFloat(AnmatMatrix_t *matrix,
+                                 AnmatMatrixF_t *matrixF);
+AnmatStatus_t anmatMatrixToDouble(AnmatMatrixF_t *matrixF,
+                                  AnmatMatrix_t *matrix);
 
 // -----------------------------------------------------------------------------
-// Memory Management
-
-// Allocate a matrix with a number of rows and a number of cols.
-AnmatStatus_t anmatMatrixAlloc(AnmatMatrix_t *matrix,
-                               unsigned int rows,
-                               unsigned int cols);
-
-// Free a matrix from the heap.
-void anmatMatrixFree(AnmatMatrix_t *matrix);
+// Views
+
+// Views of rows rowI to rowI + rows - 1, and of columns colI to
+// colI + cols - 1.
+#define anmatMatrixRowRange(view, matrix, rowI, rows) \
+  anmatMatrixView(view, matrix, rowI, 0, rows, (matrix)->cols)
+#define anmatMatrixColRange(view, matrix, colI, cols) \
+  anmatMatrixView(view, matrix, 0, colI, (matrix)->rows, cols)
+#define anmatMatrixRowRangeF(view, matrix, rowI, rows) \
+  anmatMatrixViewF(view, matrix, rowI, 0, rows, (matrix)->cols)
+#define anmatMatrixColRangeF(view, matrix, colI, cols) \
+  anmatMatrixViewF(view, matrix, 0, colI, (matrix)->rows, cols)
 
 // -----------------------------------------------------------------------------
 // Data Access
@@ -41,54 +69,48 @@ void anmatMatrixFree(AnmatMatrix_t *matrix);
 #define anmatMatrixColCount(matrix) ((matrix)->cols)
 
 // Get pointer to the m'th row.
-#define anmatMatrixRow(matrix, m) ((matrix)->data[m])
+#define anmatMatrixRow(matrix, m) \
+  ((matrix)->data + ((size_t)(m) * (matrix)->stride))
 
 // Get the value on the m'th row and the n'th column.
-#define anmatMatrixData(matrix, m, n) ((matrix)->data[m][n])
+#define anmatMatrixData(matrix, m, n) (anmatMatrixRow(matrix, m)[n])
 
 // -----------------------------------------------------------------------------
-// Elementary operations
-
-// Returns true iff matrixA is equal to matrixB.
-bool anmatMatrixEquals(AnmatMatrix_t *matrixA,
-                       AnmatMatrix_t *matrixB);
-
-// Add matrixA and matrixB and put the result inside matrixC.
-// The matrixC must already be allocated.
-AnmatStatus_t anmatMatrixAdd(AnmatMatrix_t *matrixA,
-                             AnmatMatrix_t *matrixB,
-                             AnmatMatrix_t *matrixC);
-
-// Subtract matrixB from matrixA and put the result inside matrixC.
-// The matrixC must already be allocated.
-AnmatStatus_t anmatMatrixSubtract(AnmatMatrix_t *matrixA,
-                                  AnmatMatrix_t *matrixB,
-                                  AnmatMatrix_t *matrixC);
-
-// Multiply matrixA by matrixB and put the result inside matrixC.
-// The matrixC must already be allocated.
-AnmatStatus_t anmatMatrixMultiply(AnmatMatrix_t *matrixA,
-                                  AnmatMatrix_t *matrixB,
-                                  AnmatMatrix_t *matrixC);
+// Strassen
 
-// -----------------------------------------------------------------------------
-// Matrix Operations
-
-// Build the transpose of matrixA in matrixB.
-// The matrixB must already be allocated.
-AnmatStatus_t anmatMatrixTranspose(AnmatMatrix_t *matrixA,
-                                   AnmatMatrix_t *matrixB);
+// Multiplies can use the Strassen-Winograd algorithm, which splits a multiply
+// into 7 (instead of 8) multiplies of half the size, over and over, until the
+// pieces are no bigger than a crossover. This is faster for big matrices, but
+// the error can be a lot bigger than with the usual algorithm, so it is off
+// by default. See anmatMatrixMultiplyErrorBound.
+// The config is the same for both precisions.
 
-// -----------------------------------------------------------------------------
-// I/O
+// The default size below which a multiply is done the usual way.
+#define ANMAT_STRASSEN_CROSSOVER_DEFAULT (512)
 
-// Print a matrix to a stream.
-AnmatStatus_t anmatMatrixPrint(AnmatMatrix_t *matrix,
-                               FILE *stream);
+// The smallest crossover allowed.
+#define ANMAT_STRASSEN_CROSSOVER_MIN (16)
 
-// Scan a matrix from a stream.
-// The matrix will be allocated for the user.
-AnmatStatus_t anmatMatrixScan(AnmatMatrix_t *matrix,
-                              FILE *stream);
+typedef struct {
+  // Whether multiplies should use Strassen-Winograd.
+  bool enabled;
+
+  // A multiply is only split up while the rows and cols of A and B are all
+  // bigger than this.
+  unsigned int crossover;
+} AnmatStrassenConfig_t;
+
+#define ANMAT_STRASSEN_CONFIG_DEFAULT \
+  { false, ANMAT_STRASSEN_CROSSOVER_DEFAULT, }
+
+// Set how multiplies should use Strassen-Winograd.
+// A NULL config means ANMAT_STRASSEN_CONFIG_DEFAULT.
+// Returns ANMAT_BAD_ARG if the crossover is less than
+// ANMAT_STRASSEN_CROSSOVER_MIN.
+// Not thread safe.
+AnmatStatus_t anmatMatrixStrassenSet(const AnmatStrassenConfig_t *config);
+
+// Get how multiplies use Strassen-Winograd.
+void anmatMatrixStrassenGet(AnmatStrassenConfig_t *config);
 
 #endif /* __MATRIX_H__ */
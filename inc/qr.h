@@ -0,0 +1,100 @@
+//
+// qr.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// QR API.
+//
+// Solves least squares problems, finding the X that makes A * X closest to B
+// for an m x n matrix A with m >= n, by factoring A into Q * R, where Q is
+// orthogonal and R is upper triangular. This is more accurate than solving
+// the normal equations (A' * A * X = A' * B), which squares the condition
+// number of A. The factorization can be used to solve for as many right hand
+// sides as needed.
+//
+
+#ifndef __QR_H__
+#define __QR_H__
+
+#include "anmat.h"
+#include "matrix.h"
+#include "stat.h"
+
+// -----------------------------------------------------------------------------
+// Structs
+
+// The QR factorization of an m x n matrix A, with m >= n.
+// Q is the product of n Householder reflections, Q = H(0) * ... * H(n - 1),
+// where H(j) = I - (tau[j] * v * v') for a vector v that is 0 above row j and
+// 1 on it.
+typedef struct {
+  // R and Q, in one m x n matrix: R is on and above the diagonal, and the
+  // vector v of H(j) is below the diagonal in column j (its 1 is not stored).
+  AnmatMatrix_t factors;
+
+  // The n tau's. These come from the same allocator as the factors.
+  double *tau;
+} AnmatQr_t;
+
+// How to solve a least squares problem (see anmatLeastSquares).
+typedef enum {
+  // Factor A with anmatQrFactor, and solve with the factorization.
+  ANMAT_QR_BLOCKED = 0,
+
+  // Factor blocks of the rows of A (and B) on their own, across the thread
+  // pool, and then factor the R's of the blocks, stacked up, into the R of A
+  // (TSQR, or tall skinny QR). This is the faster way for very tall
+  // matrices, since the blocks are factored at the same time.
+  ANMAT_QR_TSQR = 1,
+
+} AnmatQrMode_t;
+
+// -----------------------------------------------------------------------------
+// Factorization
+
+// Factor an m x n matrix into qr, with m >= n. The matrix is not changed.
+// The factorization is blocked: a panel of columns is factored at a time,
+// and its reflections are put together (in compact WY form, as
+// I - (V * T * V')) so that they can be applied to the rest of the matrix
+// with multiplies (which are split up across the thread pool).
+// The factors come from the installed allocator (see alloc.h).
+// Returns ANMAT_BAD_ARG if the matrix has more cols than rows, and
+// ANMAT_MEM_ERR if there is no memory for the factors (or for the
+// temporaries, from the scratch arena).
+AnmatStatus_t anmatQrFactor(AnmatQr_t *qr, AnmatMatrix_t *matrix);
+
+// Free a factorization back to the allocator that it came from.
+void anmatQrFree(AnmatQr_t *qr);
+
+// -----------------------------------------------------------------------------
+// Operations
+
+// Find the n x k matrixX that makes A * matrixX closest to the m x k matrixB
+// (in the least squares sense, column by column). matrixB is not changed.
+// matrixX must already be allocated.
+// Returns ANMAT_BAD_ARG if A is rank deficient (a value on the diagonal of R
+// is 0) or the dimensions do not match, and ANMAT_MEM_ERR if there is no
+// room for the temporaries.
+AnmatStatus_t anmatQrSolve(AnmatQr_t *qr,
+                           AnmatMatrix_t *matrixB,
+                           AnmatMatrix_t *matrixX);
+
+// The same, for one right hand side.
+AnmatStatus_t anmatQrSolveVector(AnmatQr_t *qr,
+                                 AnmatVector_t *vectorB,
+                                 AnmatVector_t *vectorX);
+
+// Find the n x k matrixX that makes matrixA * matrixX closest to the m x k
+// matrixB, without keeping a factorization around. See AnmatQrMode_t for the
+// modes. Neither matrixA nor matrixB is changed.
+// Returns ANMAT_BAD_ARG if the mode is not one of the above, matrixA has
+// more cols than rows, matrixA is rank deficient or the dimensions do not
+// match, and ANMAT_MEM_ERR if there is no room for the temporaries.
+AnmatStatus_t anmatLeastSquares(AnmatQrMode_t mode,
+                                AnmatMatrix_t *matrixA,
+                                AnmatMatrix_t *matrixB,
+                                AnmatMatrix_t *matrixX);
+
+#endif /* __QR_H__ */
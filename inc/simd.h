@@ -0,0 +1,56 @@
+//
+// simd.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// SIMD API.
+//
+// The inner loops of the library (the multiply micro kernel, batched
+// multiplies, element-wise operations, transpose, dot products and sums) come
+// in a few versions, one for each level of SIMD instructions. The best level
+// that the processor supports is picked when the program starts. It can be
+// forced to something else with anmatSimdLevelSet, or by setting the
+// ANMAT_SIMD_LEVEL environment variable to the name of a level (e.g.,
+// ANMAT_SIMD_LEVEL=portable) before the program starts.
+//
+
+#ifndef __SIMD_H__
+#define __SIMD_H__
+
+#include "anmat.h"
+
+// -----------------------------------------------------------------------------
+// Levels
+
+typedef enum {
+  // The best level that the processor supports.
+  ANMAT_SIMD_AUTO     = 0,
+
+  // Portable C ("portable"). Runs anywhere.
+  ANMAT_SIMD_PORTABLE = 1,
+
+  // AVX2 and FMA ("avx2").
+  ANMAT_SIMD_AVX2     = 2,
+
+  // AVX-512F ("avx512").
+  ANMAT_SIMD_AVX512   = 3,
+
+} AnmatSimdLevel_t;
+
+// Use the kernels for a level.
+// Returns ANMAT_BAD_ARG if the processor does not support the level.
+// Not thread safe.
+AnmatStatus_t anmatSimdLevelSet(AnmatSimdLevel_t level);
+
+// Get the level in use. Never ANMAT_SIMD_AUTO.
+AnmatSimdLevel_t anmatSimdLevelGet(void);
+
+// Returns true iff the processor supports a level.
+bool anmatSimdLevelSupported(AnmatSimdLevel_t level);
+
+// Get the name of a level, or NULL for a bad level.
+const char *anmatSimdLevelName(AnmatSimdLevel_t level);
+
+#endif /* __SIMD_H__ */
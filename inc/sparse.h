@@ -0,0 +1,132 @@
+//
+// sparse.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Sparse matrix API.
+//
+// A sparse matrix only stores its nonzeros, so its memory (and the time that
+// it takes to multiply by it) goes with how many nonzeros it has, not with
+// rows x cols. It can be multiplied by a dense vector, a dense matrix or
+// another sparse matrix, and converted to and from a dense matrix.
+//
+
+#ifndef __SPARSE_H__
+#define __SPARSE_H__
+
+#include "anmat.h"
+#include "matrix.h"
+#include "stat.h"
+
+// -----------------------------------------------------------------------------
+// Structs
+
+// How the nonzeros of a sparse matrix are stored.
+typedef enum {
+  // Compressed sparse row: the nonzeros are stored row by row. This is the
+  // faster format to multiply by, since each row of the product only reads
+  // one row of the matrix.
+  ANMAT_SPARSE_CSR = 0,
+
+  // Compressed sparse column: the nonzeros are stored column by column.
+  ANMAT_SPARSE_CSC = 1,
+
+} AnmatSparseFormat_t;
+
+// A rows x cols sparse matrix, with count nonzeros.
+// In CSR, the nonzeros of row r are values[starts[r]] through
+// values[starts[r + 1] - 1], and indices holds their columns, from left to
+// right. In CSC, the same goes for columns and rows. Each row (or column)
+// has at most one value at each index.
+// All three arrays are in one allocation.
+typedef struct {
+  AnmatSparseFormat_t format;
+  unsigned int rows, cols;
+  size_t count;
+
+  size_t *starts;
+  unsigned int *indices;
+  double *values;
+
+  // Where the arrays came from.
+  const AnmatAllocator_t *allocator;
+} AnmatSparse_t;
+
+// -----------------------------------------------------------------------------
+// Memory Management
+
+// Build a sparse matrix from count (rowIs[i], colIs[i], values[i]) triplets,
+// in any order. Values at the same row and column are added together.
+// The arrays come from the installed allocator (see alloc.h).
+// Returns ANMAT_BAD_ARG if the format is not one of the above, rows or cols is
+// 0, or a triplet is outside of the matrix, and ANMAT_MEM_ERR if there is no
+// memory for the matrix (or for the temporaries, from the scratch arena).
+AnmatStatus_t anmatSparseFromTriplets(AnmatSparse_t *sparse,
+                                      AnmatSparseFormat_t format,
+                                      unsigned int rows,
+                                      unsigned int cols,
+                                      size_t count,
+                                      const unsigned int *rowIs,
+                                      const unsigned int *colIs,
+                                      const double *values);
+
+// Build a sparse matrix from the nonzeros of a dense matrix.
+AnmatStatus_t anmatSparseFromDense(AnmatSparse_t *sparse,
+                                   AnmatSparseFormat_t format,
+                                   AnmatMatrix_t *matrix);
+
+// Build a copy of a sparse matrix in another (or the same) format.
+AnmatStatus_t anmatSparseConvert(AnmatSparse_t *sparse,
+                                 AnmatSparseFormat_t format,
+                                 AnmatSparse_t *converted);
+
+// Free a sparse matrix back to the allocator that it came from.
+void anmatSparseFree(AnmatSparse_t *sparse);
+
+// Write a sparse matrix into a dense matrix, zeros and all.
+// The matrix must already be allocated, with the same dimensions.
+// Returns ANMAT_BAD_ARG if the dimensions do not match.
+AnmatStatus_t anmatSparseToDense(AnmatSparse_t *sparse,
+                                 AnmatMatrix_t *matrix);
+
+// -----------------------------------------------------------------------------
+// Operations
+
+// The multiplies below split big products up across the thread pool (see
+// thread.h). Each returns ANMAT_BAD_ARG if the dimensions do not match.
+
+// vectorY = sparse * vectorX.
+// vectorY must already be allocated, and must not overlap vectorX.
+AnmatStatus_t anmatSparseMultiplyVector(AnmatSparse_t *sparse,
+                                        AnmatVector_t *vectorX,
+                                        AnmatVector_t *vectorY);
+
+// matrixC = sparse * matrixB.
+// matrixC must already be allocated, and must not overlap matrixB.
+AnmatStatus_t anmatSparseMultiplyDense(AnmatSparse_t *sparse,
+                                       AnmatMatrix_t *matrixB,
+                                       AnmatMatrix_t *matrixC);
+
+// sparseC = sparseA * sparseB.
+// sparseA and sparseB must be in the same format, and sparseC is built in it
+// too (see anmatSparseConvert). Values that cancel out to 0 are kept.
+// Returns ANMAT_BAD_ARG if the formats are not the same, and ANMAT_MEM_ERR
+// if there is no memory for sparseC (or for the temporaries, from the
+// scratch arena).
+AnmatStatus_t anmatSparseMultiply(AnmatSparse_t *sparseA,
+                                  AnmatSparse_t *sparseB,
+                                  AnmatSparse_t *sparseC);
+
+// -----------------------------------------------------------------------------
+// Data Access
+
+// Get count of rows and cols.
+#define anmatSparseRowCount(sparse) ((sparse)->rows)
+#define anmatSparseColCount(sparse) ((sparse)->cols)
+
+// Get count of nonzeros.
+#define anmatSparseCount(sparse) ((sparse)->count)
+
+#endif /* __SPARSE_H__ */
@@ -0,0 +1,53 @@
+//
+// stat-template.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// The statistics API for one precision.
+//
+// This is included by stat.h once per precision, with the same macros as
+// matrix-template.h.
+//
+
+// -----------------------------------------------------------------------------
+// Structs
+
+typedef struct {
+  unsigned int count;
+  ANMAT_VALUE *data;
+
+  // Where the data came from.
+  const AnmatAllocator_t *allocator;
+} ANMAT_TYPE(AnmatVector);
+
+// -----------------------------------------------------------------------------
+// Memory Management
+
+// Allocate a vector.
+// The vector comes from the installed allocator (see alloc.h).
+AnmatStatus_t ANMAT_NAME(anmatVectorAlloc)(ANMAT_TYPE(AnmatVector) *vector,
+                                           unsigned int count);
+
+// Allocate a vector from a specific allocator.
+// A NULL allocator is the installed allocator.
+AnmatStatus_t
+ANMAT_NAME(anmatVectorAllocWith)(ANMAT_TYPE(AnmatVector) *vector,
+                                 unsigned int count,
+                                 const AnmatAllocator_t *allocator);
+
+// Free a vector back to the allocator that it came from.
+void ANMAT_NAME(anmatVectorFree)(ANMAT_TYPE(AnmatVector) *vector);
+
+// -----------------------------------------------------------------------------
+// Elementary Operations
+
+// Calculate the average of the data in the vector.
+ANMAT_VALUE ANMAT_NAME(anmatStatAverage)(ANMAT_TYPE(AnmatVector) *vector);
+
+// Calculate the dot product of two vectors.
+// Returns ANMAT_BAD_ARG if the vectors are not the same length.
+AnmatStatus_t ANMAT_NAME(anmatVectorDot)(ANMAT_TYPE(AnmatVector) *vectorA,
+                                         ANMAT_TYPE(AnmatVector) *vectorB,
+                                         ANMAT_VALUE *dot);
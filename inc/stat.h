@@ -14,22 +14,35 @@
 #include "anmat.h"
 
 // -----------------------------------------------------------------------------
-// Structs
-
-typedef struct {
-  unsigned int count;
-  double *data;
-} AnmatVector_t;
-
-// -----------------------------------------------------------------------------
-// Memory Management
-
-// Allocate a vector.
-AnmatStatus_t anmatVectorAlloc(AnmatVector_t *vector,
-                               unsigned int count);
-
-// Free a vector.
-void anmatVectorFree(AnmatVector_t *vector);
+// Precisions
+
+// Like matrices (see matrix.h), an AnmatVector_t holds doubles and an
+// AnmatVectorF_t holds floats, and every function has a float version with
+// an F on the end. See stat-template.h for the documentation.
+
+#define ANMAT_VALUE      double
+#define ANMAT_NAME(name) name
+#define ANMAT_TYPE(name) name ## _t
+#include "stat-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_NAME
+#undef ANMAT_TYPE
+
+#define ANMAT_VALUE      float
+#define ANMAT_NAME(name) name ## F
+#define ANMAT_TYPE(name) name ## F_t
+#include "stat-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_NAME
+#undef ANMAT_TYPE
+
+// Convert a vector of doubles to floats (rounding to the nearest float), and
+// back. The destination must already be allocated, with the same count.
+// Returns ANMAT_BAD_ARG if the counts do not match.
+AnmatStatus_t anmatVectorToFloat(AnmatVector_t *vector,
+                                 AnmatVectorF_t *vectorF);
+AnmatStatus_t anmatVectorToDouble(AnmatVectorF_t *vectorF,
+                                  AnmatVector_t *vector);
 
 // -----------------------------------------------------------------------------
 // Data Access
@@ -40,10 +53,4 @@ void anmatVectorFree(AnmatVector_t *vector);
 // Get the n'th value in the data.
 #define anmatVectorData(vector, n) ((vector)->data[n])
 
-// -----------------------------------------------------------------------------
-// Elementary Operations
-
-// Calculate the average of the data in the vector.
-double anmatStatAverage(AnmatVector_t *vector);
-
 #endif /* __STAT_H__ */
@@ -0,0 +1,56 @@
+//
+// thread.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Thread API.
+//
+// Big matrix operations (multiply, add and subtract, transpose) are split up
+// across a pool of threads. Each thread works on its own tiles of the output,
+// and every value of the output is computed the same way no matter how many
+// threads there are, so the results do not depend on the thread count.
+//
+// Operations with less than a threshold of work per thread stay on the
+// calling thread, since waking up the pool costs more than it saves.
+//
+// The thread count defaults to the number of online processors. It can be
+// changed with anmatThreadCountSet, or by setting the ANMAT_THREADS
+// environment variable (e.g., ANMAT_THREADS=1) before the program starts.
+//
+// The pool only ever hands the threads memory that was allocated by the
+// calling thread, so this works without ANMAT_HEAP_THREAD_SAFE.
+//
+
+#ifndef __THREAD_H__
+#define __THREAD_H__
+
+#include "anmat.h"
+
+// The most threads that an operation can be split across.
+#define ANMAT_THREAD_MAX (256)
+
+// The default for the least work that is worth a thread: about a
+// millisecond. Work is counted in values of the output for add, subtract and
+// transpose, and in multiply-adds for multiply.
+#define ANMAT_THREAD_THRESHOLD_DEFAULT (1 << 20)
+
+// Split operations across count threads, including the calling thread.
+// A count of 0 means one per online processor, and 1 means never split.
+// Returns ANMAT_BAD_ARG if count is bigger than ANMAT_THREAD_MAX.
+// Not thread safe.
+AnmatStatus_t anmatThreadCountSet(unsigned int count);
+
+// Get the thread count. Never 0.
+unsigned int anmatThreadCountGet(void);
+
+// Only give a thread work if it gets at least this much of it.
+// A threshold of 0 means ANMAT_THREAD_THRESHOLD_DEFAULT.
+// Not thread safe.
+void anmatThreadThresholdSet(size_t work);
+
+// Get the threshold.
+size_t anmatThreadThresholdGet(void);
+
+#endif /* __THREAD_H__ */
@@ -0,0 +1,102 @@
+//
+// alloc.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Allocator API.
+//
+
+#include "alloc.h"
+#include "src/heap.h"
+
+#include <limits.h> // UINT_MAX
+
+// -----------------------------------------------------------------------------
+// Built-in Heap
+
+// The heap counts bytes with an unsigned int.
+#define heapSizeOk(size) ((size) <= UINT_MAX)
+
+static void *heapAllocator(void *context, size_t size)
+{
+  return (heapSizeOk(size) ? heapAlloc(size) : NULL);
+}
+
+static void *heapAllocatorAligned(void *context,
+                                  size_t size,
+                                  size_t alignment)
+{
+  return (heapSizeOk(size) ? heapAllocAligned(size, alignment) : NULL);
+}
+
+// heapRealloc frees memory for a size of 0, but NULL from an allocator means
+// that memory was left alone, so a size of 0 fails instead.
+static void *heapAllocatorRealloc(void *context, void *memory, size_t size)
+{
+  return (size && heapSizeOk(size) ? heapRealloc(memory, size) : NULL);
+}
+
+static void heapAllocatorFree(void *context, void *memory)
+{
+  heapFree(memory);
+}
+
+const AnmatAllocator_t anmatHeapAllocator = {
+  heapAllocator,
+  heapAllocatorAligned,
+  heapAllocatorRealloc,
+  heapAllocatorFree,
+  NULL,
+};
+
+static const AnmatAllocator_t *currentAllocator = &anmatHeapAllocator;
+
+#define resolve(allocator) ((allocator) ? (allocator) : currentAllocator)
+
+// -----------------------------------------------------------------------------
+// Installation
+
+void anmatAllocatorSet(const AnmatAllocator_t *allocator)
+{
+  currentAllocator = (allocator ? allocator : &anmatHeapAllocator);
+}
+
+const AnmatAllocator_t *anmatAllocatorGet(void)
+{
+  return currentAllocator;
+}
+
+// -----------------------------------------------------------------------------
+// Allocation
+
+void *anmatAlloc(const AnmatAllocator_t *allocator, size_t size)
+{
+  allocator = resolve(allocator);
+  return allocator->alloc(allocator->context, size);
+}
+
+void *anmatAllocAligned(const AnmatAllocator_t *allocator,
+                        size_t size,
+                        size_t alignment)
+{
+  allocator = resolve(allocator);
+  return allocator->allocAligned(allocator->context, size, alignment);
+}
+
+void *anmatRealloc(const AnmatAllocator_t *allocator,
+                   void *memory,
+                   size_t size)
+{
+  allocator = resolve(allocator);
+  return allocator->realloc(allocator->context, memory, size);
+}
+
+void anmatFree(const AnmatAllocator_t *allocator, void *memory)
+{
+  allocator = resolve(allocator);
+  if (memory) {
+    allocator->free(allocator->context, memory);
+  }
+}
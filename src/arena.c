@@ -0,0 +1,189 @@
+//
+// arena.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Arena API.
+//
+
+#include "arena.h"
+
+#include <sys/mman.h> // mmap(), munmap()
+#include <unistd.h>   // sysconf()
+
+//#define ARENA_DEBUG
+#ifdef ARENA_DEBUG
+  #define note(...) printf(__VA_ARGS__), fflush(0);
+#else
+  #define note(...)
+#endif
+
+// -----------------------------------------------------------------------------
+// Private Functionality
+
+#define alignUp(value, alignment) \
+  (((value) + ((alignment) - 1)) & ~((size_t)(alignment) - 1))
+
+// Each chunk is one mapping. Its header is padded out to the alignment, so
+// the first allocation from a chunk starts right after it.
+struct AnmatArenaChunk_t {
+  AnmatArenaChunk_t *next;
+  size_t size;
+} __attribute__((aligned(ANMAT_ARENA_ALIGNMENT)));
+
+#define chunkData(chunk) ((unsigned char *)((chunk) + 1))
+
+static AnmatArenaChunk_t *mapChunk(size_t size)
+{
+  AnmatArenaChunk_t *chunk;
+  size_t mapSize = alignUp(sizeof(AnmatArenaChunk_t) + size,
+                           sysconf(_SC_PAGESIZE));
+
+  chunk = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON,
+               -1, 0);
+  if (chunk == MAP_FAILED) {
+    return NULL;
+  }
+
+  chunk->next = NULL;
+  chunk->size = mapSize - sizeof(AnmatArenaChunk_t);
+
+  note("anmatArena: mapped %zu byte chunk at 0x%p\n", chunk->size, chunk);
+
+  return chunk;
+}
+
+// Move on to a chunk with room for count bytes, mapping one if the chunks
+// after the current one are too small.
+static AnmatArenaChunk_t *nextChunk(AnmatArena_t *arena, size_t count)
+{
+  AnmatArenaChunk_t *chunk;
+
+  if (arena->current && arena->current->next
+      && arena->current->next->size >= count) {
+    chunk = arena->current->next;
+  } else {
+    chunk = mapChunk(count > arena->chunkSize ? count : arena->chunkSize);
+    if (chunk) {
+      if (arena->current) {
+        chunk->next = arena->current->next;
+        arena->current->next = chunk;
+      } else {
+        chunk->next = arena->first;
+        arena->first = chunk;
+      }
+    }
+  }
+
+  if (chunk) {
+    arena->current = chunk;
+    arena->used = 0;
+  }
+
+  return chunk;
+}
+
+#ifdef ANMAT_HEAP_THREAD_SAFE
+
+#include <pthread.h>
+
+static __thread AnmatArena_t scratch;
+static __thread bool scratchInitialized = false;
+
+static pthread_once_t scratchOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t scratchKey;
+
+static void freeScratch(void *arena)
+{
+  anmatArenaFree((AnmatArena_t *)arena);
+}
+
+static void createScratchKey(void)
+{
+  pthread_key_create(&scratchKey, freeScratch);
+}
+
+#else
+
+static AnmatArena_t scratch;
+static bool scratchInitialized = false;
+
+#endif /* ANMAT_HEAP_THREAD_SAFE */
+
+// -----------------------------------------------------------------------------
+// Memory Management
+
+AnmatStatus_t anmatArenaInit(AnmatArena_t *arena,
+                             size_t chunkSize)
+{
+  arena->first = arena->current = NULL;
+  arena->used = 0;
+  arena->chunkSize = alignUp(chunkSize ? chunkSize : ANMAT_ARENA_CHUNK_SIZE_DEFAULT,
+                             ANMAT_ARENA_ALIGNMENT);
+
+  return ANMAT_SUCCESS;
+}
+
+void anmatArenaFree(AnmatArena_t *arena)
+{
+  AnmatArenaChunk_t *chunk;
+
+  while ((chunk = arena->first)) {
+    arena->first = chunk->next;
+    munmap(chunk, sizeof(AnmatArenaChunk_t) + chunk->size);
+  }
+
+  arena->current = NULL;
+  arena->used = 0;
+}
+
+void *anmatArenaAlloc(AnmatArena_t *arena,
+                      size_t count)
+{
+  void *alloc = NULL;
+
+  if (count) {
+    count = alignUp(count, ANMAT_ARENA_ALIGNMENT);
+    if ((arena->current && arena->current->size - arena->used >= count)
+        || nextChunk(arena, count)) {
+      alloc = chunkData(arena->current) + arena->used;
+      arena->used += count;
+    }
+  }
+
+  return alloc;
+}
+
+// -----------------------------------------------------------------------------
+// Scopes
+
+AnmatArenaMark_t anmatArenaMark(AnmatArena_t *arena)
+{
+  AnmatArenaMark_t mark = { arena->current, arena->used, };
+  return mark;
+}
+
+void anmatArenaReset(AnmatArena_t *arena,
+                     AnmatArenaMark_t mark)
+{
+  // A mark taken before the first chunk was mapped resets to the start of the
+  // first chunk.
+  arena->current = (mark.chunk ? mark.chunk : arena->first);
+  arena->used    = (mark.chunk ? mark.used : 0);
+}
+
+AnmatArena_t *anmatArenaScratch(void)
+{
+  if (!scratchInitialized) {
+    anmatArenaInit(&scratch, 0);
+    scratchInitialized = true;
+#ifdef ANMAT_HEAP_THREAD_SAFE
+    pthread_once(&scratchOnce, createScratchKey);
+    pthread_setspecific(scratchKey, &scratch);
+#endif
+  }
+
+  return &scratch;
+}
@@ -0,0 +1,128 @@
+//
+// batch-template.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// The batch API for one precision.
+//
+// This is included by batch.c once per precision, with the same macros as
+// inc/matrix-template.h.
+//
+
+// Problems that are too big for CHUNK_MULTIPLE of them to fit in the buffer
+// are multiplied one at a time with gemm, which is better at big ones anyway.
+static unsigned int ANMAT_NAME(chunkFor)(unsigned int m,
+                                         unsigned int n,
+                                         unsigned int k)
+{
+  size_t values = ((size_t)m * k) + ((size_t)k * n) + ((size_t)m * n);
+  size_t chunk = CHUNK_BUFFER_VALUES / values;
+
+  chunk = (chunk > CHUNK_MAX ? CHUNK_MAX : chunk);
+  return (unsigned int)(chunk - (chunk % CHUNK_MULTIPLE));
+}
+
+typedef struct {
+  AnmatBatchLayout_t layout;
+  unsigned int count, m, n, k, chunk;
+  const ANMAT_VALUE *a, *b;
+  ANMAT_VALUE *c;
+  unsigned int taskCount;
+} ANMAT_TYPE(BatchJob);
+
+// -----------------------------------------------------------------------------
+// Tasks
+
+static void ANMAT_NAME(soaTask)(void *context, unsigned int taskI)
+{
+  ANMAT_TYPE(BatchJob) *job = (ANMAT_TYPE(BatchJob) *)context;
+  unsigned int start, end;
+
+  anmatPoolSplit(job->count, CHUNK_MULTIPLE, taskI, job->taskCount, &start,
+                 &end);
+  if (start < end) {
+    ANMAT_NAME(anmatKernels)->batchMultiply(job->m, job->n, job->k,
+                                            job->a + start,
+                                            job->b + start,
+                                            job->c + start,
+                                            job->count, end - start);
+  }
+}
+
+static void ANMAT_NAME(aosTask)(void *context, unsigned int taskI)
+{
+  ANMAT_TYPE(BatchJob) *job = (ANMAT_TYPE(BatchJob) *)context;
+  ANMAT_VALUE buffer[CHUNK_BUFFER_VALUES], *a, *b, *c;
+  unsigned int mk = job->m * job->k, kn = job->k * job->n;
+  unsigned int mn = job->m * job->n;
+  unsigned int start, end, p, chunk;
+
+  anmatPoolSplit(job->count, job->chunk, taskI, job->taskCount, &start, &end);
+  for (p = start; p < end; p += chunk) {
+    chunk = (end - p < job->chunk ? end - p : job->chunk);
+    a = buffer;
+    b = a + ((size_t)mk * chunk);
+    c = b + ((size_t)kn * chunk);
+
+    ANMAT_NAME(anmatTranspose)(job->a + ((size_t)p * mk), mk, a, chunk, chunk,
+                               mk);
+    ANMAT_NAME(anmatTranspose)(job->b + ((size_t)p * kn), kn, b, chunk, chunk,
+                               kn);
+    ANMAT_NAME(anmatKernels)->batchMultiply(job->m, job->n, job->k, a, b, c,
+                                            chunk, chunk);
+    ANMAT_NAME(anmatTranspose)(c, chunk, job->c + ((size_t)p * mn), mn, mn,
+                               chunk);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// API
+
+AnmatStatus_t ANMAT_NAME(anmatBatchMultiply)(AnmatBatchLayout_t layout,
+                                             unsigned int count,
+                                             unsigned int m,
+                                             unsigned int n,
+                                             unsigned int k,
+                                             const ANMAT_VALUE *a,
+                                             const ANMAT_VALUE *b,
+                                             ANMAT_VALUE *c)
+{
+  ANMAT_TYPE(BatchJob) job = { layout, count, m, n, k, 0, a, b, c, };
+  AnmatStatus_t status;
+  unsigned int p;
+
+  if ((layout != ANMAT_BATCH_AOS && layout != ANMAT_BATCH_SOA)
+      || !m || !n || !k) {
+    return ANMAT_BAD_ARG;
+  }
+
+  if (!count) {
+    return ANMAT_SUCCESS;
+  }
+
+  job.chunk = ANMAT_NAME(chunkFor)(m, n, k);
+  if (layout == ANMAT_BATCH_AOS && !job.chunk) {
+    note("anmatBatchMultiply: %u x %u x %u is big, using gemm\n", m, n, k);
+    for (p = 0; p < count; p ++) {
+      status = ANMAT_NAME(anmatGemm)(m, n, k,
+                                     1, a + ((size_t)p * m * k), k,
+                                     b + ((size_t)p * k * n), n,
+                                     0, c + ((size_t)p * m * n), n);
+      if (status != ANMAT_SUCCESS) {
+        return status;
+      }
+    }
+    return ANMAT_SUCCESS;
+  }
+
+  job.taskCount = anmatPoolTaskCount((size_t)count * m * n * k);
+  anmatPoolRun((layout == ANMAT_BATCH_SOA
+                ? ANMAT_NAME(soaTask)
+                : ANMAT_NAME(aosTask)),
+               &job,
+               job.taskCount);
+
+  return ANMAT_SUCCESS;
+}
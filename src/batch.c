@@ -0,0 +1,63 @@
+//
+// batch.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Batch API.
+//
+
+#include "batch.h"
+#include "src/gemm.h"
+#include "src/kernels.h"
+#include "src/pool.h"
+#include "src/transpose.h"
+
+//#define BATCH_DEBUG
+#ifdef BATCH_DEBUG
+  #define note(...) printf(__VA_ARGS__), fflush(0);
+#else
+  #define note(...)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+
+// The kernels only read problems stored value by value (ANMAT_BATCH_SOA).
+// Problems stored problem by problem (ANMAT_BATCH_AOS) are done a chunk at a
+// time: a chunk of a's is a chunk x (m * k) matrix, so its transpose is the
+// same chunk of problems stored value by value. The chunk is transposed into
+// a buffer on the stack, multiplied there, and transposed back out.
+
+// The buffer, for the a's, b's and c's of a chunk.
+#define CHUNK_BUFFER_BYTES (32 * 1024)
+
+// These are only used in the template, where ANMAT_VALUE is defined.
+
+#define CHUNK_BUFFER_VALUES (CHUNK_BUFFER_BYTES / sizeof(ANMAT_VALUE))
+
+// The most problems in a chunk. A chunk is a multiple of CHUNK_MULTIPLE
+// problems, which is the most that a vector (of 64 bytes) holds, so that only
+// the last chunk has problems left over.
+#define CHUNK_MAX      (64)
+#define CHUNK_MULTIPLE (64 / sizeof(ANMAT_VALUE))
+
+// -----------------------------------------------------------------------------
+// Precisions
+
+#define ANMAT_VALUE      double
+#define ANMAT_NAME(name) name
+#define ANMAT_TYPE(name) name ## _t
+#include "src/batch-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_NAME
+#undef ANMAT_TYPE
+
+#define ANMAT_VALUE      float
+#define ANMAT_NAME(name) name ## F
+#define ANMAT_TYPE(name) name ## F_t
+#include "src/batch-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_NAME
+#undef ANMAT_TYPE
@@ -0,0 +1,382 @@
+//
+// cholesky.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Cholesky API.
+//
+
+#include <math.h>   // log(), sqrt()
+#include <string.h> // memcpy(), memset()
+
+#include "cholesky.h"
+#include "src/gemm.h"
+#include "src/kernels.h"
+#include "src/transpose.h"
+#include "src/trsm.h"
+
+//#define CHOLESKY_DEBUG
+#ifdef CHOLESKY_DEBUG
+  #define note(...) printf(__VA_ARGS__), fflush(0);
+#else
+  #define note(...)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+
+// L is found a block of rows at a time, from the top down. Each value of L is
+// the value of A, minus the dot product of the rows of L that it is on and
+// across from (up to its column), over the value on the diagonal:
+//   L[i][j] = (A[i][j] - (L[i][0:j] . L[j][0:j])) / L[j][j]
+// So for the block of rows I, and a block J before it on the diagonal,
+//   L[I][J]' = L[J][J]^-1 * (A[J][I] - (L[J][0:J] * L[I][0:J]'))
+// which is one gemm and one trsm, if L[I]' is worked out in a temporary
+// (since gemm only takes its inputs one way), from the top down. That gemm
+// is most of the work. Then L[I][0:I]' is transposed into place, and the
+// block on the diagonal is A[I][I] - (L[I][0:I] * L[I][0:I]'), another gemm,
+// factored one value at a time.
+//
+// Solving with L' is the same as solving with an upper triangle, and the
+// transpose of a block of rows of L is a block of columns of L', which trsm
+// and gemm can take as is.
+
+#define BLOCK ANMAT_CHOLESKY_BLOCK
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+
+#define rowOf(b, ldb, rowI) ((b) + ((size_t)(rowI) * (ldb)))
+
+// Get the rows of the b'th block of L.
+#define blockOf(cholesky, b) \
+  ((cholesky)->data + anmatCholeskyBlockStart(b))
+
+// Get the values that it takes to store L for an n x n matrix: all of the
+// blocks of rows but the last, which may not be full, and the last.
+static size_t valueCount(unsigned int n)
+{
+  unsigned int last = (n - 1) / BLOCK;
+
+  return (anmatCholeskyBlockStart(last)
+          + ((size_t)(n - (last * BLOCK)) * n));
+}
+
+// Factor the blockI'th block of rows of L, with the earlier blocks already
+// factored, from the same rows of the matrix. The temporary has room for
+// BLOCK rows of L, transposed.
+// Returns ANMAT_BAD_ARG if A is not positive definite.
+static AnmatStatus_t factorBlock(AnmatCholesky_t *cholesky,
+                                 AnmatMatrix_t *matrix,
+                                 unsigned int blockI,
+                                 double *transposed)
+{
+  unsigned int start = blockI * BLOCK, end = min(cholesky->n, start + BLOCK);
+  unsigned int count = end - start, stride = end;
+  unsigned int blockJ, colStart, cols, i, j;
+  double *rows = blockOf(cholesky, blockI), *rowsJ, *x, *rowI, *rowJ;
+  AnmatStatus_t status = ANMAT_SUCCESS;
+  double value;
+
+  // Find L[I][0:I]', a block of L' at a time, from the top down.
+  anmatTranspose(anmatMatrixRow(matrix, start), matrix->stride,
+                 transposed, count, count, start);
+  for (blockJ = 0; blockJ < blockI && status == ANMAT_SUCCESS; blockJ ++) {
+    colStart = blockJ * BLOCK;
+    cols = BLOCK;
+    rowsJ = blockOf(cholesky, blockJ);
+    x = rowOf(transposed, count, colStart);
+    if (colStart) {
+      status = anmatGemm(cols, count, colStart,
+                         -1, rowsJ, colStart + cols,
+                         transposed, count,
+                         1, x, count);
+    }
+    if (status == ANMAT_SUCCESS) {
+      status = anmatTrsm(true, false, cols, count,
+                         rowsJ + colStart, colStart + cols,
+                         x, count);
+    }
+  }
+  if (status != ANMAT_SUCCESS) {
+    return status;
+  }
+  anmatTranspose(transposed, count, rows, stride, start, count);
+
+  // Then the block on the diagonal, from the lower triangle of the matrix.
+  for (i = 0; i < count; i ++) {
+    rowI = rowOf(rows, stride, i) + start;
+    memcpy(rowI, anmatMatrixRow(matrix, start + i) + start,
+           (i + 1) * sizeof(double));
+    memset(rowI + i + 1, 0, (count - i - 1) * sizeof(double));
+  }
+  if (start) {
+    status = anmatGemm(count, count, start,
+                       -1, rows, stride,
+                       transposed, count,
+                       1, rows + start, stride);
+    if (status != ANMAT_SUCCESS) {
+      return status;
+    }
+  }
+  for (i = 0; i < count; i ++) {
+    rowI = rowOf(rows, stride, i) + start;
+    for (j = 0; j <= i; j ++) {
+      rowJ = rowOf(rows, stride, j) + start;
+      value = rowI[j] - anmatKernels->dot(rowI, rowJ, j);
+      if (j < i) {
+        rowI[j] = value / rowJ[j];
+      } else if (value > 0) {
+        rowI[i] = sqrt(value);
+      } else {
+        note("factorBlock: %g on the diagonal at %u\n", value, start + i);
+        return ANMAT_BAD_ARG;
+      }
+    }
+    // The gemm wrote over the 0's above the diagonal.
+    memset(rowI + i + 1, 0, (count - i - 1) * sizeof(double));
+  }
+
+  return ANMAT_SUCCESS;
+}
+
+// Solve A * X = B in place, for the n x nrhs B at x.
+static AnmatStatus_t solve(AnmatCholesky_t *cholesky,
+                           unsigned int nrhs,
+                           double *x,
+                           unsigned int ldx)
+{
+  AnmatStatus_t status = ANMAT_SUCCESS;
+  unsigned int n = cholesky->n, blocks = ((n - 1) / BLOCK) + 1;
+  unsigned int blockI, start, end, count;
+  AnmatArena_t *scratch;
+  AnmatArenaMark_t mark;
+  double *rows, *transposed;
+
+  // L * Y = B, from the top down.
+  for (blockI = 0; blockI < blocks && status == ANMAT_SUCCESS; blockI ++) {
+    start = blockI * BLOCK;
+    end = min(n, start + BLOCK);
+    count = end - start;
+    rows = blockOf(cholesky, blockI);
+    if (start) {
+      status = anmatGemm(count, nrhs, start,
+                         -1, rows, end,
+                         x, ldx,
+                         1, rowOf(x, ldx, start), ldx);
+    }
+    if (status == ANMAT_SUCCESS) {
+      status = anmatTrsm(true, false, count, nrhs, rows + start, end,
+                         rowOf(x, ldx, start), ldx);
+    }
+  }
+
+  scratch = anmatArenaScratch();
+  mark = anmatArenaMark(scratch);
+  transposed = (double *)anmatArenaAlloc(scratch,
+                                         ((size_t)n * BLOCK * sizeof(double)));
+  if (!transposed && status == ANMAT_SUCCESS) {
+    status = ANMAT_MEM_ERR;
+  }
+
+  // L' * X = Y, from the bottom up.
+  for (blockI = blocks; blockI > 0 && status == ANMAT_SUCCESS; blockI --) {
+    start = (blockI - 1) * BLOCK;
+    end = min(n, start + BLOCK);
+    count = end - start;
+    anmatTranspose(blockOf(cholesky, blockI - 1), end, transposed, count,
+                   count, end);
+    status = anmatTrsm(false, false, count, nrhs,
+                       rowOf(transposed, count, start), count,
+                       rowOf(x, ldx, start), ldx);
+    if (start && status == ANMAT_SUCCESS) {
+      status = anmatGemm(start, nrhs, count,
+                         -1, transposed, count,
+                         rowOf(x, ldx, start), ldx,
+                         1, x, ldx);
+    }
+  }
+
+  anmatArenaReset(scratch, mark);
+
+  return status;
+}
+
+// Update (for a sign of 1) or downdate (for a sign of -1) L with a rotation
+// per row, found from the value of the vector that is left on the diagonal.
+// L is read a row at a time, so the rotations of the rows before are kept.
+static AnmatStatus_t rankOne(AnmatCholesky_t *cholesky,
+                             AnmatVector_t *vector,
+                             double sign)
+{
+  unsigned int n = cholesky->n, i, k;
+  double *c, *s, *row, xI, diagonal, length = 0;
+  AnmatArena_t *scratch;
+  AnmatArenaMark_t mark;
+
+  if (vector->count != n) {
+    return ANMAT_BAD_ARG;
+  }
+
+  scratch = anmatArenaScratch();
+  mark = anmatArenaMark(scratch);
+  c = (double *)anmatArenaAlloc(scratch, 2 * (size_t)n * sizeof(double));
+  if (!c) {
+    anmatArenaReset(scratch, mark);
+    return ANMAT_MEM_ERR;
+  }
+  s = c + n;
+
+  // A - (x * x') is positive definite if and only if L^-1 * x is shorter
+  // than 1. Check before changing anything.
+  if (sign < 0) {
+    for (i = 0; i < n; i ++) {
+      row = anmatCholeskyRow(cholesky, i);
+      s[i] = (vector->data[i] - anmatKernels->dot(row, s, i)) / row[i];
+      length += s[i] * s[i];
+    }
+    if (!(length < 1)) {
+      anmatArenaReset(scratch, mark);
+      return ANMAT_BAD_ARG;
+    }
+  }
+
+  for (i = 0; i < n; i ++) {
+    row = anmatCholeskyRow(cholesky, i);
+    xI = vector->data[i];
+    for (k = 0; k < i; k ++) {
+      row[k] = (row[k] + (sign * s[k] * xI)) / c[k];
+      xI = (c[k] * xI) - (s[k] * row[k]);
+    }
+    diagonal = row[i];
+    row[i] = sqrt((diagonal * diagonal) + (sign * xI * xI));
+    c[i] = row[i] / diagonal;
+    s[i] = xI / diagonal;
+  }
+
+  anmatArenaReset(scratch, mark);
+
+  return ANMAT_SUCCESS;
+}
+
+// -----------------------------------------------------------------------------
+// Factorization
+
+AnmatStatus_t anmatCholeskyFactor(AnmatCholesky_t *cholesky,
+                                  AnmatMatrix_t *matrix)
+{
+  AnmatStatus_t status = ANMAT_SUCCESS;
+  unsigned int n = matrix->rows, blockI;
+  AnmatArena_t *scratch;
+  AnmatArenaMark_t mark;
+  double *transposed;
+
+  if (matrix->rows != matrix->cols) {
+    return ANMAT_BAD_ARG;
+  }
+
+  cholesky->n = n;
+  cholesky->allocator = anmatAllocatorGet();
+  cholesky->data = (double *)anmatAllocAligned(cholesky->allocator,
+                                               (valueCount(n)
+                                                * sizeof(double)),
+                                               ANMAT_DATA_ALIGNMENT);
+  if (!cholesky->data) {
+    return ANMAT_MEM_ERR;
+  }
+
+  scratch = anmatArenaScratch();
+  mark = anmatArenaMark(scratch);
+  transposed = (double *)anmatArenaAlloc(scratch,
+                                         ((size_t)n * BLOCK * sizeof(double)));
+  if (!transposed) {
+    status = ANMAT_MEM_ERR;
+  }
+
+  for (blockI = 0; blockI * BLOCK < n && status == ANMAT_SUCCESS; blockI ++) {
+    status = factorBlock(cholesky, matrix, blockI, transposed);
+  }
+
+  note("anmatCholeskyFactor: %u x %u in %zu values, status %d\n",
+       n, n, valueCount(n), status);
+
+  anmatArenaReset(scratch, mark);
+
+  if (status != ANMAT_SUCCESS) {
+    anmatCholeskyFree(cholesky);
+  }
+
+  return status;
+}
+
+void anmatCholeskyFree(AnmatCholesky_t *cholesky)
+{
+  if (cholesky->data) {
+    anmatFree(cholesky->allocator, cholesky->data);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Operations
+
+AnmatStatus_t anmatCholeskySolve(AnmatCholesky_t *cholesky,
+                                 AnmatMatrix_t *matrixB,
+                                 AnmatMatrix_t *matrixX)
+{
+  unsigned int rowI;
+
+  if (matrixB->rows != cholesky->n
+      || matrixX->rows != matrixB->rows
+      || matrixX->cols != matrixB->cols) {
+    return ANMAT_BAD_ARG;
+  }
+
+  if (matrixX->data != matrixB->data) {
+    for (rowI = 0; rowI < matrixB->rows; rowI ++) {
+      memcpy(anmatMatrixRow(matrixX, rowI), anmatMatrixRow(matrixB, rowI),
+             matrixB->cols * sizeof(double));
+    }
+  }
+
+  return solve(cholesky, matrixX->cols, matrixX->data, matrixX->stride);
+}
+
+AnmatStatus_t anmatCholeskySolveVector(AnmatCholesky_t *cholesky,
+                                       AnmatVector_t *vectorB,
+                                       AnmatVector_t *vectorX)
+{
+  if (vectorB->count != cholesky->n || vectorX->count != vectorB->count) {
+    return ANMAT_BAD_ARG;
+  }
+
+  if (vectorX->data != vectorB->data) {
+    memcpy(vectorX->data, vectorB->data, vectorB->count * sizeof(double));
+  }
+
+  return solve(cholesky, 1, vectorX->data, 1);
+}
+
+double anmatCholeskyLogDeterminant(AnmatCholesky_t *cholesky)
+{
+  double total = 0;
+  unsigned int i;
+
+  for (i = 0; i < cholesky->n; i ++) {
+    total += log(anmatCholeskyData(cholesky, i, i));
+  }
+
+  return 2 * total;
+}
+
+AnmatStatus_t anmatCholeskyUpdate(AnmatCholesky_t *cholesky,
+                                  AnmatVector_t *vector)
+{
+  return rankOne(cholesky, vector, 1);
+}
+
+AnmatStatus_t anmatCholeskyDowndate(AnmatCholesky_t *cholesky,
+                                    AnmatVector_t *vector)
+{
+  return rankOne(cholesky, vector, -1);
+}
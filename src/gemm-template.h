@@ -0,0 +1,251 @@
+//
+// gemm-template.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// General matrix multiply for one precision.
+//
+// This is included by gemm.c once per precision, with the same macros as
+// matrix-template.h.
+//
+
+// -----------------------------------------------------------------------------
+// Packing
+
+// Pack mc x kc of A, mr rows at a time.
+static void ANMAT_NAME(packA)(unsigned int mc,
+                              unsigned int kc,
+                              const ANMAT_VALUE *a,
+                              unsigned int lda,
+                              unsigned int mr,
+                              ANMAT_VALUE *packed)
+{
+  unsigned int rowI, colI, r;
+
+  for (rowI = 0; rowI < mc; rowI += mr) {
+    for (colI = 0; colI < kc; colI ++) {
+      for (r = 0; r < mr; r ++) {
+        *packed++ = (rowI + r < mc ? a[((size_t)(rowI + r) * lda) + colI] : 0);
+      }
+    }
+  }
+}
+
+// Pack kc x nc of B, nr columns at a time.
+static void ANMAT_NAME(packB)(unsigned int kc,
+                              unsigned int nc,
+                              const ANMAT_VALUE *b,
+                              unsigned int ldb,
+                              unsigned int nr,
+                              ANMAT_VALUE *packed)
+{
+  unsigned int rowI, colI, c;
+  const ANMAT_VALUE *row;
+
+  for (colI = 0; colI < nc; colI += nr) {
+    for (rowI = 0; rowI < kc; rowI ++) {
+      row = b + ((size_t)rowI * ldb) + colI;
+      if (colI + nr <= nc) {
+        for (c = 0; c < nr; c ++) {
+          *packed++ = row[c];
+        }
+      } else {
+        for (c = 0; c < nr; c ++) {
+          *packed++ = (colI + c < nc ? row[c] : 0);
+        }
+      }
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Blocks
+
+// Everything that it takes to compute a block of C.
+typedef struct {
+  const ANMAT_TYPE(Kernels) *kernel;
+  unsigned int m, n, k;
+  ANMAT_VALUE alpha;
+  const ANMAT_VALUE *a;
+  unsigned int lda;
+  const ANMAT_VALUE *b;
+  unsigned int ldb;
+  ANMAT_VALUE beta;
+  ANMAT_VALUE *c;
+  unsigned int ldc;
+} ANMAT_TYPE(Block);
+
+static void ANMAT_NAME(multiplyBlock)(const ANMAT_TYPE(Block) *block,
+                                      ANMAT_VALUE *packedA,
+                                      ANMAT_VALUE *packedB)
+{
+  const ANMAT_TYPE(Kernels) *kernel = block->kernel;
+  unsigned int mr = kernel->gemmMr, nr = kernel->gemmNr;
+  unsigned int jc, pc, ic, jr, ir, nc, kc, mc;
+  ANMAT_VALUE panelBeta;
+
+  for (jc = 0; jc < block->n; jc += NC) {
+    nc = min(NC, block->n - jc);
+    for (pc = 0; pc < block->k; pc += KC) {
+      kc = min(KC, block->k - pc);
+      ANMAT_NAME(packB)(kc, nc, block->b + ((size_t)pc * block->ldb) + jc,
+                        block->ldb, nr, packedB);
+
+      // Only the first pass over k scales what was in C.
+      panelBeta = (pc == 0 ? block->beta : 1);
+
+      for (ic = 0; ic < block->m; ic += MC) {
+        mc = min(MC, block->m - ic);
+        ANMAT_NAME(packA)(mc, kc, block->a + ((size_t)ic * block->lda) + pc,
+                          block->lda, mr, packedA);
+
+        for (jr = 0; jr < nc; jr += nr) {
+          for (ir = 0; ir < mc; ir += mr) {
+            kernel->gemmMicro(kc,
+                              packedA + (ir * kc),
+                              packedB + (jr * kc),
+                              (block->c + ((size_t)(ic + ir) * block->ldc)
+                                + jc + jr),
+                              block->ldc,
+                              min(mr, mc - ir),
+                              min(nr, nc - jr),
+                              block->alpha,
+                              panelBeta);
+          }
+        }
+      }
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Threads
+
+// Big multiplies are split into a grid of blocks of C, one per task. Each
+// task packs its own panels (into memory that the calling thread allocated)
+// and runs the same loops as a serial multiply on its block. Blocks start on
+// multiples of the micro kernel's tile, and each value of C is still summed
+// over k in the same order, so the result does not depend on the grid.
+
+typedef struct {
+  ANMAT_TYPE(Block) whole;
+  unsigned int gridRows, gridCols;
+  unsigned int blockRows, blockCols;
+  ANMAT_VALUE *packed;
+  size_t packedCount;
+} ANMAT_TYPE(Grid);
+
+static void ANMAT_NAME(multiplyTask)(void *context, unsigned int taskI)
+{
+  ANMAT_TYPE(Grid) *grid = (ANMAT_TYPE(Grid) *)context;
+  ANMAT_TYPE(Block) block = grid->whole;
+  unsigned int rowI, colI;
+  ANMAT_VALUE *packedA;
+
+  rowI = (taskI / grid->gridCols) * grid->blockRows;
+  colI = (taskI % grid->gridCols) * grid->blockCols;
+  block.m = min(grid->blockRows, grid->whole.m - rowI);
+  block.n = min(grid->blockCols, grid->whole.n - colI);
+  block.a += (size_t)rowI * block.lda;
+  block.b += colI;
+  block.c += ((size_t)rowI * block.ldc) + colI;
+
+  packedA = grid->packed + (taskI * grid->packedCount);
+  ANMAT_NAME(multiplyBlock)(&block,
+                            packedA,
+                            packedA + packedACount(block.kernel,
+                                                   grid->blockRows,
+                                                   block.k));
+}
+
+// Pick the grid of at most taskCount blocks that are closest to square.
+static void ANMAT_NAME(pickGrid)(ANMAT_TYPE(Grid) *grid,
+                                 unsigned int taskCount)
+{
+  const ANMAT_TYPE(Block) *whole = &grid->whole;
+  unsigned int rows, cols, bestRows = 1;
+  double skew, bestSkew = -1;
+
+  for (rows = 1; rows <= taskCount; rows ++) {
+    cols = taskCount / rows;
+    skew = ((double)whole->m / rows) / ((double)whole->n / cols);
+    skew = (skew < 1 ? 1 / skew : skew);
+    if (bestSkew < 0 || skew < bestSkew) {
+      bestSkew = skew;
+      bestRows = rows;
+    }
+  }
+
+  grid->blockRows = roundUp((whole->m + bestRows - 1) / bestRows,
+                            whole->kernel->gemmMr);
+  grid->blockCols = roundUp((whole->n + (taskCount / bestRows) - 1)
+                            / (taskCount / bestRows),
+                            whole->kernel->gemmNr);
+  grid->gridRows = (whole->m + grid->blockRows - 1) / grid->blockRows;
+  grid->gridCols = (whole->n + grid->blockCols - 1) / grid->blockCols;
+  grid->packedCount = (packedACount(whole->kernel, grid->blockRows, whole->k)
+                       + packedBCount(whole->kernel, grid->blockCols,
+                                      whole->k));
+}
+
+// -----------------------------------------------------------------------------
+// API
+
+AnmatStatus_t ANMAT_NAME(anmatGemm)(unsigned int m,
+                                    unsigned int n,
+                                    unsigned int k,
+                                    ANMAT_VALUE alpha,
+                                    const ANMAT_VALUE *a,
+                                    unsigned int lda,
+                                    const ANMAT_VALUE *b,
+                                    unsigned int ldb,
+                                    ANMAT_VALUE beta,
+                                    ANMAT_VALUE *c,
+                                    unsigned int ldc)
+{
+  ANMAT_TYPE(Grid) grid = {
+    { ANMAT_NAME(anmatKernels), m, n, k, alpha, a, lda, b, ldb, beta, c, ldc, },
+  };
+  AnmatArena_t *scratch;
+  AnmatArenaMark_t mark;
+  unsigned int rowI, colI, taskCount;
+
+  if (!m || !n) {
+    return ANMAT_SUCCESS;
+  }
+
+  // Nothing to multiply, so just scale C.
+  if (!k || alpha == 0) {
+    for (rowI = 0; rowI < m; rowI ++) {
+      for (colI = 0; colI < n; colI ++) {
+        c[((size_t)rowI * ldc) + colI]
+          = (beta == 0 ? 0 : beta * c[((size_t)rowI * ldc) + colI]);
+      }
+    }
+    return ANMAT_SUCCESS;
+  }
+
+  ANMAT_NAME(pickGrid)(&grid, anmatPoolTaskCount((size_t)m * n * k));
+  taskCount = grid.gridRows * grid.gridCols;
+
+  scratch = anmatArenaScratch();
+  mark = anmatArenaMark(scratch);
+  grid.packed = (ANMAT_VALUE *)anmatArenaAlloc(scratch,
+                                               (taskCount * grid.packedCount
+                                                * sizeof(ANMAT_VALUE)));
+  if (!grid.packed) {
+    anmatArenaReset(scratch, mark);
+    return ANMAT_MEM_ERR;
+  }
+
+  note("gemm: %u x %u x %u in %u x %u blocks\n",
+       m, n, k, grid.gridRows, grid.gridCols);
+
+  anmatPoolRun(ANMAT_NAME(multiplyTask), &grid, taskCount);
+
+  anmatArenaReset(scratch, mark);
+
+  return ANMAT_SUCCESS;
+}
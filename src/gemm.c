@@ -0,0 +1,75 @@
+//
+// gemm.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// General matrix multiply for the anmat library.
+//
+
+#include "gemm.h"
+#include "src/kernels.h"
+#include "src/pool.h"
+
+//#define GEMM_DEBUG
+#ifdef GEMM_DEBUG
+  #define note(...) printf(__VA_ARGS__), fflush(0);
+#else
+  #define note(...)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+
+// The multiply is split up the same way as in GotoBLAS/BLIS. C is walked in
+// blocks of NC columns. For each block, KC rows of B are packed into a panel
+// that stays in the L3 cache, then MC rows of A (over the same KC columns) are
+// packed into a panel that stays in the L2 cache. Each MR x NR tile of C is
+// then computed by the micro kernel, which streams an MR wide sliver of the
+// A panel and an NR wide sliver of the B panel (which stays in the L1 cache)
+// and keeps the whole tile in registers.
+//
+// The panels are packed so that the micro kernel reads both of its slivers
+// front to back: the A panel is MR rows at a time, column by column, and the
+// B panel is NR columns at a time, row by row. Slivers on the edges are padded
+// with 0's, so the micro kernel always does a whole tile.
+
+// The micro kernel, and so MR and NR, come from the SIMD level in use (see
+// simd.h and kernels.h).
+
+#define KC (256)  // KC * NR doubles (8 - 32 KiB) for the B sliver in L1
+#define MC (128)  // MC * KC doubles (256 KiB) for the A panel in L2
+#define NC (4096) // KC * NC doubles (8 MiB) for the B panel in L3
+
+// Floats use the same blocks. Their tiles are twice as wide, so the B sliver
+// takes the same bytes, and the panels take half.
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define roundUp(value, multiple) \
+  ((((value) + (multiple) - 1) / (multiple)) * (multiple))
+
+// The values that it takes to pack panels for an m x n x k block.
+#define packedACount(kernel, m, k) \
+  ((size_t)roundUp(min(m, MC), (kernel)->gemmMr) * min(k, KC))
+#define packedBCount(kernel, n, k) \
+  ((size_t)roundUp(min(n, NC), (kernel)->gemmNr) * min(k, KC))
+
+// -----------------------------------------------------------------------------
+// Precisions
+
+#define ANMAT_VALUE      double
+#define ANMAT_NAME(name) name
+#define ANMAT_TYPE(name) name ## _t
+#include "src/gemm-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_NAME
+#undef ANMAT_TYPE
+
+#define ANMAT_VALUE      float
+#define ANMAT_NAME(name) name ## F
+#define ANMAT_TYPE(name) name ## F_t
+#include "src/gemm-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_NAME
+#undef ANMAT_TYPE
@@ -0,0 +1,45 @@
+//
+// gemm.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// General matrix multiply for the anmat library.
+//
+
+#ifndef __GEMM_H__
+#define __GEMM_H__
+
+#include "anmat.h"
+
+// Compute C = (alpha * A * B) + (beta * C), where A is m x k, B is k x n and
+// C is m x n. Each matrix is row-major, with lda, ldb and ldc doubles from the
+// start of one row to the start of the next. C must not overlap A or B.
+// If beta is 0, C is not read, so it does not have to be initialized.
+// Returns ANMAT_MEM_ERR if there is no room for the packed panels.
+// anmatGemmF is the same, for floats.
+AnmatStatus_t anmatGemm(unsigned int m,
+                        unsigned int n,
+                        unsigned int k,
+                        double alpha,
+                        const double *a,
+                        unsigned int lda,
+                        const double *b,
+                        unsigned int ldb,
+                        double beta,
+                        double *c,
+                        unsigned int ldc);
+AnmatStatus_t anmatGemmF(unsigned int m,
+                         unsigned int n,
+                         unsigned int k,
+                         float alpha,
+                         const float *a,
+                         unsigned int lda,
+                         const float *b,
+                         unsigned int ldb,
+                         float beta,
+                         float *c,
+                         unsigned int ldc);
+
+#endif /* __GEMM_H__ */
@@ -0,0 +1,129 @@
+//
+// gemv-template.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// The matrix-vector API for one precision.
+//
+// This is included by gemv.c once per precision, with the same macros as
+// inc/matrix-template.h.
+//
+
+typedef struct {
+  ANMAT_TYPE(AnmatMatrix) *matrixA;
+  const ANMAT_VALUE *x;
+  ANMAT_VALUE *y, *partials;
+  ANMAT_VALUE alpha, beta;
+  unsigned int taskCount;
+} ANMAT_TYPE(GemvJob);
+
+// -----------------------------------------------------------------------------
+// Tasks
+
+static void ANMAT_NAME(normalTask)(void *context, unsigned int taskI)
+{
+  ANMAT_TYPE(GemvJob) *job = (ANMAT_TYPE(GemvJob) *)context;
+  ANMAT_TYPE(AnmatMatrix) *matrixA = job->matrixA;
+  unsigned int rowI, start, end;
+  ANMAT_VALUE dot;
+
+  anmatPoolSplit(matrixA->rows, 1, taskI, job->taskCount, &start, &end);
+  for (rowI = start; rowI < end; rowI ++) {
+    dot = ANMAT_NAME(anmatKernels)->dot(anmatMatrixRow(matrixA, rowI), job->x,
+                                        matrixA->cols);
+    job->y[rowI] = (job->beta == 0
+                    ? job->alpha * dot
+                    : (job->alpha * dot) + (job->beta * job->y[rowI]));
+  }
+}
+
+static void ANMAT_NAME(transposeTask)(void *context, unsigned int taskI)
+{
+  ANMAT_TYPE(GemvJob) *job = (ANMAT_TYPE(GemvJob) *)context;
+  ANMAT_TYPE(AnmatMatrix) *matrixA = job->matrixA;
+  unsigned int rowI, start, end, cols = matrixA->cols;
+  ANMAT_VALUE *sums = job->y;
+
+  if (taskI) {
+    sums = job->partials + ((size_t)(taskI - 1) * cols);
+    memset(sums, 0, cols * sizeof(ANMAT_VALUE));
+  }
+
+  anmatPoolSplit(matrixA->rows, 1, taskI, job->taskCount, &start, &end);
+  for (rowI = start; rowI < end; rowI ++) {
+    ANMAT_NAME(anmatKernels)->axpby(anmatMatrixRow(matrixA, rowI),
+                                    job->alpha * job->x[rowI],
+                                    sums, 1, sums, cols);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// API
+
+AnmatStatus_t
+ANMAT_NAME(anmatMatrixVectorMultiply)(AnmatTranspose_t op,
+                                      ANMAT_VALUE alpha,
+                                      ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                      ANMAT_TYPE(AnmatVector) *vectorX,
+                                      ANMAT_VALUE beta,
+                                      ANMAT_TYPE(AnmatVector) *vectorY)
+{
+  ANMAT_TYPE(GemvJob) job
+    = { matrixA, vectorX->data, vectorY->data, NULL, alpha, beta, };
+  unsigned int cols = matrixA->cols, taskI;
+  AnmatArena_t *scratch = NULL;
+  AnmatArenaMark_t mark;
+  ANMAT_VALUE *partial;
+
+  job.taskCount = anmatPoolTaskCount((size_t)matrixA->rows * cols);
+
+  if (op == ANMAT_NO_TRANSPOSE) {
+    if (cols != vectorX->count || matrixA->rows != vectorY->count) {
+      return ANMAT_BAD_ARG;
+    }
+    anmatPoolRun(ANMAT_NAME(normalTask), &job, job.taskCount);
+    return ANMAT_SUCCESS;
+  }
+
+  if (op != ANMAT_TRANSPOSE
+      || matrixA->rows != vectorX->count
+      || cols != vectorY->count) {
+    return ANMAT_BAD_ARG;
+  }
+
+  if (job.taskCount > 1) {
+    scratch = anmatArenaScratch();
+    mark = anmatArenaMark(scratch);
+    job.partials
+      = (ANMAT_VALUE *)anmatArenaAlloc(scratch,
+                                       ((size_t)(job.taskCount - 1) * cols
+                                        * sizeof(ANMAT_VALUE)));
+    if (!job.partials) {
+      anmatArenaReset(scratch, mark);
+      return ANMAT_MEM_ERR;
+    }
+  }
+
+  note("anmatMatrixVectorMultiply: %u x %u transposed in %u tasks\n",
+       matrixA->rows, cols, job.taskCount);
+
+  if (beta == 0) {
+    memset(job.y, 0, cols * sizeof(ANMAT_VALUE));
+  } else if (beta != 1) {
+    ANMAT_NAME(anmatKernels)->scale(job.y, beta, job.y, cols);
+  }
+
+  anmatPoolRun(ANMAT_NAME(transposeTask), &job, job.taskCount);
+
+  if (scratch) {
+    for (taskI = 1; taskI < job.taskCount; taskI ++) {
+      partial = job.partials + ((size_t)(taskI - 1) * cols);
+      ANMAT_NAME(anmatKernels)->axpby(partial, 1, job.y, 1, job.y, cols);
+    }
+    anmatArenaReset(scratch, mark);
+  }
+
+  return ANMAT_SUCCESS;
+}
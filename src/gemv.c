@@ -0,0 +1,53 @@
+//
+// gemv.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Matrix-vector API.
+//
+
+#include <string.h> // memset()
+
+#include "gemv.h"
+#include "src/kernels.h"
+#include "src/pool.h"
+
+//#define GEMV_DEBUG
+#ifdef GEMV_DEBUG
+  #define note(...) printf(__VA_ARGS__), fflush(0);
+#else
+  #define note(...)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+
+// Both forms read the matrix row by row, so it is only read once, and split
+// it up by row blocks across the thread pool.
+// Without the transpose, each value of y is the dot product of a row and x,
+// so the tasks write to their own values of y.
+// With the transpose, y is the sum of the rows, each times its value of x, so
+// every row adds into all of y. The first task adds into y itself, and the
+// others add into partial sums of their own (from the scratch arena), which
+// are added into y once the tasks are done.
+
+// -----------------------------------------------------------------------------
+// Precisions
+
+#define ANMAT_VALUE      double
+#define ANMAT_NAME(name) name
+#define ANMAT_TYPE(name) name ## _t
+#include "src/gemv-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_NAME
+#undef ANMAT_TYPE
+
+#define ANMAT_VALUE      float
+#define ANMAT_NAME(name) name ## F
+#define ANMAT_TYPE(name) name ## F_t
+#include "src/gemv-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_NAME
+#undef ANMAT_TYPE
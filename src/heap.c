@@ -10,6 +10,10 @@
 
 #include "heap.h"
 
+#include <sys/mman.h> // mmap(), munmap(), madvise()
+#include <unistd.h>   // sysconf()
+#include <stdlib.h>   // abort()
+
 //#define HEAP_DEBUG
 #ifdef HEAP_DEBUG
   #define note(...) printf(__VA_ARGS__), fflush(0);
@@ -17,154 +21,1270 @@
   #define note(...)
 #endif
 
+// When built with ANMAT_HEAP_THREAD_SAFE, the shared parts of the heap
+// (the regions, their refCounts, the shared free lists) are guarded by
+// heapLock, and bitmap words are read and written atomically so that a free
+// can find the length of a live allocation without taking the lock.
+#ifdef ANMAT_HEAP_THREAD_SAFE
+  #include <pthread.h>
+  #define lockHeap()   pthread_mutex_lock(&heapLock)
+  #define unlockHeap() pthread_mutex_unlock(&heapLock)
+  #define loadWord(word) __atomic_load_n(&(word), __ATOMIC_RELAXED)
+  #define orWord(word, mask)  __atomic_fetch_or(&(word), (mask), __ATOMIC_RELAXED)
+  #define andWord(word, mask) __atomic_fetch_and(&(word), (mask), __ATOMIC_RELAXED)
+  #define loadStat(stat) __atomic_load_n(&(stat), __ATOMIC_RELAXED)
+  #define addStat(stat, count) \
+    __atomic_add_fetch(&(stat), (count), __ATOMIC_RELAXED)
+  #define subStat(stat, count) \
+    __atomic_sub_fetch(&(stat), (count), __ATOMIC_RELAXED)
+  #define maxStat(stat, value)                                            \
+    do {                                                                  \
+      __typeof__(stat) old = loadStat(stat);                              \
+      while ((value) > old                                                \
+             && !__atomic_compare_exchange_n(&(stat), &old, (value),      \
+                                             true, __ATOMIC_RELAXED,      \
+                                             __ATOMIC_RELAXED)) { }       \
+    } while (0)
+#else
+  #define lockHeap()
+  #define unlockHeap()
+  #define loadWord(word) (word)
+  #define orWord(word, mask)  ((word) |= (mask))
+  #define andWord(word, mask) ((word) &= (mask))
+  #define loadStat(stat) (stat)
+  #define addStat(stat, count) ((stat) += (count))
+  #define subStat(stat, count) ((stat) -= (count))
+  #define maxStat(stat, value)  \
+    do {                        \
+      if ((value) > (stat)) {   \
+        (stat) = (value);       \
+      }                         \
+    } while (0)
+#endif
+
+#define addFreeBytes(count) addStat(heapFreeBytesCount, count)
+#define subFreeBytes(count) subStat(heapFreeBytesCount, count)
+
 // -----------------------------------------------------------------------------
 // Definitions
 
-// The heap size is defined by a compile time symbol in heap.h.
+// The default heap size is defined by a compile time symbol in heap.h.
+
+#define HEAP_DEFAULT_SIZE (1 << ANMAT_HEAP_SIZE_LOG)
 
-#define HEAP_SIZE (1 << ANMAT_HEAP_SIZE_LOG)
+// The heap is made up of regions of memory mapped from the OS. The first
+// region (the primary region) is mapped by heapInit and lives until the next
+// heapInit. If the heap is growable, more regions are mapped when an
+// allocation does not fit anywhere, and each of those is unmapped again as
+// soon as nothing is allocated from it.
+// Each mapping starts with the HeapRegion_t, followed by its refCounts and
+// sizes, followed by the heap bytes themselves. The heap bytes start on a cache line,
+// or on a huge page boundary for regions big enough to use huge pages.
 
-// There is 1 contiguous chunk of memory for the heap.
+#define REGION_ALIGNMENT    (HEAP_MAX_ALIGNMENT)
+#define HUGE_PAGE_SIZE      (1UL << 21)
+#define HEAP_MAX_SIZE       (1UL << 31)
 
-static unsigned char datHeapDoe[HEAP_SIZE];
+#define alignUp(value, alignment) \
+  (((value) + ((alignment) - 1)) & ~((uintptr_t)(alignment) - 1))
 
-// We keep track of each byte of the heap wth a bit. We mark the end of
+// We keep track of each byte of a region wth a bit. We mark the end of
 // an allocation with a '0' bit.
-// We add a byte on the end of the reference counts so it is easy and safe
+// The bits are kept in 64 bit words so that runs of used or free bytes can be
+// skipped a word at a time. Bit i of word w is the byte at (w * 64) + i.
+// We add a word on the end of the reference counts so it is easy and safe
 // to find the end of the array.
 
-#define REF_COUNTS_SIZE (HEAP_SIZE >> 3)
-static unsigned char refCounts[REF_COUNTS_SIZE + 1];
-#define REF_COUNTS_END (&refCounts[REF_COUNTS_SIZE])
+#define WORD_BITS_LOG (6)
+#define WORD_BITS     (1 << WORD_BITS_LOG)
+#define WORD_MASK     (WORD_BITS - 1)
+#define WORD_ONES     (~(uint64_t)0)
+
+#define BIT(i) ((uint64_t)1 << (i))
+
+// Each region also records the size of every allocation that is too big for
+// the free lists (see below), so that finding the end of one does not mean
+// walking all of its bits. These allocations are more than SIZE_SLOT_BYTES
+// long, so no two of them start in the same SIZE_SLOT_BYTES bytes, and the
+// sizes fit in a table with a slot for each SIZE_SLOT_BYTES bytes of the
+// region. Smaller allocations are found from their bits, of which there are
+// only a few words.
+
+#define SIZE_SLOT_LOG   (7)
+#define SIZE_SLOT_BYTES (1 << SIZE_SLOT_LOG)
+
+typedef struct {
+  unsigned int offset;
+  unsigned int count; // 0 if the slot is empty
+} HeapSize_t;
+
+typedef struct HeapRegion_t {
+  struct HeapRegion_t *next;
+
+  // The mapping that holds this region.
+  void *map;
+  size_t mapSize;
+
+  // The heap bytes, and how many of them there are.
+  unsigned char *data;
+  unsigned int size;
+
+  // How many bytes are marked in refCounts (with their '0' bits).
+  unsigned int usedBytes;
+
+  // Every bit below searchStart belongs to a part of refCounts that is packed
+  // so tightly that not even a 1 byte allocation would fit, so the large
+  // object path starts looking from there instead of from the beginning of
+  // the region.
+  unsigned int searchStart;
+
+  // The sizes of the big allocations.
+  HeapSize_t *sizes;
+
+  unsigned int refCountsSize;
+  uint64_t refCounts[];
+} HeapRegion_t;
+
+#define bitIsSet(region, bitI)                                      \
+  (loadWord((region)->refCounts[(bitI) >> WORD_BITS_LOG])           \
+   & BIT((bitI) & WORD_MASK))
+
+#define regionContains(region, alloc)   \
+  ((region)                             \
+   && (alloc) >= (region)->data         \
+   && (alloc) < (region)->data + (region)->size)
+
+static HeapConfig_t heapConfig;
+static HeapRegion_t *primaryRegion = NULL;
+
+// Small allocations are recycled through segregated free lists, one per
+// exact allocation size (the size classes). A freed small allocation keeps
+// its bits marked in refCounts and is pushed onto its list, so that the next
+// request of the same size is a pop instead of a bitmap search. The link to
+// the next free allocation is stored in the first bytes of the allocation,
+// so only allocations that can hold a pointer are recycled this way.
+// Only allocations from the primary region are recycled, so that grown
+// regions empty out and can be given back to the OS.
+// Everything else takes the large object path through refCounts.
+
+#define BIN_MIN_SIZE (sizeof(void *))
+#define BIN_MAX_SIZE (128) // no less than SIZE_SLOT_BYTES
+#define isBinSize(size) ((size) >= BIN_MIN_SIZE && (size) <= BIN_MAX_SIZE)
+
+static unsigned char *bins[BIN_MAX_SIZE + 1];
+
+#ifdef ANMAT_HEAP_THREAD_SAFE
+
+static pthread_mutex_t heapLock = PTHREAD_MUTEX_INITIALIZER;
 
-#define BIT(i) (1UL << (i))
+// In thread safe mode, each thread also gets its own set of free lists (a
+// cache) that it can pop from and push to without taking heapLock. An empty
+// cache list is refilled from the shared heap with a batch of allocations of
+// that size at a time.
+// The '0' byte at the end of a small allocation is not used for anything
+// else, so it holds the id of the cache that owns the allocation. A thread
+// that frees another thread's allocation pushes it onto the owner's remote
+// list for that size with a compare and swap. The owner takes the whole
+// remote list at once when its own list runs dry.
+// Cache 0 is never handed out; it means "owned by the shared free lists".
+// Threads that show up after all of the caches are taken use the shared
+// free lists directly.
+
+#define CACHE_COUNT       (32)
+#define CACHE_BATCH_BYTES (256)
+
+typedef struct {
+  unsigned char id;
+  bool inUse;
+  unsigned char *bins[BIN_MAX_SIZE + 1];
+  unsigned char *remoteBins[BIN_MAX_SIZE + 1];
+} HeapCache_t;
+
+static HeapCache_t caches[CACHE_COUNT];
+
+static pthread_once_t heapOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t cacheKey;
+static __thread HeapCache_t *threadCache = NULL;
+static __thread bool threadCacheChecked = false;
+
+#endif /* ANMAT_HEAP_THREAD_SAFE */
+
+#if defined(ANMAT_HEAP_THREAD_SAFE) || defined(ANMAT_HEAP_CHECK)
+  #define ownerOf(alloc, count) ((alloc)[count])
+  #define setOwner(alloc, count, owner) ((alloc)[count] = (owner))
+#else
+  #define setOwner(alloc, count, owner)
+#endif
 
 // We also keep track of free bytes for debugging/testing purposes.
+// Allocations sitting on a free list count as free.
+
+unsigned int heapFreeBytesCount = HEAP_DEFAULT_SIZE;
 
-unsigned int heapFreeBytesCount = HEAP_SIZE;
+// The counters behind heapGetStats. The fields that describe the bitmap are
+// filled in when a snapshot is taken.
+
+static HeapStats_t heapStats;
 
 // -----------------------------------------------------------------------------
-// API
+// Checks
+
+#ifdef ANMAT_HEAP_CHECK
 
-void heapInit(void)
+// With ANMAT_HEAP_CHECK, the '0' byte of a small allocation that is on a free
+// list says so, and a pointer that is given back must be the start of an
+// allocation: a set bit after a clear one (or the start of a region).
+
+#define FREED_OWNER (0xFF)
+
+static void checkFailed(const char *problem, void *alloc)
 {
-  unsigned char *refCount = &refCounts[0];
+  fprintf(stderr, "heap: %s 0x%p\n", problem, alloc);
+  abort();
+}
+
+#define checkAllocation(region, alloc)                                    \
+  do {                                                                    \
+    if (!(region)) {                                                      \
+      checkFailed("pointer is not from the heap:", (alloc));              \
+    } else if (!bitIsSet((region), (alloc) - (region)->data)              \
+               || ((alloc) != (region)->data                              \
+                   && bitIsSet((region), (alloc) - (region)->data - 1))) { \
+      checkFailed("pointer is not a live allocation:", (alloc));          \
+    }                                                                     \
+  } while (0)
+
+#define checkNotFreed(alloc, count)                         \
+  do {                                                      \
+    if (ownerOf((alloc), (count)) == FREED_OWNER) {         \
+      checkFailed("double free of", (alloc));               \
+    }                                                       \
+  } while (0)
+
+#define markFreed(alloc, count) setOwner((alloc), (count), FREED_OWNER)
+
+#else
+
+#define checkAllocation(region, alloc)
+#define checkNotFreed(alloc, count)
+#define markFreed(alloc, count)
+
+#endif /* ANMAT_HEAP_CHECK */
+
+// -----------------------------------------------------------------------------
+// Free Lists
 
-  while (refCount != REF_COUNTS_END) {
-    *refCount++ = 0x00;
+static inline unsigned char *binNext(unsigned char *alloc)
+{
+  unsigned char *next;
+  anmatMemcpy(&next, alloc, sizeof(next));
+  return next;
+}
+
+static inline void binPush(unsigned char **bin, unsigned char *alloc)
+{
+  anmatMemcpy(alloc, bin, sizeof(*bin));
+  *bin = alloc;
+}
+
+static inline unsigned char *binPop(unsigned char **bin)
+{
+  unsigned char *alloc = *bin;
+
+  if (alloc) {
+    *bin = binNext(alloc);
+  }
+
+  return alloc;
+}
+
+// -----------------------------------------------------------------------------
+// Regions
+
+static size_t pageSize(void)
+{
+  static size_t size = 0;
+
+  if (!size) {
+    size = sysconf(_SC_PAGESIZE);
+  }
+
+  return size;
+}
+
+// Map a region with room for size bytes, rounded up to a multiple of 64.
+// Returns NULL on failure.
+static HeapRegion_t *mapRegion(unsigned int size)
+{
+  HeapRegion_t *region;
+  size_t alignment, metaSize, mapSize;
+  unsigned char *map, *data, *end;
+
+  size = alignUp(size, WORD_BITS);
+  alignment = (size >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : REGION_ALIGNMENT);
+  metaSize  = (sizeof(HeapRegion_t)
+               + ((size >> WORD_BITS_LOG) + 1) * sizeof(uint64_t)
+               + ((size >> SIZE_SLOT_LOG) + 1) * sizeof(HeapSize_t));
+  mapSize   = metaSize + alignment + size;
+
+  map = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON,
+             -1, 0);
+  if (map == MAP_FAILED) {
+    return NULL;
   }
 
-  heapFreeBytesCount = HEAP_SIZE;
+  // Give back the slack after the heap bytes that the alignment did not need.
+  data = (unsigned char *)alignUp((uintptr_t)map + metaSize, alignment);
+  end  = (unsigned char *)alignUp((uintptr_t)data + size, pageSize());
+  if (end < map + mapSize) {
+    munmap(end, (map + mapSize) - end);
+    mapSize = end - map;
+  }
+
+#ifdef MADV_HUGEPAGE
+  if (alignment == HUGE_PAGE_SIZE) {
+    madvise(data, size, MADV_HUGEPAGE);
+  }
+#endif
+
+  // The mapping comes back zeroed, so refCounts and sizes are already clear.
+  region = (HeapRegion_t *)map;
+  region->next          = NULL;
+  region->map           = map;
+  region->mapSize       = mapSize;
+  region->data          = data;
+  region->size          = size;
+  region->usedBytes     = 0;
+  region->searchStart   = 0;
+  region->refCountsSize = size >> WORD_BITS_LOG;
+  region->sizes         = (HeapSize_t *)&region->refCounts[region->refCountsSize
+                                                           + 1];
+
+  note("heap: mapped %d byte region at 0x%p\n", size, data);
+
+  return region;
+}
+
+static void unmapRegion(HeapRegion_t *region)
+{
+  note("heap: unmapping %d byte region at 0x%p\n", region->size, region->data);
+  munmap(region->map, region->mapSize);
+}
+
+// Map another region that can fit count bytes and their '0' bit.
+// Each new region is at least as big as the rest of the heap put together,
+// so the number of regions stays logarithmic in the size of the heap.
+// Must be called with heapLock held.
+static HeapRegion_t *growHeap(unsigned int count)
+{
+  HeapRegion_t *region, *last = primaryRegion;
+  size_t total = 0, size;
+
+  for (region = primaryRegion; region; region = region->next) {
+    total += region->size;
+    last = region;
+  }
+
+  size = alignUp((size_t)count + 1, pageSize());
+  if (size < total) {
+    size = total;
+  }
+  if (size >= HUGE_PAGE_SIZE) {
+    size = alignUp(size, HUGE_PAGE_SIZE);
+  }
+  if (total + size > HEAP_MAX_SIZE || !(region = mapRegion(size))) {
+    return NULL;
+  }
+
+  last->next = region;
+  addFreeBytes(region->size);
+  addStat(heapStats.size, region->size);
+  heapStats.regionCount ++;
+
+  return region;
 }
 
-static void markRefCounts(unsigned char *alloc, unsigned int count)
+// Returns the region that alloc came from, or NULL if it is not from the heap.
+// Must be called with heapLock held.
+static HeapRegion_t *findRegion(unsigned char *alloc)
+{
+  HeapRegion_t *region;
+
+  for (region = primaryRegion; region; region = region->next) {
+    if (regionContains(region, alloc)) {
+      break;
+    }
+  }
+
+  return region;
+}
+
+// Unmap a grown region if there is nothing left in it.
+// Must be called with heapLock held.
+static void releaseRegion(HeapRegion_t *region)
+{
+  HeapRegion_t *previous;
+
+  if (region != primaryRegion && !region->usedBytes) {
+    for (previous = primaryRegion;
+         previous->next != region;
+         previous = previous->next) { }
+    previous->next = region->next;
+    subFreeBytes(region->size);
+    subStat(heapStats.size, region->size);
+    heapStats.regionCount --;
+    unmapRegion(region);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Reference Counts
+
+// Set or clear count bits starting at bitI, a word at a time.
+static void writeRefCounts(HeapRegion_t *region,
+                           unsigned int bitI,
+                           unsigned int count,
+                           bool set)
+{
+  uint64_t *refCount = &region->refCounts[bitI >> WORD_BITS_LOG];
+  unsigned int shift = bitI & WORD_MASK, bits;
+  uint64_t mask;
+
+  while (count) {
+    bits = WORD_BITS - shift;
+    if (bits > count) {
+      bits = count;
+    }
+    mask = (bits == WORD_BITS ? WORD_ONES : (BIT(bits) - 1)) << shift;
+
+    if (set) {
+      orWord(*refCount, mask);
+    } else {
+      andWord(*refCount, ~mask);
+    }
+
+    count -= bits;
+    shift = 0;
+    refCount ++;
+  }
+}
+
+#define sizeSlot(region, heapOffset) \
+  (&(region)->sizes[(heapOffset) >> SIZE_SLOT_LOG])
+
+// Record the size of the allocation at heapOffset if it is a big one, or
+// forget it if count is 0.
+static void recordSize(HeapRegion_t *region,
+                       unsigned int heapOffset,
+                       unsigned int count)
+{
+  HeapSize_t *slot = sizeSlot(region, heapOffset);
+
+  if (count > BIN_MAX_SIZE) {
+    slot->offset = heapOffset;
+    slot->count  = count;
+  } else if (slot->count && slot->offset == heapOffset) {
+    slot->count = 0;
+  }
+}
+
+static void clearRefCounts(HeapRegion_t *region,
+                           unsigned int heapOffset,
+                           unsigned int count)
+{
+  writeRefCounts(region, heapOffset, count, false);
+  recordSize(region, heapOffset, 0);
+  region->usedBytes -= count + 1;
+
+  // The bit before this allocation is either the start of the region or the
+  // '0' bit of the allocation before it, so that is where free space can
+  // start now.
+  heapOffset = (heapOffset ? heapOffset - 1 : 0);
+  if (heapOffset < region->searchStart) {
+    region->searchStart = heapOffset;
+  }
+}
+
+static void markRefCounts(HeapRegion_t *region,
+                          unsigned int heapOffset,
+                          unsigned int count)
 {
-  long heapOffset            = alloc - &datHeapDoe[0];
-  unsigned char *refCount    = &refCounts[heapOffset >> 3];
-  unsigned int refCountsMask = BIT(heapOffset & 0x7);
-  
   note("heapAlloc: marking heap from 0x%p to 0x%p\n",
-       alloc, alloc + count);
+       region->data + heapOffset, region->data + heapOffset + count);
+
+  // The extra '0' bit for the end of this allocation should already be
+  // cleared...
+  writeRefCounts(region, heapOffset, count, true);
+  recordSize(region, heapOffset, count);
+  region->usedBytes += count + 1;
+}
+
+// Returns the first bit at or after bitI that is set (or clear, if set is
+// false), or the size of the region if there is no such bit.
+static unsigned int nextBit(HeapRegion_t *region, unsigned int bitI, bool set)
+{
+  unsigned int wordI = bitI >> WORD_BITS_LOG;
+  uint64_t word;
 
-  while (count --) {
-    *refCount |= refCountsMask;
-    heapFreeBytesCount -= 1;
+  if (bitI >= region->size) {
+    return region->size;
+  }
 
-    if ((refCountsMask <<= 1) == BIT(8)) {
-      refCount ++;
-      refCountsMask = BIT(0);
+  word = loadWord(region->refCounts[wordI]);
+  word = (set ? word : ~word) & (WORD_ONES << (bitI & WORD_MASK));
+  while (!word) {
+    if (++wordI == region->refCountsSize) {
+      return region->size;
     }
+    word = loadWord(region->refCounts[wordI]);
+    word = (set ? word : ~word);
   }
 
-  // Mark an extra '0' bit for the end of this allocation.
-  // This bit should already be cleared...
-  *refCount &= ~refCountsMask;
-  heapFreeBytesCount -= 1;
+  return (wordI << WORD_BITS_LOG) + __builtin_ctzll(word);
 }
 
-void *heapAlloc(unsigned int count)
+// Grow or shrink the allocation at heapOffset from oldCount to count bytes
+// without moving it. It can only grow if the bits that it grows into and its
+// new '0' bit are all free.
+// Returns true iff the allocation was resized.
+static bool resizeRefCounts(HeapRegion_t *region,
+                            unsigned int heapOffset,
+                            unsigned int oldCount,
+                            unsigned int count)
 {
-  unsigned char *alloc = NULL, *heapPos = NULL, *refCount = NULL;
-  unsigned int bitI;
-  bool thisByteUsed, lastByteUsed;
-  static bool heapInitialized = false;
+  if (count > oldCount) {
+    if (heapOffset + count >= region->size
+        || nextBit(region, heapOffset + oldCount, true) <= heapOffset + count) {
+      return false;
+    }
+    writeRefCounts(region, heapOffset + oldCount, count - oldCount, true);
+    region->usedBytes += count - oldCount;
+  } else if (count < oldCount) {
+    writeRefCounts(region, heapOffset + count, oldCount - count, false);
+    region->usedBytes -= oldCount - count;
 
-  if (!heapInitialized) {
-    heapInit();
-    heapInitialized = true;
+    // Free space starts at the new '0' bit.
+    if (heapOffset + count < region->searchStart) {
+      region->searchStart = heapOffset + count;
+    }
   }
+  recordSize(region, heapOffset, count);
 
-  note("heapAlloc: allocating %d bytes\n", count + 1); // alloc byte
+  return true;
+}
+
+#ifndef HEAP_BITWISE_SEARCH
+
+// Returns the number of '1' bits starting at heapOffset, up to limit.
+static unsigned int bitmapLength(HeapRegion_t *region,
+                                 unsigned int heapOffset,
+                                 unsigned int limit)
+{
+  unsigned int length = 0, bitI;
+  uint64_t word;
+
+  while (length < limit) {
+    bitI = heapOffset + length;
+    word = ~loadWord(region->refCounts[bitI >> WORD_BITS_LOG]);
+    word >>= (bitI & WORD_MASK);
+    if (word) {
+      length += __builtin_ctzll(word);
+      break;
+    }
+    length += WORD_BITS - (bitI & WORD_MASK);
+  }
+
+  return (length < limit ? length : limit);
+}
+
+// Find the first place at or after searchStart, on a multiple of alignment,
+// where count bytes and their extra '0' bit fit. An allocation cannot start
+// on the '0' bit of the allocation before it, so a run of free bits that
+// follows an allocation only starts one bit in.
+// Returns the size of the region if there is no such place.
+static unsigned int findFreeRun(HeapRegion_t *region,
+                                unsigned int count,
+                                unsigned int alignment)
+{
+  unsigned int runStart, runEnd, allocStart;
+  bool packed = true;
+
+  runStart = region->searchStart;
+  if (runStart && bitIsSet(region, runStart - 1)) {
+    runStart ++;
+  }
+
+  while (runStart < region->size) {
+    runEnd = nextBit(region, runStart, true);
+    if (runEnd > runStart) {
+      allocStart = alignUp(runStart, alignment);
+      if (runEnd > allocStart && runEnd - allocStart > count) {
+        // Only move searchStart past this run if the bits skipped for the
+        // alignment could not hold anything anyway.
+        if (packed && allocStart - runStart < 2) {
+          region->searchStart = allocStart + count + 1;
+        }
+        return allocStart;
+      } else if (runEnd - runStart > 1) {
+        packed = false;
+      }
+    }
+
+    // Skip the allocation and its '0' bit.
+    runStart = nextBit(region, runEnd, false) + 1;
+  }
+
+  return region->size;
+}
+
+#else
+
+// The original search, a bit at a time. Only built for comparison in
+// tst/heap-bench.c.
+
+static unsigned int bitmapLength(HeapRegion_t *region,
+                                 unsigned int heapOffset,
+                                 unsigned int limit)
+{
+  unsigned int length = 0;
+
+  while (length < limit && bitIsSet(region, heapOffset + length)) {
+    length ++;
+  }
+
+  return length;
+}
+
+static unsigned int findFreeRun(HeapRegion_t *region,
+                                unsigned int count,
+                                unsigned int alignment)
+{
+  unsigned int bitI, runStart;
+  bool packed = (alignment == 1);
+
+  runStart = region->searchStart;
+  if (runStart && bitIsSet(region, runStart - 1)) {
+    runStart ++;
+  }
+  runStart = alignUp(runStart, alignment);
+
+  for (bitI = region->searchStart; bitI < region->size; bitI ++) {
+    if (bitIsSet(region, bitI)) {
+      if (bitI >= runStart + 2) {
+        packed = false;
+      }
+      runStart = alignUp(bitI + 2, alignment);
+    } else if (bitI >= runStart && bitI - runStart == count) {
+      if (packed) {
+        region->searchStart = bitI + 1;
+      }
+      return runStart;
+    }
+  }
+
+  return region->size;
+}
+
+#endif /* HEAP_BITWISE_SEARCH */
+
+// Returns the length of the allocation at heapOffset.
+static unsigned int allocationLength(HeapRegion_t *region,
+                                     unsigned int heapOffset)
+{
+  HeapSize_t *slot = sizeSlot(region, heapOffset);
+
+  if (slot->count && slot->offset == heapOffset) {
+    return slot->count;
+  }
+
+  return bitmapLength(region, heapOffset, BIN_MAX_SIZE + 1);
+}
+
+#ifdef ANMAT_HEAP_THREAD_SAFE
+static void flushCache(HeapCache_t *cache);
+#endif
+
+static void drainBin(unsigned char **bin, unsigned int count)
+{
+  unsigned char *alloc;
+
+  while ((alloc = binPop(bin))) {
+    clearRefCounts(primaryRegion, alloc - primaryRegion->data, count);
+  }
+}
 
-  if (count) {
-    for (refCount = refCounts; refCount < REF_COUNTS_END; refCount++) {
-      if (*refCount == 0xFF) {
-        lastByteUsed = true;
-        continue;
+// Give every allocation on the shared free lists back to refCounts.
+// In thread safe mode, the calling thread's cache and the remote lists of
+// every cache are given back too, since any thread may take a whole remote
+// list.
+// Must be called with heapLock held.
+// Returns true iff there was anything to give back.
+static bool drainBins(void)
+{
+  unsigned int count;
+  bool drained = false;
+#ifdef ANMAT_HEAP_THREAD_SAFE
+  unsigned char *remote;
+  HeapCache_t *cache;
+
+  if (threadCache) {
+    flushCache(threadCache);
+  }
+#endif
+
+  for (count = BIN_MIN_SIZE; count <= BIN_MAX_SIZE; count ++) {
+    drained = drained || bins[count];
+    drainBin(&bins[count], count);
+
+#ifdef ANMAT_HEAP_THREAD_SAFE
+    for (cache = &caches[1]; cache < &caches[CACHE_COUNT]; cache ++) {
+      remote = __atomic_exchange_n(&cache->remoteBins[count], NULL,
+                                   __ATOMIC_ACQUIRE);
+      drained = drained || remote;
+      drainBin(&remote, count);
+    }
+#endif
+  }
+
+  return drained;
+}
+
+// Find room for count bytes in any region. Regions start on a multiple of
+// REGION_ALIGNMENT, so aligning the offset aligns the address.
+// Must be called with heapLock held.
+static unsigned char *regionsAlloc(unsigned int count, unsigned int alignment)
+{
+  HeapRegion_t *region;
+  unsigned int heapOffset;
+
+  for (region = primaryRegion; region; region = region->next) {
+    if (region->size - region->usedBytes > count) {
+      heapOffset = findFreeRun(region, count, alignment);
+      if (heapOffset != region->size) {
+        markRefCounts(region, heapOffset, count);
+        return region->data + heapOffset;
       }
-      for (bitI = 0; bitI < 8; bitI ++) {
-        thisByteUsed = *refCount & BIT(bitI);
-        if (!thisByteUsed && !lastByteUsed) {
-          heapPos = &(datHeapDoe[((refCount - &refCounts[0]) << 3) + bitI]);
-          if (!alloc) {
-            alloc = heapPos;
-          } else if (heapPos - alloc == count) {
-            markRefCounts(alloc, count);
-            goto done;
+    }
+  }
+
+  return NULL;
+}
+
+// Allocate count bytes on a multiple of alignment from the shared heap.
+// The free lists are only used for unaligned allocations.
+// Must be called with heapLock held.
+static unsigned char *sharedAlloc(unsigned int count, unsigned int alignment)
+{
+  unsigned char *alloc = NULL;
+
+  if (isBinSize(count) && alignment == 1) {
+    alloc = binPop(&bins[count]);
+  }
+
+  if (!alloc) {
+    alloc = regionsAlloc(count, alignment);
+  }
+
+  if (!alloc && drainBins()) {
+    alloc = regionsAlloc(count, alignment);
+  }
+
+  if (!alloc && heapConfig.growable && growHeap(count)) {
+    alloc = regionsAlloc(count, alignment);
+  }
+
+  return alloc;
+}
+
+// -----------------------------------------------------------------------------
+// Thread Caches
+
+#ifdef ANMAT_HEAP_THREAD_SAFE
+
+// Give everything in a cache back to the shared free lists.
+// Must be called with heapLock held.
+static void flushCache(HeapCache_t *cache)
+{
+  unsigned char *alloc, *remote;
+  unsigned int count;
+
+  for (count = BIN_MIN_SIZE; count <= BIN_MAX_SIZE; count ++) {
+    while ((alloc = binPop(&cache->bins[count]))) {
+      binPush(&bins[count], alloc);
+    }
+    remote = __atomic_exchange_n(&cache->remoteBins[count], NULL,
+                                 __ATOMIC_ACQUIRE);
+    while ((alloc = binPop(&remote))) {
+      binPush(&bins[count], alloc);
+    }
+  }
+}
+
+static void releaseCache(void *cache)
+{
+  lockHeap();
+  flushCache((HeapCache_t *)cache);
+  ((HeapCache_t *)cache)->inUse = false;
+  unlockHeap();
+}
+
+// Returns the calling thread's cache, or NULL if it does not have one.
+static HeapCache_t *getThreadCache(void)
+{
+  HeapCache_t *cache;
+
+  if (!threadCacheChecked) {
+    threadCacheChecked = true;
+    lockHeap();
+    for (cache = &caches[1]; cache < &caches[CACHE_COUNT]; cache ++) {
+      if (!cache->inUse) {
+        cache->inUse = true;
+        threadCache = cache;
+        pthread_setspecific(cacheKey, cache);
+        break;
+      }
+    }
+    unlockHeap();
+  }
+
+  return threadCache;
+}
+
+static void remotePush(HeapCache_t *cache,
+                       unsigned char *alloc,
+                       unsigned int count)
+{
+  unsigned char *head = __atomic_load_n(&cache->remoteBins[count],
+                                        __ATOMIC_RELAXED);
+
+  do {
+    anmatMemcpy(alloc, &head, sizeof(head));
+  } while (!__atomic_compare_exchange_n(&cache->remoteBins[count],
+                                        &head,
+                                        alloc,
+                                        true, // weak
+                                        __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED));
+}
+
+static unsigned char *cacheAlloc(HeapCache_t *cache, unsigned int count)
+{
+  unsigned char *alloc = binPop(&cache->bins[count]), *refill;
+  unsigned int batch, heapOffset;
+
+  if (!alloc) {
+    // Take back whatever other threads have freed...
+    cache->bins[count] = __atomic_exchange_n(&cache->remoteBins[count], NULL,
+                                             __ATOMIC_ACQUIRE);
+    alloc = binPop(&cache->bins[count]);
+  }
+
+  if (!alloc) {
+    // ...or go to the shared heap. Only the primary region is cached, so the
+    // rest of the batch only comes from the shared free lists and the
+    // primary region, without draining anything or growing the heap.
+    lockHeap();
+    alloc = sharedAlloc(count, 1);
+    if (alloc && regionContains(primaryRegion, alloc)) {
+      for (batch = CACHE_BATCH_BYTES / (count + 1); batch > 1; batch --) {
+        if (!(refill = binPop(&bins[count]))) {
+          heapOffset = findFreeRun(primaryRegion, count, 1);
+          if (heapOffset == primaryRegion->size) {
+            break;
           }
-        } else {
-          alloc = NULL;
+          markRefCounts(primaryRegion, heapOffset, count);
+          refill = primaryRegion->data + heapOffset;
         }
-        lastByteUsed = thisByteUsed;
+        markFreed(refill, count);
+        binPush(&cache->bins[count], refill);
       }
     }
+    unlockHeap();
+  }
+
+  if (alloc) {
+    setOwner(alloc, count, cache->id);
+  }
+
+  return alloc;
+}
+
+static void heapInitOnce(void)
+{
+  if (!primaryRegion) {
+    heapInit(NULL);
+  }
+}
+
+#endif /* ANMAT_HEAP_THREAD_SAFE */
+
+// -----------------------------------------------------------------------------
+// Statistics
+
+// Request sizes are bucketed by their highest set bit.
+#define histogramBucket(count) \
+  ((sizeof(unsigned int) * 8) - 1 - __builtin_clz(count))
+
+static void countAlloc(unsigned int count)
+{
+  unsigned int live;
+
+  live = loadStat(heapStats.size) - subFreeBytes(count + 1);
+  maxStat(heapStats.peakLiveBytes, live);
+  addStat(heapStats.allocCount, 1);
+  addStat(heapStats.histogram[histogramBucket(count)], 1);
+}
+
+static void countResize(unsigned int oldCount, unsigned int count)
+{
+  unsigned int live;
+
+  if (count > oldCount) {
+    live = loadStat(heapStats.size) - subFreeBytes(count - oldCount);
+    maxStat(heapStats.peakLiveBytes, live);
+  } else {
+    addFreeBytes(oldCount - count);
+  }
+}
+
+static void countFree(unsigned int count)
+{
+  addFreeBytes(count + 1); // for the extra '0' bit at the end
+  addStat(heapStats.freeCount, 1);
+}
+
+// Returns the biggest allocation that fits in a region without using the
+// free lists.
+static unsigned int largestFreeRun(HeapRegion_t *region)
+{
+  unsigned int runStart, runEnd, largest = 0;
+
+  // Every run of free bits but the one at the start of the region begins
+  // with the '0' bit of an allocation, and the last free bit of a run is the
+  // '0' bit for whatever goes in it.
+  for (runStart = nextBit(region, 0, false);
+       runStart < region->size;
+       runStart = nextBit(region, runEnd, false)) {
+    runEnd = nextBit(region, runStart, true);
+    if (runEnd - runStart > largest + 1 + (runStart ? 1 : 0)) {
+      largest = runEnd - runStart - 1 - (runStart ? 1 : 0);
+    }
+  }
+
+  return largest;
+}
+
+// -----------------------------------------------------------------------------
+// API
+
+AnmatStatus_t heapInit(const HeapConfig_t *config)
+{
+  HeapRegion_t *region;
+  unsigned int count;
+  HeapConfig_t defaultConfig = HEAP_CONFIG_DEFAULT;
+#ifdef ANMAT_HEAP_THREAD_SAFE
+  static bool cachesCreated = false;
+  HeapCache_t *cache;
+
+  if (!cachesCreated) {
+    for (count = 0; count < CACHE_COUNT; count ++) {
+      caches[count].id = count;
+    }
+    pthread_key_create(&cacheKey, releaseCache);
+    cachesCreated = true;
+  }
+#endif
+
+  if (!config) {
+    config = &defaultConfig;
+  }
+  if (!config->size || config->size > HEAP_MAX_SIZE) {
+    return ANMAT_BAD_ARG;
+  }
+
+  // Give back every grown region, and the primary region too unless it is
+  // already the right size.
+  while (primaryRegion && primaryRegion->next) {
+    region = primaryRegion->next;
+    primaryRegion->next = region->next;
+    unmapRegion(region);
+  }
+  if (primaryRegion && primaryRegion->size != alignUp(config->size, WORD_BITS)) {
+    unmapRegion(primaryRegion);
+    primaryRegion = NULL;
+  }
+
+  if (primaryRegion) {
+    writeRefCounts(primaryRegion, 0, primaryRegion->size, false);
+    for (count = 0; count <= (primaryRegion->size >> SIZE_SLOT_LOG); count ++) {
+      primaryRegion->sizes[count].count = 0;
+    }
+    primaryRegion->usedBytes = primaryRegion->searchStart = 0;
+  } else if (!(primaryRegion = mapRegion(config->size))) {
+    heapFreeBytesCount = 0;
+    return ANMAT_MEM_ERR;
+  }
+
+  for (count = 0; count <= BIN_MAX_SIZE; count ++) {
+    bins[count] = NULL;
+#ifdef ANMAT_HEAP_THREAD_SAFE
+    for (cache = &caches[0]; cache < &caches[CACHE_COUNT]; cache ++) {
+      cache->bins[count] = cache->remoteBins[count] = NULL;
+    }
+#endif
+  }
+
+  heapConfig = *config;
+  heapFreeBytesCount = primaryRegion->size;
+
+  heapStats = (HeapStats_t) { 0 };
+  heapStats.size = primaryRegion->size;
+  heapStats.regionCount = 1;
+
+  return ANMAT_SUCCESS;
+}
+
+void *heapAlloc(unsigned int count)
+{
+  return heapAllocAligned(count, 1);
+}
+
+void *heapAllocAligned(unsigned int count, unsigned int alignment)
+{
+  unsigned char *alloc = NULL;
+#ifdef ANMAT_HEAP_THREAD_SAFE
+  HeapCache_t *cache;
+
+  pthread_once(&heapOnce, heapInitOnce);
+#else
+  if (!primaryRegion) {
+    heapInit(NULL);
+  }
+#endif
+
+  note("heapAlloc: allocating %d bytes\n", count + 1); // alloc byte
+
+  if (count
+      && count < HEAP_MAX_SIZE
+      && alignment
+      && alignment <= HEAP_MAX_ALIGNMENT
+      && !(alignment & (alignment - 1))) {
+#ifdef ANMAT_HEAP_THREAD_SAFE
+    if (isBinSize(count) && alignment == 1 && (cache = getThreadCache())) {
+      alloc = cacheAlloc(cache, count);
+    } else
+#endif
+    {
+      lockHeap();
+      alloc = sharedAlloc(count, alignment);
+      unlockHeap();
+      if (alloc && isBinSize(count)) {
+        setOwner(alloc, count, 0);
+      }
+    }
+
+    if (alloc) {
+      countAlloc(count);
+    }
+  }
+
+  if (!alloc) {
+    addStat(heapStats.failedAllocCount, 1);
   }
 
- done:
   return alloc;
 }
 
 void heapFree(void *memory)
 {
   // stupid compiler grumble...
-  unsigned char *alloc        = (unsigned char *)memory;
-  long heapOffset             = alloc - &datHeapDoe[0];
-  unsigned int refCountsIndex = heapOffset >> 3;
-  unsigned int refCountsMask  = BIT(heapOffset & 0x7);
-
-  if (alloc >= &datHeapDoe[0] && alloc < &datHeapDoe[HEAP_SIZE]) {
-    while (refCounts[refCountsIndex] & refCountsMask) {
-      refCounts[refCountsIndex] &= ~refCountsMask;
-      heapFreeBytesCount ++;
-
-      if ((refCountsMask <<= 1) == BIT(8)) {
-        refCountsIndex ++;
-        refCountsMask = BIT(0);
+  unsigned char *alloc = (unsigned char *)memory;
+  HeapRegion_t *region;
+  unsigned int count;
+#ifdef ANMAT_HEAP_THREAD_SAFE
+  unsigned char owner;
+#endif
+
+  if (!alloc) {
+    return;
+  }
+
+  // Small allocations from the primary region go back on a free list.
+  // Only the primary region is looked at without the lock, since grown
+  // regions may come and go. Only the bits of a small allocation are walked,
+  // since the sizes of the big ones are looked at with the lock held.
+  if (regionContains(primaryRegion, alloc)) {
+    checkAllocation(primaryRegion, alloc);
+    count = bitmapLength(primaryRegion, alloc - primaryRegion->data,
+                         BIN_MAX_SIZE + 1);
+    if (isBinSize(count)) {
+      checkNotFreed(alloc, count);
+      countFree(count);
+
+#ifdef ANMAT_HEAP_THREAD_SAFE
+      owner = ownerOf(alloc, count);
+      markFreed(alloc, count);
+      if (owner) {
+        if (threadCache && owner == threadCache->id) {
+          binPush(&threadCache->bins[count], alloc);
+        } else {
+          remotePush(&caches[owner], alloc, count);
+        }
+        return;
       }
+#else
+      markFreed(alloc, count);
+#endif
+
+      lockHeap();
+      binPush(&bins[count], alloc);
+      unlockHeap();
+      return;
     }
-    heapFreeBytesCount ++; // for the extra '0' bit at the end of the allocation
   }
+
+  lockHeap();
+  region = findRegion(alloc);
+  checkAllocation(region, alloc);
+  if (region) {
+    count = allocationLength(region, alloc - region->data);
+    clearRefCounts(region, alloc - region->data, count);
+    countFree(count);
+    releaseRegion(region);
+  }
+  unlockHeap();
 }
 
-void heapPrint(FILE *stream)
+void *heapRealloc(void *memory, unsigned int count)
 {
-  unsigned char *refCount, *alloc;
-  unsigned int refCountMask;
+  unsigned char *alloc = (unsigned char *)memory, *newAlloc;
+  HeapRegion_t *region;
+  unsigned int oldCount = 0;
+  bool resized = false;
 
-  for (refCount = &refCounts[0], refCountMask = BIT(0), alloc = &datHeapDoe[0];
-       refCount != REF_COUNTS_END;
-       refCount ++, alloc ++) {
-    if (refCountMask == BIT(0)) {
-      fprintf(stream, "(%ld) ", refCount - &refCounts[0]);
+  if (!alloc) {
+    return heapAlloc(count);
+  } else if (!count) {
+    heapFree(alloc);
+    return NULL;
+  }
+
+  if (count < HEAP_MAX_SIZE) {
+    lockHeap();
+    region = findRegion(alloc);
+    checkAllocation(region, alloc);
+    if (region) {
+      oldCount = allocationLength(region, alloc - region->data);
+      resized = resizeRefCounts(region, alloc - region->data, oldCount, count);
     }
-    if (*refCount & refCountMask) {
-      fprintf(stream, " 0x%02X", *alloc);
-    } else {
-      fprintf(stream, " ____");
+    unlockHeap();
+  }
+
+  if (resized) {
+    note("heapRealloc: resized 0x%p from %d to %d bytes\n",
+         alloc, oldCount, count);
+    countResize(oldCount, count);
+    // Whichever cache the old size belonged to, the new size belongs to the
+    // shared free lists.
+    if (isBinSize(count)) {
+      setOwner(alloc, count, 0);
+    }
+    return alloc;
+  }
+
+  // Move it. The old allocation is left alone if there is no room.
+  newAlloc = (unsigned char *)heapAlloc(count);
+  if (newAlloc) {
+    anmatMemcpy(newAlloc, alloc, (oldCount < count ? oldCount : count));
+    heapFree(alloc);
+  }
+
+  return newAlloc;
+}
+
+void heapGetStats(HeapStats_t *stats)
+{
+  HeapRegion_t *region;
+  unsigned int largest;
+
+  lockHeap();
+
+  *stats = heapStats;
+  stats->freeBytes = loadStat(heapFreeBytesCount);
+  stats->liveBytes = stats->size - stats->freeBytes;
+
+  stats->largestFreeRun = 0;
+  for (region = primaryRegion; region; region = region->next) {
+    largest = largestFreeRun(region);
+    if (largest > stats->largestFreeRun) {
+      stats->largestFreeRun = largest;
+    }
+  }
+
+  // If the free bytes were all in one place, the biggest allocation would be
+  // one byte less than all of them.
+  stats->fragmentation = 0;
+  if (stats->freeBytes > 1) {
+    stats->fragmentation = 1.0 - ((double)stats->largestFreeRun
+                                  / (stats->freeBytes - 1));
+  }
+
+  unlockHeap();
+}
+
+void heapPrintStats(FILE *stream)
+{
+  HeapStats_t stats;
+  unsigned int bucket, lastBucket = 0;
+
+  heapGetStats(&stats);
+
+  fprintf(stream,
+          "{\"size\": %u, \"regionCount\": %u, "
+          "\"freeBytes\": %u, \"liveBytes\": %u, \"peakLiveBytes\": %u, "
+          "\"allocCount\": %lu, \"freeCount\": %lu, "
+          "\"failedAllocCount\": %lu, "
+          "\"largestFreeRun\": %u, \"fragmentation\": %.4f, "
+          "\"histogram\": [",
+          stats.size, stats.regionCount,
+          stats.freeBytes, stats.liveBytes, stats.peakLiveBytes,
+          stats.allocCount, stats.freeCount,
+          stats.failedAllocCount,
+          stats.largestFreeRun, stats.fragmentation);
+
+  // Leave off the empty buckets at the end.
+  for (bucket = 0; bucket < HEAP_STATS_BUCKETS; bucket ++) {
+    if (stats.histogram[bucket]) {
+      lastBucket = bucket;
     }
-    if ((refCountMask <<= 1) == BIT(8)) {
-      refCountMask = BIT(0);
-      fprintf(stream, "\n");
+  }
+  for (bucket = 0; bucket <= lastBucket; bucket ++) {
+    fprintf(stream, "%s%lu", (bucket ? ", " : ""), stats.histogram[bucket]);
+  }
+
+  fprintf(stream, "]}\n");
+  fflush(stream);
+}
+
+void heapPrint(FILE *stream)
+{
+  HeapRegion_t *region;
+  unsigned int heapOffset;
+
+  for (region = primaryRegion; region; region = region->next) {
+    fprintf(stream, "region 0x%p (%d bytes)\n", region->data, region->size);
+    for (heapOffset = 0; heapOffset < region->size; heapOffset ++) {
+      if (!(heapOffset & 0x7)) {
+        fprintf(stream, "(%d) ", heapOffset >> 3);
+      }
+      if (bitIsSet(region, heapOffset)) {
+        fprintf(stream, " 0x%02X", region->data[heapOffset]);
+      } else {
+        fprintf(stream, " ____");
+      }
+      if ((heapOffset & 0x7) == 0x7) {
+        fprintf(stream, "\n");
+      }
     }
   }
 
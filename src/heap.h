@@ -8,26 +8,79 @@
 // Heap management for anmat library.
 //
 
+#ifndef __HEAP_H__
+#define __HEAP_H__
+
 #include "anmat.h"
 
-// The log base 2 size of the heap.
-#define ANMAT_HEAP_SIZE_LOG (12)
+// The log base 2 of the default size of the heap.
+#ifndef ANMAT_HEAP_SIZE_LOG
+  #define ANMAT_HEAP_SIZE_LOG (12)
+#endif
+
+// The heap is not thread safe unless the library is built with
+// ANMAT_HEAP_THREAD_SAFE defined (and linked with -pthread). In that mode
+// each thread allocates small blocks from its own cache, and memory may be
+// freed from any thread.
+//#define ANMAT_HEAP_THREAD_SAFE
+
+// Building with ANMAT_HEAP_CHECK defined makes heapFree and heapRealloc check
+// that they are given the start of a live allocation. A double free or a
+// pointer that did not come from the heap prints a message to stderr and
+// aborts. This is meant for debug builds.
+//#define ANMAT_HEAP_CHECK
+
+// How the heap should be set up.
+typedef struct {
+  // The size of the first region of the heap, in bytes.
+  // Rounded up to a multiple of 64.
+  unsigned int size;
+
+  // Whether the heap may map more regions from the OS when an allocation
+  // does not fit. Grown regions are given back to the OS once they are empty.
+  bool growable;
+} HeapConfig_t;
+
+#define HEAP_CONFIG_DEFAULT { (1 << ANMAT_HEAP_SIZE_LOG), true, }
 
-// Initialize the heap.
-// Note that the heap is automagically initliazed
-// with the first call to heapAlloc.
-void heapInit(void);
+// Initialize the heap, throwing away everything that was allocated.
+// A NULL config means HEAP_CONFIG_DEFAULT.
+// Note that the heap is automagically initliazed with the default config
+// with the first call to heapAlloc, unless it was already initialized.
+// Never thread safe; nothing else may be using the heap.
+// Returns ANMAT_BAD_ARG for a bad config and ANMAT_MEM_ERR if the memory
+// could not be mapped.
+AnmatStatus_t heapInit(const HeapConfig_t *config);
 
 // Allocate bytes.
 // Returns NULL on failure.
 // The heap is automagically initialized the first time this is called.
-// Not thread safe.
+// Only thread safe with ANMAT_HEAP_THREAD_SAFE.
 void *heapAlloc(unsigned int count);
 
+// The biggest alignment that heapAllocAligned can provide.
+#define HEAP_MAX_ALIGNMENT (64)
+
+// Allocate bytes starting on a multiple of alignment, which must be a power
+// of 2 no bigger than HEAP_MAX_ALIGNMENT.
+// Returns NULL on failure or for a bad alignment.
+// Only thread safe with ANMAT_HEAP_THREAD_SAFE.
+void *heapAllocAligned(unsigned int count, unsigned int alignment);
+
 // Free memory.
-// Not thread safe.
+// Only thread safe with ANMAT_HEAP_THREAD_SAFE.
 void heapFree(void *memory);
 
+// Resize an allocation to count bytes, keeping its contents (up to the
+// smaller of the two sizes). The allocation grows in place if the bytes after
+// it are free, and is moved otherwise.
+// A NULL memory is the same as heapAlloc(count), and a count of 0 is the same
+// as heapFree(memory).
+// Returns the (possibly new) allocation, or NULL on failure, in which case
+// memory is left alone.
+// Only thread safe with ANMAT_HEAP_THREAD_SAFE.
+void *heapRealloc(void *memory, unsigned int count);
+
 // The number of free bytes in the heap.
 // Useful for debugging.
 extern unsigned int heapFreeBytesCount;
@@ -35,3 +88,52 @@ extern unsigned int heapFreeBytesCount;
 // Print the heap.
 // Useful for debugging.
 void heapPrint(FILE *stream);
+
+// -----------------------------------------------------------------------------
+// Statistics
+
+// The number of buckets in the request size histogram. Bucket i counts
+// requests for [2^i, 2^(i + 1)) bytes.
+#define HEAP_STATS_BUCKETS (32)
+
+// A snapshot of what the heap is doing, since the last heapInit.
+// Byte counts include the extra byte that each allocation uses.
+typedef struct {
+  // Bytes mapped for the heap, and in how many regions.
+  unsigned int size;
+  unsigned int regionCount;
+
+  // Bytes that are free (including the free lists) and handed out.
+  unsigned int freeBytes;
+  unsigned int liveBytes;
+
+  // The most bytes that were ever handed out at once.
+  unsigned int peakLiveBytes;
+
+  // Calls to heapAlloc/heapAllocAligned that succeeded and that failed, and
+  // calls to heapFree.
+  unsigned long allocCount;
+  unsigned long failedAllocCount;
+  unsigned long freeCount;
+
+  // Successful allocations by request size.
+  unsigned long histogram[HEAP_STATS_BUCKETS];
+
+  // The biggest allocation that fits in the heap without growing it or
+  // draining the free lists.
+  unsigned int largestFreeRun;
+
+  // How much of the free memory cannot be used for one big allocation,
+  // from 0 (none of it) to 1 (all of it).
+  double fragmentation;
+} HeapStats_t;
+
+// Take a snapshot of the heap statistics.
+// The counters are always kept; the snapshot walks the bitmap to find the
+// largest free run.
+void heapGetStats(HeapStats_t *stats);
+
+// Print a snapshot of the heap statistics to a stream as one line of JSON.
+void heapPrintStats(FILE *stream);
+
+#endif /* __HEAP_H__ */
@@ -0,0 +1,98 @@
+//
+// kernels-table.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// The table of kernels for one precision.
+//
+// This is included by kernels.h once per precision, with these defined (see
+// matrix.h):
+//   ANMAT_VALUE      - the type of a value (double or float)
+//   ANMAT_TYPE(name) - the name of a type for this precision
+//
+
+// The kernels for one SIMD level. Pointers do not have to be aligned.
+typedef struct {
+  // The multiply micro kernel computes a gemmMr x gemmNr tile of C from kc
+  // columns of a packed A sliver (gemmMr values at a time) and kc rows of a
+  // packed B sliver (gemmNr values at a time), and puts the top left mr x nr
+  // of (alpha * tile) + (beta * c) into c. See gemm.c.
+  unsigned int gemmMr, gemmNr;
+  void (*gemmMicro)(unsigned int kc,
+                    const ANMAT_VALUE *a,
+                    const ANMAT_VALUE *b,
+                    ANMAT_VALUE *c,
+                    unsigned int ldc,
+                    unsigned int mr,
+                    unsigned int nr,
+                    ANMAT_VALUE alpha,
+                    ANMAT_VALUE beta);
+
+  // Multiply count m x k matrices at a by count k x n matrices at b into the
+  // m x n matrices at c, stored value by value (see ANMAT_BATCH_SOA in
+  // batch.h): value v of problem p is at a[(v * ld) + p], and so on.
+  // c must not overlap a or b.
+  void (*batchMultiply)(unsigned int m,
+                        unsigned int n,
+                        unsigned int k,
+                        const ANMAT_VALUE *a,
+                        const ANMAT_VALUE *b,
+                        ANMAT_VALUE *c,
+                        size_t ld,
+                        unsigned int count);
+
+  // Element-wise kernels, for count values. Each reads its inputs and writes
+  // c once. c may be a or b.
+
+  // c[i] = alpha * a[i]
+  void (*scale)(const ANMAT_VALUE *a,
+                ANMAT_VALUE alpha,
+                ANMAT_VALUE *c,
+                unsigned int count);
+
+  // c[i] = (alpha * a[i]) + (beta * b[i])
+  void (*axpby)(const ANMAT_VALUE *a,
+                ANMAT_VALUE alpha,
+                const ANMAT_VALUE *b,
+                ANMAT_VALUE beta,
+                ANMAT_VALUE *c,
+                unsigned int count);
+
+  // c[i] = a[i] * b[i]
+  void (*multiply)(const ANMAT_VALUE *a,
+                   const ANMAT_VALUE *b,
+                   ANMAT_VALUE *c,
+                   unsigned int count);
+
+  // c[i] = a[i] / b[i]
+  void (*divide)(const ANMAT_VALUE *a,
+                 const ANMAT_VALUE *b,
+                 ANMAT_VALUE *c,
+                 unsigned int count);
+
+  // c[i] = a[i], but no less than low and no more than high. NaN stays NaN.
+  void (*clamp)(const ANMAT_VALUE *a,
+                ANMAT_VALUE low,
+                ANMAT_VALUE high,
+                ANMAT_VALUE *c,
+                unsigned int count);
+
+  // Put the transpose of the rows x cols block at a into b.
+  // The blocks must not overlap.
+  void (*transpose)(const ANMAT_VALUE *a,
+                    unsigned int lda,
+                    ANMAT_VALUE *b,
+                    unsigned int ldb,
+                    unsigned int rows,
+                    unsigned int cols);
+
+  // The sum of u[i] * v[i] for count values.
+  ANMAT_VALUE (*dot)(const ANMAT_VALUE *u,
+                     const ANMAT_VALUE *v,
+                     unsigned int count);
+
+  // The sum of count values.
+  ANMAT_VALUE (*sum)(const ANMAT_VALUE *v, unsigned int count);
+} ANMAT_TYPE(Kernels);
@@ -0,0 +1,534 @@
+//
+// kernels-template.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// The kernels for one SIMD level and one precision.
+//
+// This is included by simd.c once per level and precision, with these
+// defined:
+//   ANMAT_VALUE      - the type of a value (double or float)
+//   ANMAT_TYPE(name) - the name of a type for this precision (see matrix.h)
+//   KERNEL(name)     - the name of a kernel at this level and precision
+//   KERNEL_TARGET    - the function attribute that enables the level
+//   KERNEL_LANES     - the values in a vector register (2, 4, 8 or 16)
+//   KERNEL_MR        - the rows in a multiply micro kernel tile
+//   KERNEL_NR        - the cols in a multiply micro kernel tile (a multiple
+//                      of KERNEL_LANES)
+// Everything is written with the GCC/clang vector extensions, so the compiler
+// picks the instructions for the target.
+//
+
+#define VECTOR         KERNEL(Vector_t)
+#define VECTOR_VALUES  (KERNEL_LANES)
+#define TILE_VECTORS   (KERNEL_NR / VECTOR_VALUES)
+
+typedef ANMAT_VALUE VECTOR
+  __attribute__((vector_size(KERNEL_LANES * sizeof(ANMAT_VALUE))));
+
+#define load(vector, pointer) \
+  __builtin_memcpy(&(vector), (pointer), sizeof(VECTOR))
+#define store(pointer, vector) \
+  __builtin_memcpy((pointer), &(vector), sizeof(VECTOR))
+
+// -----------------------------------------------------------------------------
+// Multiply
+
+// Each row of the tile is kept in TILE_VECTORS vector registers, and each
+// value of the A sliver is broadcast across a vector. The loops are unrolled
+// all the way so that the tile never leaves the registers.
+KERNEL_TARGET
+static void KERNEL(gemmMicro)(unsigned int kc,
+                              const ANMAT_VALUE *restrict a,
+                              const ANMAT_VALUE *restrict b,
+                              ANMAT_VALUE *restrict c,
+                              unsigned int ldc,
+                              unsigned int mr,
+                              unsigned int nr,
+                              ANMAT_VALUE alpha,
+                              ANMAT_VALUE beta)
+{
+  VECTOR tile[KERNEL_MR][TILE_VECTORS], bRow[TILE_VECTORS];
+  ANMAT_VALUE values[KERNEL_NR];
+  unsigned int p, r, v, s;
+
+#pragma GCC unroll 16
+  for (r = 0; r < KERNEL_MR; r ++) {
+#pragma GCC unroll 16
+    for (v = 0; v < TILE_VECTORS; v ++) {
+      tile[r][v] = (VECTOR) { 0 };
+    }
+  }
+
+#pragma GCC unroll 4
+  for (p = 0; p < kc; p ++) {
+#pragma GCC unroll 16
+    for (v = 0; v < TILE_VECTORS; v ++) {
+      load(bRow[v], b + (v * VECTOR_VALUES));
+    }
+#pragma GCC unroll 16
+    for (r = 0; r < KERNEL_MR; r ++) {
+#pragma GCC unroll 16
+      for (v = 0; v < TILE_VECTORS; v ++) {
+        tile[r][v] += a[r] * bRow[v];
+      }
+    }
+    a += KERNEL_MR;
+    b += KERNEL_NR;
+  }
+
+  for (r = 0; r < mr; r ++) {
+    __builtin_memcpy(values, tile[r], sizeof(values));
+    for (s = 0; s < nr; s ++) {
+      c[s] = (beta == 0
+              ? alpha * values[s]
+              : (beta * c[s]) + (alpha * values[s]));
+    }
+    c += ldc;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Batched Multiply
+
+// A vector holds the same value of VECTOR_VALUES problems, so every problem
+// is multiplied the way one would be with scalars, a vector of them at a
+// time. The problems left over are done with scalars, the same way.
+#define BATCH_MULTIPLY(Type, zero)                                      \
+  do {                                                                  \
+    Type sum_, x_, y_;                                                  \
+    unsigned int i_, j_, l_;                                            \
+    _Pragma("GCC unroll 8")                                             \
+    for (i_ = 0; i_ < m; i_ ++) {                                       \
+      _Pragma("GCC unroll 8")                                           \
+      for (j_ = 0; j_ < n; j_ ++) {                                     \
+        sum_ = (zero);                                                  \
+        _Pragma("GCC unroll 8")                                         \
+        for (l_ = 0; l_ < k; l_ ++) {                                   \
+          __builtin_memcpy(&x_, a + ((size_t)((i_ * k) + l_) * ld) + p, \
+                           sizeof(Type));                               \
+          __builtin_memcpy(&y_, b + ((size_t)((l_ * n) + j_) * ld) + p, \
+                           sizeof(Type));                               \
+          sum_ += x_ * y_;                                              \
+        }                                                               \
+        __builtin_memcpy(c + ((size_t)((i_ * n) + j_) * ld) + p, &sum_, \
+                         sizeof(Type));                                 \
+      }                                                                 \
+    }                                                                   \
+  } while (0)
+
+// This is inlined into batchMultiply with constant sizes for the sizes that
+// are special cased, so that the loops above unroll all the way.
+KERNEL_TARGET
+__attribute__((always_inline))
+static inline void KERNEL(batchProblems)(unsigned int m,
+                                         unsigned int n,
+                                         unsigned int k,
+                                         const ANMAT_VALUE *restrict a,
+                                         const ANMAT_VALUE *restrict b,
+                                         ANMAT_VALUE *restrict c,
+                                         size_t ld,
+                                         unsigned int count)
+{
+  unsigned int p;
+
+  for (p = 0; p + VECTOR_VALUES <= count; p += VECTOR_VALUES) {
+    BATCH_MULTIPLY(VECTOR, (VECTOR) { 0 });
+  }
+  for (; p < count; p ++) {
+    BATCH_MULTIPLY(ANMAT_VALUE, 0);
+  }
+}
+
+KERNEL_TARGET
+static void KERNEL(batchMultiply)(unsigned int m,
+                                  unsigned int n,
+                                  unsigned int k,
+                                  const ANMAT_VALUE *a,
+                                  const ANMAT_VALUE *b,
+                                  ANMAT_VALUE *c,
+                                  size_t ld,
+                                  unsigned int count)
+{
+  if (m == n && n == k) {
+    switch (m) {
+    case 2:
+      KERNEL(batchProblems)(2, 2, 2, a, b, c, ld, count);
+      return;
+    case 3:
+      KERNEL(batchProblems)(3, 3, 3, a, b, c, ld, count);
+      return;
+    case 4:
+      KERNEL(batchProblems)(4, 4, 4, a, b, c, ld, count);
+      return;
+    case 8:
+      KERNEL(batchProblems)(8, 8, 8, a, b, c, ld, count);
+      return;
+    }
+  }
+
+  KERNEL(batchProblems)(m, n, k, a, b, c, ld, count);
+}
+
+// -----------------------------------------------------------------------------
+// Elementwise
+
+// Each of these is one pass: a vector at a time, then the values left over.
+#define ELEMENTWISE(vectorStatement, scalarStatement)             \
+  do {                                                            \
+    unsigned int i;                                               \
+    for (i = 0; i + VECTOR_VALUES <= count; i += VECTOR_VALUES) {   \
+      vectorStatement;                                            \
+    }                                                             \
+    for (; i < count; i ++) {                                     \
+      scalarStatement;                                            \
+    }                                                             \
+  } while (0)
+
+KERNEL_TARGET
+static void KERNEL(scale)(const ANMAT_VALUE *a,
+                          ANMAT_VALUE alpha,
+                          ANMAT_VALUE *c,
+                          unsigned int count)
+{
+  VECTOR vectorA;
+
+  ELEMENTWISE({
+      load(vectorA, a + i);
+      vectorA *= alpha;
+      store(c + i, vectorA);
+    }, {
+      c[i] = alpha * a[i];
+    });
+}
+
+KERNEL_TARGET
+static void KERNEL(axpby)(const ANMAT_VALUE *a,
+                          ANMAT_VALUE alpha,
+                          const ANMAT_VALUE *b,
+                          ANMAT_VALUE beta,
+                          ANMAT_VALUE *c,
+                          unsigned int count)
+{
+  VECTOR vectorA, vectorB;
+
+  ELEMENTWISE({
+      load(vectorA, a + i);
+      load(vectorB, b + i);
+      vectorA = (alpha * vectorA) + (beta * vectorB);
+      store(c + i, vectorA);
+    }, {
+      c[i] = (alpha * a[i]) + (beta * b[i]);
+    });
+}
+
+KERNEL_TARGET
+static void KERNEL(multiply)(const ANMAT_VALUE *a,
+                             const ANMAT_VALUE *b,
+                             ANMAT_VALUE *c,
+                             unsigned int count)
+{
+  VECTOR vectorA, vectorB;
+
+  ELEMENTWISE({
+      load(vectorA, a + i);
+      load(vectorB, b + i);
+      vectorA *= vectorB;
+      store(c + i, vectorA);
+    }, {
+      c[i] = a[i] * b[i];
+    });
+}
+
+KERNEL_TARGET
+static void KERNEL(divide)(const ANMAT_VALUE *a,
+                           const ANMAT_VALUE *b,
+                           ANMAT_VALUE *c,
+                           unsigned int count)
+{
+  VECTOR vectorA, vectorB;
+
+  ELEMENTWISE({
+      load(vectorA, a + i);
+      load(vectorB, b + i);
+      vectorA /= vectorB;
+      store(c + i, vectorA);
+    }, {
+      c[i] = a[i] / b[i];
+    });
+}
+
+// The vector extensions have no ?: in C, so the comparisons make masks that
+// pick the bits of either value.
+KERNEL_TARGET
+static void KERNEL(clamp)(const ANMAT_VALUE *a,
+                          ANMAT_VALUE low,
+                          ANMAT_VALUE high,
+                          ANMAT_VALUE *c,
+                          unsigned int count)
+{
+  typedef __typeof__((VECTOR) { 0 } < (VECTOR) { 0 }) Mask_t;
+  VECTOR vectorA, vectorLow = (VECTOR) { 0 } + low;
+  VECTOR vectorHigh = (VECTOR) { 0 } + high;
+  Mask_t mask;
+
+  ELEMENTWISE({
+      load(vectorA, a + i);
+      mask = (vectorA < vectorLow);
+      vectorA = (VECTOR)(((Mask_t)vectorLow & mask)
+                         | ((Mask_t)vectorA & ~mask));
+      mask = (vectorA > vectorHigh);
+      vectorA = (VECTOR)(((Mask_t)vectorHigh & mask)
+                         | ((Mask_t)vectorA & ~mask));
+      store(c + i, vectorA);
+    }, {
+      c[i] = (a[i] < low ? low : (a[i] > high ? high : a[i]));
+    });
+}
+
+// -----------------------------------------------------------------------------
+// Transpose
+
+// Transposing a square of VECTOR_VALUES vectors takes log2(VECTOR_VALUES)
+// steps. Step s swaps the values s apart between pairs of vectors s apart.
+
+#define SHUFFLE_PAIRS(rows, step, low, high)                            \
+  do {                                                                  \
+    VECTOR lows, highs;                                                 \
+    unsigned int pairI;                                                 \
+    for (pairI = 0; pairI < VECTOR_VALUES; pairI ++) {                  \
+      if (!(pairI & (step))) {                                          \
+        lows  = __builtin_shufflevector(rows[pairI], rows[pairI + (step)], \
+                                        low);                           \
+        highs = __builtin_shufflevector(rows[pairI], rows[pairI + (step)], \
+                                        high);                          \
+        rows[pairI]          = lows;                                    \
+        rows[pairI + (step)] = highs;                                   \
+      }                                                                 \
+    }                                                                   \
+  } while (0)
+
+#if KERNEL_LANES == 2
+  #define TRANSPOSE_SQUARE(rows)                  \
+    SHUFFLE_PAIRS(rows, 1, LOW_2_1, HIGH_2_1)
+  #define LOW_2_1  0, 2
+  #define HIGH_2_1 1, 3
+#elif KERNEL_LANES == 4
+  #define TRANSPOSE_SQUARE(rows)                  \
+    do {                                          \
+      SHUFFLE_PAIRS(rows, 1, LOW_4_1, HIGH_4_1);  \
+      SHUFFLE_PAIRS(rows, 2, LOW_4_2, HIGH_4_2);  \
+    } while (0)
+  #define LOW_4_1  0, 4, 2, 6
+  #define HIGH_4_1 1, 5, 3, 7
+  #define LOW_4_2  0, 1, 4, 5
+  #define HIGH_4_2 2, 3, 6, 7
+#elif KERNEL_LANES == 8
+  #define TRANSPOSE_SQUARE(rows)                  \
+    do {                                          \
+      SHUFFLE_PAIRS(rows, 1, LOW_8_1, HIGH_8_1);  \
+      SHUFFLE_PAIRS(rows, 2, LOW_8_2, HIGH_8_2);  \
+      SHUFFLE_PAIRS(rows, 4, LOW_8_4, HIGH_8_4);  \
+    } while (0)
+  #define LOW_8_1  0, 8, 2, 10, 4, 12, 6, 14
+  #define HIGH_8_1 1, 9, 3, 11, 5, 13, 7, 15
+  #define LOW_8_2  0, 1, 8, 9, 4, 5, 12, 13
+  #define HIGH_8_2 2, 3, 10, 11, 6, 7, 14, 15
+  #define LOW_8_4  0, 1, 2, 3, 8, 9, 10, 11
+  #define HIGH_8_4 4, 5, 6, 7, 12, 13, 14, 15
+#elif KERNEL_LANES == 16
+  #define TRANSPOSE_SQUARE(rows)                    \
+    do {                                            \
+      SHUFFLE_PAIRS(rows, 1, LOW_16_1, HIGH_16_1);  \
+      SHUFFLE_PAIRS(rows, 2, LOW_16_2, HIGH_16_2);  \
+      SHUFFLE_PAIRS(rows, 4, LOW_16_4, HIGH_16_4);  \
+      SHUFFLE_PAIRS(rows, 8, LOW_16_8, HIGH_16_8);  \
+    } while (0)
+  #define LOW_16_1  0, 16, 2, 18, 4, 20, 6, 22, \
+                      8, 24, 10, 26, 12, 28, 14, 30
+  #define HIGH_16_1 1, 17, 3, 19, 5, 21, 7, 23, \
+                      9, 25, 11, 27, 13, 29, 15, 31
+  #define LOW_16_2  0, 1, 16, 17, 4, 5, 20, 21, \
+                      8, 9, 24, 25, 12, 13, 28, 29
+  #define HIGH_16_2 2, 3, 18, 19, 6, 7, 22, 23, \
+                      10, 11, 26, 27, 14, 15, 30, 31
+  #define LOW_16_4  0, 1, 2, 3, 16, 17, 18, 19, \
+                      8, 9, 10, 11, 24, 25, 26, 27
+  #define HIGH_16_4 4, 5, 6, 7, 20, 21, 22, 23, \
+                      12, 13, 14, 15, 28, 29, 30, 31
+  #define LOW_16_8  0, 1, 2, 3, 4, 5, 6, 7, \
+                      16, 17, 18, 19, 20, 21, 22, 23
+  #define HIGH_16_8 8, 9, 10, 11, 12, 13, 14, 15, \
+                      24, 25, 26, 27, 28, 29, 30, 31
+#else
+  #error "KERNEL_LANES must be 2, 4, 8 or 16"
+#endif
+
+KERNEL_TARGET
+static void KERNEL(transpose)(const ANMAT_VALUE *a,
+                              unsigned int lda,
+                              ANMAT_VALUE *b,
+                              unsigned int ldb,
+                              unsigned int rows,
+                              unsigned int cols)
+{
+  VECTOR square[VECTOR_VALUES];
+  unsigned int rowI, colI, r;
+
+  // Whole squares.
+  for (rowI = 0; rowI + VECTOR_VALUES <= rows; rowI += VECTOR_VALUES) {
+    for (colI = 0; colI + VECTOR_VALUES <= cols; colI += VECTOR_VALUES) {
+#pragma GCC unroll 16
+      for (r = 0; r < VECTOR_VALUES; r ++) {
+        load(square[r], a + ((size_t)(rowI + r) * lda) + colI);
+      }
+      TRANSPOSE_SQUARE(square);
+#pragma GCC unroll 16
+      for (r = 0; r < VECTOR_VALUES; r ++) {
+        store(b + ((size_t)(colI + r) * ldb) + rowI, square[r]);
+      }
+    }
+    for (; colI < cols; colI ++) {
+      for (r = 0; r < VECTOR_VALUES; r ++) {
+        b[((size_t)colI * ldb) + rowI + r] = a[((size_t)(rowI + r) * lda)
+                                               + colI];
+      }
+    }
+  }
+
+  // The rows left over.
+  for (; rowI < rows; rowI ++) {
+    for (colI = 0; colI < cols; colI ++) {
+      b[((size_t)colI * ldb) + rowI] = a[((size_t)rowI * lda) + colI];
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Reductions
+
+// Four vectors of partial sums, so that the additions do not wait on each
+// other.
+#define REDUCE_VECTORS (4)
+
+#define horizontalSum(sums, total)                              \
+  do {                                                          \
+    ANMAT_VALUE values_[VECTOR_VALUES];                             \
+    unsigned int valueI_;                                       \
+    sums[0] += sums[1] + sums[2] + sums[3];                     \
+    __builtin_memcpy(values_, &sums[0], sizeof(values_));       \
+    for (valueI_ = 0; valueI_ < VECTOR_VALUES; valueI_ ++) {    \
+      total += values_[valueI_];                                \
+    }                                                           \
+  } while (0)
+
+KERNEL_TARGET
+static ANMAT_VALUE KERNEL(dot)(const ANMAT_VALUE *u,
+                               const ANMAT_VALUE *v,
+                               unsigned int count)
+{
+  VECTOR sums[REDUCE_VECTORS], vectorU, vectorV;
+  ANMAT_VALUE total = 0;
+  unsigned int i, s;
+
+  for (s = 0; s < REDUCE_VECTORS; s ++) {
+    sums[s] = (VECTOR) { 0 };
+  }
+
+  for (i = 0; i + (REDUCE_VECTORS * VECTOR_VALUES) <= count;
+       i += REDUCE_VECTORS * VECTOR_VALUES) {
+#pragma GCC unroll 4
+    for (s = 0; s < REDUCE_VECTORS; s ++) {
+      load(vectorU, u + i + (s * VECTOR_VALUES));
+      load(vectorV, v + i + (s * VECTOR_VALUES));
+      sums[s] += vectorU * vectorV;
+    }
+  }
+
+  horizontalSum(sums, total);
+  for (; i < count; i ++) {
+    total += u[i] * v[i];
+  }
+
+  return total;
+}
+
+KERNEL_TARGET
+static ANMAT_VALUE KERNEL(sum)(const ANMAT_VALUE *v, unsigned int count)
+{
+  VECTOR sums[REDUCE_VECTORS], vectorV;
+  ANMAT_VALUE total = 0;
+  unsigned int i, s;
+
+  for (s = 0; s < REDUCE_VECTORS; s ++) {
+    sums[s] = (VECTOR) { 0 };
+  }
+
+  for (i = 0; i + (REDUCE_VECTORS * VECTOR_VALUES) <= count;
+       i += REDUCE_VECTORS * VECTOR_VALUES) {
+#pragma GCC unroll 4
+    for (s = 0; s < REDUCE_VECTORS; s ++) {
+      load(vectorV, v + i + (s * VECTOR_VALUES));
+      sums[s] += vectorV;
+    }
+  }
+
+  horizontalSum(sums, total);
+  for (; i < count; i ++) {
+    total += v[i];
+  }
+
+  return total;
+}
+
+// -----------------------------------------------------------------------------
+// Table
+
+static const ANMAT_TYPE(Kernels) KERNEL(kernels) = {
+  KERNEL_MR,
+  KERNEL_NR,
+  KERNEL(gemmMicro),
+  KERNEL(batchMultiply),
+  KERNEL(scale),
+  KERNEL(axpby),
+  KERNEL(multiply),
+  KERNEL(divide),
+  KERNEL(clamp),
+  KERNEL(transpose),
+  KERNEL(dot),
+  KERNEL(sum),
+};
+
+#undef VECTOR
+#undef VECTOR_VALUES
+#undef TILE_VECTORS
+#undef load
+#undef store
+#undef BATCH_MULTIPLY
+#undef ELEMENTWISE
+#undef SHUFFLE_PAIRS
+#undef TRANSPOSE_SQUARE
+#undef LOW_2_1
+#undef HIGH_2_1
+#undef LOW_4_1
+#undef HIGH_4_1
+#undef LOW_4_2
+#undef HIGH_4_2
+#undef LOW_8_1
+#undef HIGH_8_1
+#undef LOW_8_2
+#undef HIGH_8_2
+#undef LOW_8_4
+#undef HIGH_8_4
+#undef LOW_16_1
+#undef HIGH_16_1
+#undef LOW_16_2
+#undef HIGH_16_2
+#undef LOW_16_4
+#undef HIGH_16_4
+#undef LOW_16_8
+#undef HIGH_16_8
+#undef REDUCE_VECTORS
+#undef horizontalSum
@@ -0,0 +1,39 @@
+//
+// kernels.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// SIMD kernels for the anmat library.
+//
+
+#ifndef __KERNELS_H__
+#define __KERNELS_H__
+
+#include "anmat.h"
+
+// The biggest tile that any level's multiply micro kernel computes for
+// doubles.
+#define KERNEL_MAX_MR (8)
+#define KERNEL_MAX_NR (16)
+
+// Kernels_t is the table of kernels for doubles, and KernelsF_t is the one
+// for floats.
+#define ANMAT_VALUE      double
+#define ANMAT_TYPE(name) name ## _t
+#include "src/kernels-table.h"
+#undef ANMAT_VALUE
+#undef ANMAT_TYPE
+
+#define ANMAT_VALUE      float
+#define ANMAT_TYPE(name) name ## F_t
+#include "src/kernels-table.h"
+#undef ANMAT_VALUE
+#undef ANMAT_TYPE
+
+// The kernels for the SIMD level in use (see simd.h).
+extern const Kernels_t *anmatKernels;
+extern const KernelsF_t *anmatKernelsF;
+
+#endif /* __KERNELS_H__ */
@@ -0,0 +1,283 @@
+//
+// lu.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// LU API.
+//
+
+#include <math.h>   // fabs()
+#include <string.h> // memcpy(), memset()
+
+#include "lu.h"
+#include "src/gemm.h"
+#include "src/kernels.h"
+#include "src/trsm.h"
+
+//#define LU_DEBUG
+#ifdef LU_DEBUG
+  #define note(...) printf(__VA_ARGS__), fflush(0);
+#else
+  #define note(...)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+
+// The factorization is right-looking, and blocked: the matrix is walked down
+// its diagonal in panels of BLOCK columns. Each panel is factored one column
+// at a time, swapping the biggest value in the column onto the diagonal
+// (swapping whole rows, so L ends up with the same swaps). Then, with L11 the
+// block of the panel on the diagonal and L21 the block below it, the rows of
+// the panel to its right become U12 = L11^-1 * A12 (see trsm.h), and the rest
+// of the matrix to the bottom right becomes A22 - (L21 * U12), in one gemm.
+// That gemm is most of the work.
+
+#define BLOCK (64)
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+
+#define rowOf(b, ldb, rowI) ((b) + ((size_t)(rowI) * (ldb)))
+
+static void swapRows(double *rowA, double *rowB, unsigned int count)
+{
+  unsigned int i;
+  double value;
+
+  for (i = 0; i < count; i ++) {
+    value = rowA[i];
+    rowA[i] = rowB[i];
+    rowB[i] = value;
+  }
+}
+
+// Factor the columns start through end - 1 of the factors, which are still
+// A below and to the right of (start, start).
+static void factorPanel(AnmatLu_t *lu, unsigned int start, unsigned int end)
+{
+  AnmatMatrix_t *factors = &lu->factors;
+  unsigned int n = factors->rows, i, j, pivotI;
+  double biggest, pivot, *rowI, *rowJ;
+
+  for (j = start; j < end; j ++) {
+    pivotI = j;
+    biggest = fabs(anmatMatrixData(factors, j, j));
+    for (i = j + 1; i < n; i ++) {
+      if (fabs(anmatMatrixData(factors, i, j)) > biggest) {
+        biggest = fabs(anmatMatrixData(factors, i, j));
+        pivotI = i;
+      }
+    }
+
+    lu->pivots[j] = pivotI;
+    rowJ = anmatMatrixRow(factors, j);
+    if (pivotI != j) {
+      swapRows(rowJ, anmatMatrixRow(factors, pivotI), n);
+      lu->sign = -lu->sign;
+    }
+
+    // A column of 0's is already eliminated.
+    pivot = rowJ[j];
+    if (pivot == 0) {
+      lu->singular = true;
+      continue;
+    }
+
+    for (i = j + 1; i < n; i ++) {
+      rowI = anmatMatrixRow(factors, i);
+      rowI[j] /= pivot;
+      if (j + 1 < end) {
+        anmatKernels->axpby(rowJ + j + 1, -rowI[j], rowI + j + 1, 1,
+                            rowI + j + 1, end - j - 1);
+      }
+    }
+  }
+}
+
+// Solve A * X = B in place, for the n x nrhs B at x.
+static AnmatStatus_t solve(AnmatLu_t *lu,
+                           unsigned int nrhs,
+                           double *x,
+                           unsigned int ldx)
+{
+  AnmatMatrix_t *factors = &lu->factors;
+  unsigned int n = factors->rows, i;
+  AnmatStatus_t status;
+
+  for (i = 0; i < n; i ++) {
+    if (lu->pivots[i] != i) {
+      swapRows(rowOf(x, ldx, i), rowOf(x, ldx, lu->pivots[i]), nrhs);
+    }
+  }
+
+  status = anmatTrsm(true, true, n, nrhs, factors->data, factors->stride,
+                     x, ldx);
+  if (status == ANMAT_SUCCESS) {
+    status = anmatTrsm(false, false, n, nrhs, factors->data, factors->stride,
+                       x, ldx);
+  }
+
+  return status;
+}
+
+// -----------------------------------------------------------------------------
+// Factorization
+
+AnmatStatus_t anmatLuFactor(AnmatLu_t *lu, AnmatMatrix_t *matrix)
+{
+  AnmatMatrix_t *factors = &lu->factors;
+  unsigned int n = matrix->rows, rowI, start, end;
+  AnmatStatus_t status;
+
+  if (matrix->rows != matrix->cols) {
+    return ANMAT_BAD_ARG;
+  }
+
+  status = anmatMatrixAlloc(factors, n, n);
+  if (status != ANMAT_SUCCESS) {
+    return status;
+  }
+  lu->pivots = (unsigned int *)anmatAllocAligned(factors->allocator,
+                                                 n * sizeof(unsigned int),
+                                                 ANMAT_DATA_ALIGNMENT);
+  if (!lu->pivots) {
+    anmatMatrixFree(factors);
+    return ANMAT_MEM_ERR;
+  }
+  lu->sign = 1;
+  lu->singular = false;
+
+  for (rowI = 0; rowI < n; rowI ++) {
+    memcpy(anmatMatrixRow(factors, rowI), anmatMatrixRow(matrix, rowI),
+           n * sizeof(double));
+  }
+
+  for (start = 0; start < n && status == ANMAT_SUCCESS; start = end) {
+    end = min(n, start + BLOCK);
+    factorPanel(lu, start, end);
+    if (end < n) {
+      status = anmatTrsm(true, true, end - start, n - end,
+                         anmatMatrixRow(factors, start) + start,
+                         factors->stride,
+                         anmatMatrixRow(factors, start) + end,
+                         factors->stride);
+    }
+    if (end < n && status == ANMAT_SUCCESS) {
+      status = anmatGemm(n - end, n - end, end - start,
+                         -1, anmatMatrixRow(factors, end) + start,
+                         factors->stride,
+                         anmatMatrixRow(factors, start) + end,
+                         factors->stride,
+                         1, anmatMatrixRow(factors, end) + end,
+                         factors->stride);
+    }
+  }
+
+  note("anmatLuFactor: %u x %u, sign %d, singular %d\n",
+       n, n, lu->sign, lu->singular);
+
+  if (status != ANMAT_SUCCESS) {
+    anmatLuFree(lu);
+  }
+
+  return status;
+}
+
+void anmatLuFree(AnmatLu_t *lu)
+{
+  anmatFree(lu->factors.allocator, lu->pivots);
+  anmatMatrixFree(&lu->factors);
+}
+
+// -----------------------------------------------------------------------------
+// Operations
+
+AnmatStatus_t anmatLuSolve(AnmatLu_t *lu,
+                           AnmatMatrix_t *matrixB,
+                           AnmatMatrix_t *matrixX)
+{
+  unsigned int rowI;
+
+  if (lu->singular
+      || matrixB->rows != lu->factors.rows
+      || matrixX->rows != matrixB->rows
+      || matrixX->cols != matrixB->cols) {
+    return ANMAT_BAD_ARG;
+  }
+
+  if (matrixX->data != matrixB->data) {
+    for (rowI = 0; rowI < matrixB->rows; rowI ++) {
+      memcpy(anmatMatrixRow(matrixX, rowI), anmatMatrixRow(matrixB, rowI),
+             matrixB->cols * sizeof(double));
+    }
+  }
+
+  return solve(lu, matrixX->cols, matrixX->data, matrixX->stride);
+}
+
+AnmatStatus_t anmatLuSolveVector(AnmatLu_t *lu,
+                                 AnmatVector_t *vectorB,
+                                 AnmatVector_t *vectorX)
+{
+  if (lu->singular
+      || vectorB->count != lu->factors.rows
+      || vectorX->count != vectorB->count) {
+    return ANMAT_BAD_ARG;
+  }
+
+  if (vectorX->data != vectorB->data) {
+    memcpy(vectorX->data, vectorB->data, vectorB->count * sizeof(double));
+  }
+
+  return solve(lu, 1, vectorX->data, 1);
+}
+
+double anmatLuDeterminant(AnmatLu_t *lu)
+{
+  double determinant = lu->sign;
+  unsigned int i;
+
+  for (i = 0; i < lu->factors.rows; i ++) {
+    determinant *= anmatMatrixData(&lu->factors, i, i);
+  }
+
+  return determinant;
+}
+
+AnmatStatus_t anmatLuInverse(AnmatLu_t *lu, AnmatMatrix_t *inverse)
+{
+  unsigned int n = lu->factors.rows, rowI;
+
+  if (lu->singular || inverse->rows != n || inverse->cols != n) {
+    return ANMAT_BAD_ARG;
+  }
+
+  for (rowI = 0; rowI < n; rowI ++) {
+    memset(anmatMatrixRow(inverse, rowI), 0, n * sizeof(double));
+    anmatMatrixData(inverse, rowI, rowI) = 1;
+  }
+
+  return solve(lu, n, inverse->data, inverse->stride);
+}
+
+// -----------------------------------------------------------------------------
+// Triangular Solves
+
+AnmatStatus_t anmatMatrixSolveTriangular(AnmatTriangle_t triangle,
+                                         bool unit,
+                                         AnmatMatrix_t *matrixT,
+                                         AnmatMatrix_t *matrixB)
+{
+  if ((triangle != ANMAT_LOWER && triangle != ANMAT_UPPER)
+      || matrixT->rows != matrixT->cols
+      || matrixB->rows != matrixT->rows) {
+    return ANMAT_BAD_ARG;
+  }
+
+  return anmatTrsm(triangle == ANMAT_LOWER, unit,
+                   matrixT->rows, matrixB->cols,
+                   matrixT->data, matrixT->stride,
+                   matrixB->data, matrixB->stride);
+}
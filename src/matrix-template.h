@@ -0,0 +1,563 @@
+//
+// matrix-template.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// The matrix API for one precision.
+//
+// This is included by matrix.c once per precision, with the same macros as
+// inc/matrix-template.h.
+//
+
+// -----------------------------------------------------------------------------
+// Memory Management
+
+AnmatStatus_t ANMAT_NAME(anmatMatrixAlloc)(ANMAT_TYPE(AnmatMatrix) *matrix,
+                                           unsigned int rows,
+                                           unsigned int cols)
+{
+  return ANMAT_NAME(anmatMatrixAllocWith)(matrix, rows, cols, NULL);
+}
+
+AnmatStatus_t
+ANMAT_NAME(anmatMatrixAllocWith)(ANMAT_TYPE(AnmatMatrix) *matrix,
+                                 unsigned int rows,
+                                 unsigned int cols,
+                                 const AnmatAllocator_t *allocator)
+{
+  AnmatStatus_t status = ANMAT_BAD_ARG;
+  size_t valueI, valueCount;
+
+  if (rows && cols) {
+    status = ANMAT_SUCCESS;
+
+    matrix->rows = rows;
+    matrix->cols = cols;
+    matrix->stride = strideFor(cols);
+    matrix->allocator = (allocator ? allocator : anmatAllocatorGet());
+    matrix->data
+      = (ANMAT_VALUE *)anmatAllocAligned(matrix->allocator,
+                                         matrixBytes(rows, matrix->stride),
+                                         ANMAT_DATA_ALIGNMENT);
+    if (!matrix->data) {
+      status = ANMAT_MEM_ERR;
+    } else {
+      valueCount = (size_t)rows * matrix->stride;
+      for (valueI = 0; valueI < valueCount; valueI ++) {
+        matrix->data[valueI] = 0;
+      }
+    }
+  }
+
+  return status;
+}
+
+void ANMAT_NAME(anmatMatrixFree)(ANMAT_TYPE(AnmatMatrix) *matrix)
+{
+  if (matrix->data && matrix->allocator) {
+    anmatFree(matrix->allocator, matrix->data);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Views
+
+AnmatStatus_t ANMAT_NAME(anmatMatrixView)(ANMAT_TYPE(AnmatMatrix) *view,
+                                          ANMAT_TYPE(AnmatMatrix) *matrix,
+                                          unsigned int rowI,
+                                          unsigned int colI,
+                                          unsigned int rows,
+                                          unsigned int cols)
+{
+  if (!rows || !cols
+      || rowI >= matrix->rows || rows > matrix->rows - rowI
+      || colI >= matrix->cols || cols > matrix->cols - colI) {
+    return ANMAT_BAD_ARG;
+  }
+
+  view->rows = rows;
+  view->cols = cols;
+  view->stride = matrix->stride;
+  view->data = &anmatMatrixData(matrix, rowI, colI);
+  view->allocator = NULL;
+
+  return ANMAT_SUCCESS;
+}
+
+// -----------------------------------------------------------------------------
+// Elementary operations
+
+bool ANMAT_NAME(anmatMatrixEquals)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                   ANMAT_TYPE(AnmatMatrix) *matrixB)
+{
+  unsigned int rowI, colI;
+  ANMAT_VALUE *rowA, *rowB;
+
+  if (!dimensionsAreEqual(matrixA, matrixB)) {
+    note("anmatMatrixEquals: dimensions are not equal.\n");
+    return false;
+  }
+
+  FOR_ROW(matrixA, rowI) {
+    rowA = anmatMatrixRow(matrixA, rowI);
+    rowB = anmatMatrixRow(matrixB, rowI);
+    FOR_COL(matrixA, colI) {
+      if (!anmatUtilNeighborhood(rowA[colI], rowB[colI], 1e-6)) {
+        note("anmatMatrixEquals: values are not equal: ");
+        note("(matrixA[%d][%d] = %lf) != (matrixB[%d][%d] = %lf)\n",
+             rowI, colI, rowA[colI], rowI, colI, rowB[colI]);
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+// The element-wise operations. Each is one pass over its rows, split up by
+// row blocks across the thread pool (see kernels.h).
+typedef struct {
+  ElementOp_t op;
+  ANMAT_TYPE(AnmatMatrix) *matrixA, *matrixB, *matrixC;
+  ANMAT_VALUE alpha, beta;
+  unsigned int taskCount;
+} ANMAT_TYPE(ElementJob);
+
+static void ANMAT_NAME(elementTask)(void *context, unsigned int taskI)
+{
+  ANMAT_TYPE(ElementJob) *job = (ANMAT_TYPE(ElementJob) *)context;
+  unsigned int rowI, start, end, cols = job->matrixC->cols;
+  ANMAT_VALUE *rowA, *rowB = NULL, *rowC;
+
+  anmatPoolSplit(job->matrixC->rows, 1, taskI, job->taskCount, &start, &end);
+  for (rowI = start; rowI < end; rowI ++) {
+    rowA = anmatMatrixRow(job->matrixA, rowI);
+    if (job->matrixB) {
+      rowB = anmatMatrixRow(job->matrixB, rowI);
+    }
+    rowC = anmatMatrixRow(job->matrixC, rowI);
+
+    switch (job->op) {
+    case ELEMENT_SCALE:
+      ANMAT_NAME(anmatKernels)->scale(rowA, job->alpha, rowC, cols);
+      break;
+    case ELEMENT_AXPBY:
+      ANMAT_NAME(anmatKernels)->axpby(rowA, job->alpha, rowB, job->beta, rowC,
+                                      cols);
+      break;
+    case ELEMENT_MULTIPLY:
+      ANMAT_NAME(anmatKernels)->multiply(rowA, rowB, rowC, cols);
+      break;
+    case ELEMENT_DIVIDE:
+      ANMAT_NAME(anmatKernels)->divide(rowA, rowB, rowC, cols);
+      break;
+    case ELEMENT_CLAMP:
+      ANMAT_NAME(anmatKernels)->clamp(rowA, job->alpha, job->beta, rowC, cols);
+      break;
+    }
+  }
+}
+
+// Run an element-wise operation on matrixA (and matrixB, if it is not NULL)
+// into matrixC.
+static AnmatStatus_t ANMAT_NAME(runElementOp)(ElementOp_t op,
+                                              ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                              ANMAT_VALUE alpha,
+                                              ANMAT_TYPE(AnmatMatrix) *matrixB,
+                                              ANMAT_VALUE beta,
+                                              ANMAT_TYPE(AnmatMatrix) *matrixC)
+{
+  ANMAT_TYPE(ElementJob) job
+    = { op, matrixA, matrixB, matrixC, alpha, beta, };
+
+  if (!dimensionsAreEqual(matrixA, matrixC)
+      || (matrixB && !dimensionsAreEqual(matrixB, matrixC))) {
+    return ANMAT_BAD_ARG;
+  }
+
+  job.taskCount = anmatPoolTaskCount((size_t)matrixC->rows * matrixC->cols);
+  anmatPoolRun(ANMAT_NAME(elementTask), &job, job.taskCount);
+
+  return ANMAT_SUCCESS;
+}
+
+AnmatStatus_t ANMAT_NAME(anmatMatrixAdd)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                         ANMAT_TYPE(AnmatMatrix) *matrixB,
+                                         ANMAT_TYPE(AnmatMatrix) *matrixC)
+{
+  return ANMAT_NAME(runElementOp)(ELEMENT_AXPBY, matrixA, 1,
+                                  matrixB, 1, matrixC);
+}
+
+AnmatStatus_t ANMAT_NAME(anmatMatrixSubtract)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                              ANMAT_TYPE(AnmatMatrix) *matrixB,
+                                              ANMAT_TYPE(AnmatMatrix) *matrixC)
+{
+  return ANMAT_NAME(runElementOp)(ELEMENT_AXPBY, matrixA, 1,
+                                  matrixB, -1, matrixC);
+}
+
+AnmatStatus_t ANMAT_NAME(anmatMatrixScale)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                           ANMAT_VALUE alpha,
+                                           ANMAT_TYPE(AnmatMatrix) *matrixC)
+{
+  return ANMAT_NAME(runElementOp)(ELEMENT_SCALE, matrixA, alpha,
+                                  NULL, 0, matrixC);
+}
+
+AnmatStatus_t ANMAT_NAME(anmatMatrixAxpy)(ANMAT_VALUE alpha,
+                                          ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                          ANMAT_TYPE(AnmatMatrix) *matrixB,
+                                          ANMAT_TYPE(AnmatMatrix) *matrixC)
+{
+  return ANMAT_NAME(runElementOp)(ELEMENT_AXPBY, matrixA, alpha,
+                                  matrixB, 1, matrixC);
+}
+
+AnmatStatus_t ANMAT_NAME(anmatMatrixAxpby)(ANMAT_VALUE alpha,
+                                           ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                           ANMAT_VALUE beta,
+                                           ANMAT_TYPE(AnmatMatrix) *matrixB,
+                                           ANMAT_TYPE(AnmatMatrix) *matrixC)
+{
+  return ANMAT_NAME(runElementOp)(ELEMENT_AXPBY, matrixA, alpha,
+                                  matrixB, beta, matrixC);
+}
+
+AnmatStatus_t
+ANMAT_NAME(anmatMatrixHadamardMultiply)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                        ANMAT_TYPE(AnmatMatrix) *matrixB,
+                                        ANMAT_TYPE(AnmatMatrix) *matrixC)
+{
+  return ANMAT_NAME(runElementOp)(ELEMENT_MULTIPLY, matrixA, 0,
+                                  matrixB, 0, matrixC);
+}
+
+AnmatStatus_t
+ANMAT_NAME(anmatMatrixHadamardDivide)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                      ANMAT_TYPE(AnmatMatrix) *matrixB,
+                                      ANMAT_TYPE(AnmatMatrix) *matrixC)
+{
+  return ANMAT_NAME(runElementOp)(ELEMENT_DIVIDE, matrixA, 0,
+                                  matrixB, 0, matrixC);
+}
+
+AnmatStatus_t ANMAT_NAME(anmatMatrixClamp)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                           ANMAT_VALUE low,
+                                           ANMAT_VALUE high,
+                                           ANMAT_TYPE(AnmatMatrix) *matrixC)
+{
+  if (!(low <= high)) {
+    return ANMAT_BAD_ARG;
+  }
+
+  return ANMAT_NAME(runElementOp)(ELEMENT_CLAMP, matrixA, low,
+                                  NULL, high, matrixC);
+}
+
+AnmatStatus_t ANMAT_NAME(anmatMatrixMultiply)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                              ANMAT_TYPE(AnmatMatrix) *matrixB,
+                                              ANMAT_TYPE(AnmatMatrix) *matrixC)
+{
+  AnmatStatus_t status = ANMAT_BAD_ARG;
+
+  if (matrixA->cols == matrixB->rows
+      && matrixC->rows == matrixA->rows
+      && matrixC->cols == matrixB->cols) {
+    if (strassenConfig.enabled) {
+      status = ANMAT_NAME(anmatStrassen)(strassenConfig.crossover,
+                                         matrixA->rows, matrixB->cols,
+                                         matrixA->cols,
+                                         matrixA->data, matrixA->stride,
+                                         matrixB->data, matrixB->stride,
+                                         matrixC->data, matrixC->stride);
+    } else {
+      status = ANMAT_NAME(anmatGemm)(matrixA->rows, matrixB->cols,
+                                     matrixA->cols,
+                                     1, matrixA->data, matrixA->stride,
+                                     matrixB->data, matrixB->stride,
+                                     0, matrixC->data, matrixC->stride);
+    }
+  }
+
+  return status;
+}
+
+// -----------------------------------------------------------------------------
+// Strassen
+
+static double ANMAT_NAME(biggestMagnitude)(ANMAT_TYPE(AnmatMatrix) *matrix)
+{
+  unsigned int rowI, colI;
+  ANMAT_VALUE *row;
+  double magnitude, biggest = 0;
+
+  FOR_ROW(matrix, rowI) {
+    row = anmatMatrixRow(matrix, rowI);
+    FOR_COL(matrix, colI) {
+      magnitude = (row[colI] < 0 ? -row[colI] : row[colI]);
+      if (magnitude > biggest) {
+        biggest = magnitude;
+      }
+    }
+  }
+
+  return biggest;
+}
+
+double
+ANMAT_NAME(anmatMatrixMultiplyErrorBound)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                          ANMAT_TYPE(AnmatMatrix) *matrixB)
+{
+  double k = matrixA->cols, leafK, factor;
+  unsigned int levels, leafCols, levelI;
+
+  if (matrixA->cols != matrixB->rows) {
+    return -1;
+  }
+
+  // The usual algorithm: each value is a sum of k products, each of which
+  // can be as big as |A| |B|, and each is off by up to k roundoffs.
+  factor = k * k;
+
+  // Strassen-Winograd: ((k / k0)^log2(18) (k0^2 + 6 k0) - 6 k), for leaves
+  // with an inner dimension of k0.
+  if (strassenConfig.enabled) {
+    levels = anmatStrassenLevels(strassenConfig.crossover,
+                                 matrixA->rows, matrixB->cols, matrixA->cols,
+                                 &leafCols);
+    if (levels) {
+      leafK = leafCols;
+      factor = (leafK * leafK) + (6 * leafK);
+      for (levelI = 0; levelI < levels; levelI ++) {
+        factor *= 18;
+      }
+      factor -= 6 * k;
+    }
+  }
+
+  return (factor * (EPSILON / 2)
+          * ANMAT_NAME(biggestMagnitude)(matrixA)
+          * ANMAT_NAME(biggestMagnitude)(matrixB));
+}
+
+// -----------------------------------------------------------------------------
+// Matrix Operations
+
+// Transpose a block of rows of A (columns of B), for one task. The blocks
+// start on multiples of 16 rows so that the kernel can do whole squares.
+// See transpose.c for how each block is transposed.
+typedef struct {
+  ANMAT_TYPE(AnmatMatrix) *matrixA, *matrixB;
+  unsigned int taskCount;
+} ANMAT_TYPE(TransposeJob);
+
+static void ANMAT_NAME(transposeTask)(void *context, unsigned int taskI)
+{
+  ANMAT_TYPE(TransposeJob) *job = (ANMAT_TYPE(TransposeJob) *)context;
+  unsigned int start, end;
+
+  anmatPoolSplit(job->matrixA->rows, 16, taskI, job->taskCount, &start, &end);
+  if (start < end) {
+    ANMAT_NAME(anmatTranspose)(anmatMatrixRow(job->matrixA, start),
+                               job->matrixA->stride,
+                               job->matrixB->data + start,
+                               job->matrixB->stride,
+                               end - start,
+                               job->matrixA->cols);
+  }
+}
+
+AnmatStatus_t
+ANMAT_NAME(anmatMatrixTranspose)(ANMAT_TYPE(AnmatMatrix) *matrixA,
+                                 ANMAT_TYPE(AnmatMatrix) *matrixB)
+{
+  AnmatStatus_t status = ANMAT_BAD_ARG;
+  ANMAT_TYPE(TransposeJob) job = { matrixA, matrixB, };
+
+  if (matrixA->rows == matrixB->cols && matrixA->cols == matrixB->rows) {
+    status = ANMAT_SUCCESS;
+    job.taskCount = anmatPoolTaskCount((size_t)matrixA->rows * matrixA->cols);
+    anmatPoolRun(ANMAT_NAME(transposeTask), &job, job.taskCount);
+  }
+
+  return status;
+}
+
+AnmatStatus_t
+ANMAT_NAME(anmatMatrixTransposeInPlace)(ANMAT_TYPE(AnmatMatrix) *matrix)
+{
+  AnmatStatus_t status;
+  unsigned int rows = matrix->rows, cols = matrix->cols, rowI;
+  size_t capacity, stride;
+
+  if (rows == cols) {
+    ANMAT_NAME(anmatTransposeSquare)(matrix->data, matrix->stride, rows);
+    return ANMAT_SUCCESS;
+  }
+
+  // A view cannot change shape inside of the matrix that it looks into.
+  if (!matrix->allocator) {
+    return ANMAT_BAD_ARG;
+  }
+
+  // Squeeze out the padding, transpose, and then spread the rows back out.
+  // The transpose only gets padded rows if they fit in the same memory.
+  capacity = (size_t)rows * matrix->stride;
+  stride = strideFor(rows);
+  if (stride * cols > capacity) {
+    stride = rows;
+  }
+
+  for (rowI = 1; rowI < rows; rowI ++) {
+    memmove(matrix->data + ((size_t)rowI * cols),
+            anmatMatrixRow(matrix, rowI),
+            cols * sizeof(ANMAT_VALUE));
+  }
+
+  status = ANMAT_NAME(anmatTransposeDense)(matrix->data, rows, cols);
+  if (status != ANMAT_SUCCESS) {
+    // Put the padding back.
+    for (rowI = rows - 1; rowI > 0; rowI --) {
+      memmove(anmatMatrixRow(matrix, rowI),
+              matrix->data + ((size_t)rowI * cols),
+              cols * sizeof(ANMAT_VALUE));
+    }
+    return status;
+  }
+
+  matrix->rows = cols;
+  matrix->cols = rows;
+  matrix->stride = stride;
+  for (rowI = matrix->rows - 1; rowI > 0; rowI --) {
+    memmove(anmatMatrixRow(matrix, rowI),
+            matrix->data + ((size_t)rowI * rows),
+            rows * sizeof(ANMAT_VALUE));
+  }
+  for (rowI = 0; rowI < matrix->rows; rowI ++) {
+    memset(anmatMatrixRow(matrix, rowI) + rows,
+           0,
+           (stride - rows) * sizeof(ANMAT_VALUE));
+  }
+
+  return ANMAT_SUCCESS;
+}
+
+// -----------------------------------------------------------------------------
+// I/O
+
+AnmatStatus_t ANMAT_NAME(anmatMatrixPrint)(ANMAT_TYPE(AnmatMatrix) *matrix,
+                                           FILE *stream)
+{
+  AnmatStatus_t status = ANMAT_SUCCESS;
+  unsigned int rowI, colI;
+
+  fprintf(stream, "{\n");
+  FOR_ROW(matrix, rowI) {
+    FOR_COL(matrix, colI) {
+      fprintf(stream, " %06lf", anmatMatrixData(matrix, rowI, colI));
+    }
+    fprintf(stream, "\n");
+  }
+
+  fprintf(stream, "}\n");
+  fflush(stream);
+
+  return status;
+}
+
+static AnmatStatus_t ANMAT_NAME(appendValue)(double value,
+                                             ANMAT_VALUE **list,
+                                             unsigned int *pos,
+                                             unsigned int *listSize)
+{
+  ANMAT_VALUE *newList;
+
+  if (*pos == *listSize) {
+    newList
+      = (ANMAT_VALUE *)anmatRealloc(NULL,
+                                    *list,
+                                    (*listSize << 1) * sizeof(ANMAT_VALUE));
+    if (!newList) {
+      return ANMAT_MEM_ERR;
+    }
+    *list = newList;
+    *listSize <<= 1;
+  }
+
+  (*list)[*pos] = value;
+  (*pos) += 1;
+
+  return ANMAT_SUCCESS;
+}
+
+AnmatStatus_t ANMAT_NAME(anmatMatrixScan)(ANMAT_TYPE(AnmatMatrix) *matrix,
+                                          FILE *stream)
+{
+  AnmatStatus_t status = ANMAT_SUCCESS;
+  unsigned int pos, listSize;
+  ANMAT_VALUE *list;
+  double value;
+  unsigned int rows = 0, rowI, cols = 0, colI = 0;
+
+  // Initialize the list.
+  listSize = 5;
+  pos = 0;
+  list = (ANMAT_VALUE *)anmatAlloc(NULL, listSize * sizeof(ANMAT_VALUE));
+  if (!list) {
+    status = ANMAT_MEM_ERR;
+  }
+
+  if (status == ANMAT_SUCCESS) {
+    do {
+      switch (fgetc(stream)) {
+      case '{':
+        colI = cols = rows = 0;
+        break;
+      case ' ':
+        fscanf(stream, "%lf" , &value);
+        status = ANMAT_NAME(appendValue)(value, &list, &pos, &listSize);
+        if (status != ANMAT_SUCCESS) {
+          goto done;
+        }
+        colI ++;
+        break;
+      case '\n':
+        // If the dimensions are messed up, then we die.
+        if (cols != 0 && colI != cols) {
+          status = ANMAT_BAD_ARG;
+          goto done;
+        }
+        cols = colI;
+        colI = 0;
+        break;
+      case '}':
+        goto done;
+      default:
+        status = ANMAT_BAD_ARG;
+        goto done;
+      }
+    } while (1);
+  }
+
+ done:
+  if (list) {
+    if (status == ANMAT_SUCCESS) {
+      rows = pos / cols;
+      status = ANMAT_NAME(anmatMatrixAlloc)(matrix, rows, cols);
+      if (status == ANMAT_SUCCESS) {
+        unsigned int i = 0;
+        FOR_ROW(matrix, rowI) {
+          FOR_COL(matrix, colI) {
+            anmatMatrixData(matrix, rowI, colI) = list[i++];
+          }
+        }
+      }
+    }
+    anmatFree(NULL, list);
+  }
+
+  return status;
+}
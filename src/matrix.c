@@ -8,8 +8,15 @@
 // Matrix API.
 //
 
+#include <float.h>  // FLT_EPSILON, DBL_EPSILON
+#include <string.h> // memmove(), memset()
+
 #include "matrix.h"
-#include "src/heap.h"
+#include "src/gemm.h"
+#include "src/kernels.h"
+#include "src/pool.h"
+#include "src/strassen.h"
+#include "src/transpose.h"
 
 // -----------------------------------------------------------------------------
 // Private Functionality
@@ -27,287 +34,121 @@
 #define dimensionsAreEqual(matrixA, matrixB)                                 \
   ((matrixA)->rows == (matrixB)->rows && (matrixA)->cols == (matrixB)->cols)
 
-static inline double dotProduct(double *u, double *v, unsigned int length)
-{
-  double total = 0;
-
-  while (length--) {
-    total += u[length] * v[length];
-  }
-
-  return total;
-}
-
-// -----------------------------------------------------------------------------
-// Memory Management
-
-AnmatStatus_t anmatMatrixAlloc(AnmatMatrix_t *matrix,
-                               unsigned int rows,
-                               unsigned int cols)
-{
-  AnmatStatus_t status = ANMAT_BAD_ARG;
-  unsigned int rowI, colI;
-
-  if (rows && cols) {
-    status = ANMAT_SUCCESS;
+// These are only used in the template, where ANMAT_VALUE is defined.
 
-    matrix->rows = rows;
-    matrix->cols = cols;
-    matrix->data = (double **)heapAlloc(rows * sizeof(double *));
-    if (!matrix->data) {
-      status = ANMAT_MEM_ERR;
-    }
-
-    for (rowI = 0; rowI < rows && status == ANMAT_SUCCESS; rowI ++) {
-      matrix->data[rowI] = (double *)heapAlloc(cols * sizeof(double));
-      if (!matrix->data[rowI]) {
-        status = ANMAT_MEM_ERR;
-        anmatMatrixFree(matrix);
-      } else {
-        FOR_COL(matrix, colI) {
-          matrix->data[rowI][colI] = 0;
-        }
-      }
-    }
-  }
+// Rows that are at least ANMAT_DATA_ALIGNMENT bytes long are padded out to a
+// multiple of this many values, so that each one starts on a boundary of
+// ANMAT_DATA_ALIGNMENT bytes. Shorter rows are not padded, since that
+// could take several times the memory of the values (e.g., n x 1).
+#define STRIDE_VALUES (ANMAT_DATA_ALIGNMENT / sizeof(ANMAT_VALUE))
+#define strideFor(cols)                                                       \
+  ((cols) < STRIDE_VALUES                                                     \
+   ? (cols)                                                                   \
+   : (((cols) + (STRIDE_VALUES - 1)) & ~(STRIDE_VALUES - 1)))
 
-  return status;
-}
+#define matrixBytes(rows, stride) \
+  ((size_t)(rows) * (stride) * sizeof(ANMAT_VALUE))
 
-void anmatMatrixFree(AnmatMatrix_t *matrix)
-{
-  unsigned int rowI;
+// The unit roundoff is half of this.
+#define EPSILON \
+  (sizeof(ANMAT_VALUE) == sizeof(float) ? FLT_EPSILON : DBL_EPSILON)
 
-  for (rowI = 0; rowI < matrix->rows; rowI ++) {
-    if (matrix->data[rowI]) {
-      heapFree(matrix->data[rowI]);
-    }
-  }
+static AnmatStrassenConfig_t strassenConfig = ANMAT_STRASSEN_CONFIG_DEFAULT;
 
-  if (matrix->data) {
-    heapFree(matrix->data);
-  }
-}
+// The element-wise operations (see the template).
+typedef enum {
+  ELEMENT_SCALE,
+  ELEMENT_AXPBY,
+  ELEMENT_MULTIPLY,
+  ELEMENT_DIVIDE,
+  ELEMENT_CLAMP,
+} ElementOp_t;
 
 // -----------------------------------------------------------------------------
-// Elementary operations
+// Strassen
 
-bool anmatMatrixEquals(AnmatMatrix_t *matrixA,
-                       AnmatMatrix_t *matrixB)
+AnmatStatus_t anmatMatrixStrassenSet(const AnmatStrassenConfig_t *config)
 {
-  unsigned int rowI, colI;
+  AnmatStrassenConfig_t defaultConfig = ANMAT_STRASSEN_CONFIG_DEFAULT;
 
-  if (!dimensionsAreEqual(matrixA, matrixB)) {
-    note("anmatMatrixEquals: dimensions are not equal.\n");
-    return false;
+  if (!config) {
+    config = &defaultConfig;
+  } else if (config->crossover < ANMAT_STRASSEN_CROSSOVER_MIN) {
+    return ANMAT_BAD_ARG;
   }
 
-  FOR_ROW(matrixA, rowI) {
-    FOR_COL(matrixA, colI) {
-      if (!anmatUtilNeighborhood(matrixA->data[rowI][colI],
-                                 matrixB->data[rowI][colI],
-                                 1e-6)) {
-        note("anmatMatrixEquals: values are not equal: ");
-        note("(matrixA->data[%d][%d] = %lf) != (matrixB[%d][%d] = %lf)\n",
-             rowI, colI, matrixA->data[rowI][colI],
-             rowI, colI, matrixB->data[rowI][colI]);
-        return false;
-      }
-    }
-  }
+  strassenConfig = *config;
 
-  return true;
+  return ANMAT_SUCCESS;
 }
 
-static AnmatStatus_t addOrSubtractMatrices(AnmatMatrix_t *matrixA,
-                                           AnmatMatrix_t *matrixB,
-                                           AnmatMatrix_t *matrixC,
-                                           bool add)
+void anmatMatrixStrassenGet(AnmatStrassenConfig_t *config)
 {
-  AnmatStatus_t status = ANMAT_BAD_ARG;
-  unsigned int rowI, colI;
-
-  if (dimensionsAreEqual(matrixA, matrixB)
-      && dimensionsAreEqual(matrixB, matrixC)) {
-    status = ANMAT_SUCCESS;
-    FOR_ROW(matrixC, rowI) {
-      FOR_COL(matrixC, colI) {
-        matrixC->data[rowI][colI]
-          = (add
-             ? matrixA->data[rowI][colI] + matrixB->data[rowI][colI]
-             : matrixA->data[rowI][colI] - matrixB->data[rowI][colI]);
-      }
-    }
-  }
-
-  return status;
+  *config = strassenConfig;
 }
 
-AnmatStatus_t anmatMatrixAdd(AnmatMatrix_t *matrixA,
-                             AnmatMatrix_t *matrixB,
-                             AnmatMatrix_t *matrixC)
-{
-  return addOrSubtractMatrices(matrixA, matrixB, matrixC, true); // add?
-}
-
-AnmatStatus_t anmatMatrixSubtract(AnmatMatrix_t *matrixA,
-                                  AnmatMatrix_t *matrixB,
-                                  AnmatMatrix_t *matrixC)
-{
-  return addOrSubtractMatrices(matrixA, matrixB, matrixC, false); // add?
-}
-
-AnmatStatus_t anmatMatrixMultiply(AnmatMatrix_t *matrixA,
-                                  AnmatMatrix_t *matrixB,
-                                  AnmatMatrix_t *matrixC)
-{
-  AnmatStatus_t status = ANMAT_BAD_ARG;
-  AnmatMatrix_t matrixBT;
-  unsigned int rowI, colI;
-
-  if (matrixA->cols == matrixB->rows
-      && matrixC->rows == matrixA->rows
-      && matrixC->cols == matrixB->cols) {
-    status = anmatMatrixAlloc(&matrixBT, matrixB->cols, matrixB->rows);
-    if (status == ANMAT_SUCCESS) {
-      status = anmatMatrixTranspose(matrixB, &matrixBT);
-      if (status == ANMAT_SUCCESS) {
-        FOR_ROW(matrixC, rowI) {
-          FOR_COL(matrixC, colI) {
-            matrixC->data[rowI][colI] = dotProduct(matrixA->data[rowI],
-                                                   matrixBT.data[rowI],
-                                                   matrixA->rows);
-          }
-        }
-      }
-      anmatMatrixFree(&matrixBT);
-    }
-  }
-
-  return status;
-}
+// -----------------------------------------------------------------------------
+// Precisions
+
+#define ANMAT_VALUE      double
+#define ANMAT_NAME(name) name
+#define ANMAT_TYPE(name) name ## _t
+#include "src/matrix-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_NAME
+#undef ANMAT_TYPE
+
+#define ANMAT_VALUE      float
+#define ANMAT_NAME(name) name ## F
+#define ANMAT_TYPE(name) name ## F_t
+#include "src/matrix-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_NAME
+#undef ANMAT_TYPE
 
 // -----------------------------------------------------------------------------
-// Matrix Operations
+// Conversions
 
-AnmatStatus_t anmatMatrixTranspose(AnmatMatrix_t *matrixA,
-                                   AnmatMatrix_t *matrixB)
+AnmatStatus_t anmatMatrixToFloat(AnmatMatrix_t *matrix,
+                                 AnmatMatrixF_t *matrixF)
 {
-  AnmatStatus_t status = ANMAT_BAD_ARG;
   unsigned int rowI, colI;
+  double *row;
+  float *rowF;
 
-  if (matrixA->rows == matrixB->cols && matrixA->cols == matrixB->rows) {
-    status = ANMAT_SUCCESS;
-    FOR_ROW(matrixA, rowI) {
-      FOR_COL(matrixA, colI) {
-        matrixB->data[colI][rowI] = matrixA->data[rowI][colI];
-      }
-    }
+  if (!dimensionsAreEqual(matrix, matrixF)) {
+    return ANMAT_BAD_ARG;
   }
 
-  return status;
-}
-
-// -----------------------------------------------------------------------------
-// I/O
-
-AnmatStatus_t anmatMatrixPrint(AnmatMatrix_t *matrix,
-                               FILE *stream)
-{
-  AnmatStatus_t status = ANMAT_SUCCESS;
-  unsigned int rowI, colI;
-
-  fprintf(stream, "{\n");
   FOR_ROW(matrix, rowI) {
+    row = anmatMatrixRow(matrix, rowI);
+    rowF = anmatMatrixRow(matrixF, rowI);
     FOR_COL(matrix, colI) {
-      fprintf(stream, " %06lf", matrix->data[rowI][colI]);
+      rowF[colI] = (float)row[colI];
     }
-    fprintf(stream, "\n");
   }
 
-  fprintf(stream, "}\n");
-  fflush(stream);
-
-  return status;
+  return ANMAT_SUCCESS;
 }
 
-static void appendValue(double value,
-                        double **list,
-                        unsigned int *pos,
-                        unsigned int *listSize)
+AnmatStatus_t anmatMatrixToDouble(AnmatMatrixF_t *matrixF,
+                                  AnmatMatrix_t *matrix)
 {
-  if (*pos == *listSize) {
-    double *newList = (double *)heapAlloc((*listSize <<= 1) * sizeof(double));
-    anmatMemcpy(newList, *list, *pos * sizeof(double));
-    heapFree(*list);
-    *list = newList;
-  }
-
-  (*list)[*pos] = value;
-  (*pos) += 1;
-}
-
-AnmatStatus_t anmatMatrixScan(AnmatMatrix_t *matrix,
-                              FILE *stream)
-{
-  AnmatStatus_t status = ANMAT_SUCCESS;
-  unsigned int pos, listSize;
-  double value, *list;
-  unsigned int rows, rowI, cols, colI;
-
-  // Initialize the list.
-  listSize = 5;
-  pos = 0;
-  list = heapAlloc(listSize * sizeof(double));
-  if (!list) {
-    status = ANMAT_MEM_ERR;
-  }
+  unsigned int rowI, colI;
+  float *rowF;
+  double *row;
 
-  if (status == ANMAT_SUCCESS) {
-    do {
-      switch (fgetc(stream)) {
-      case '{':
-        colI = cols = rows = 0;
-        break;
-      case ' ':
-        fscanf(stream, "%lf" , &value);
-        appendValue(value, &list, &pos, &listSize);
-        colI ++;
-        break;
-      case '\n':
-        // If the dimensions are messed up, then we die.
-        if (cols != 0 && colI != cols) {
-          status = ANMAT_BAD_ARG;
-          goto done;
-        }
-        cols = colI;
-        colI = 0;
-        break;
-      case '}':
-        goto done;
-      default:
-        status = ANMAT_BAD_ARG;
-        goto done;
-      }
-    } while (1);
+  if (!dimensionsAreEqual(matrixF, matrix)) {
+    return ANMAT_BAD_ARG;
   }
 
- done:
-  if (list) {
-    if (status == ANMAT_SUCCESS) {
-      rows = pos / cols;
-      status = anmatMatrixAlloc(matrix, rows, cols);
-      if (status == ANMAT_SUCCESS) {
-        unsigned int i = 0;
-        FOR_ROW(matrix, rowI) {
-          FOR_COL(matrix, colI) {
-            matrix->data[rowI][colI] = list[i++];
-          }
-        }
-      }
+  FOR_ROW(matrix, rowI) {
+    rowF = anmatMatrixRow(matrixF, rowI);
+    row = anmatMatrixRow(matrix, rowI);
+    FOR_COL(matrix, colI) {
+      row[colI] = rowF[colI];
     }
-    heapFree(list);
   }
 
-  return status;
+  return ANMAT_SUCCESS;
 }
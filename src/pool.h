@@ -0,0 +1,40 @@
+//
+// pool.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Thread pool for the anmat library.
+//
+
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include "anmat.h"
+
+// A piece of some work: the taskI'th of however many tasks it was split into.
+// The tasks of one run must not write to the same memory, and must not
+// allocate from the heap (see thread.h).
+typedef void (*PoolTask_t)(void *context, unsigned int taskI);
+
+// Get how many tasks to split work into, based on the thread count and the
+// threshold (see thread.h). Returns 1 if the work should stay serial.
+unsigned int anmatPoolTaskCount(size_t work);
+
+// Run tasks 0 through taskCount - 1 on the pool and the calling thread, and
+// return once they have all finished. Tasks may run in any order.
+// The tasks run serially on the calling thread if the pool is busy (e.g.,
+// anmatPoolRun is called from a task).
+void anmatPoolRun(PoolTask_t task, void *context, unsigned int taskCount);
+
+// Get the [*start, *end) range of count things that the taskI'th of
+// taskCount tasks should do. Ranges start on multiples of multiple.
+void anmatPoolSplit(unsigned int count,
+                    unsigned int multiple,
+                    unsigned int taskI,
+                    unsigned int taskCount,
+                    unsigned int *start,
+                    unsigned int *end);
+
+#endif /* __POOL_H__ */
@@ -0,0 +1,531 @@
+//
+// qr.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// QR API.
+//
+
+#include <math.h>   // copysign(), sqrt()
+#include <string.h> // memcpy(), memset()
+
+#include "qr.h"
+#include "src/gemm.h"
+#include "src/kernels.h"
+#include "src/pool.h"
+#include "src/transpose.h"
+#include "src/trsm.h"
+
+//#define QR_DEBUG
+#ifdef QR_DEBUG
+  #define note(...) printf(__VA_ARGS__), fflush(0);
+#else
+  #define note(...)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+
+// The factorization is blocked, like LAPACK's dgeqrf. The matrix is walked
+// across in panels of BLOCK columns. Each panel is factored one column at a
+// time (see factorUnblocked), and its reflections are put together into
+// H(j0) * ... * H(j1 - 1) = I - (V * T * V'), where V holds the vectors and T
+// is upper triangular (see buildReflector). Then the rest of the matrix, C,
+// becomes Q' * C = C - (V * (T' * (V' * C))), which is two gemms (see
+// applyReflector). Those gemms are most of the work.
+//
+// gemm only takes its inputs one way, so V' is kept too.
+
+#define BLOCK (32)
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+
+#define rowOf(b, ldb, rowI) ((b) + ((size_t)(rowI) * (ldb)))
+
+// The temporaries for putting together (and applying) the reflections of a
+// panel of up to BLOCK columns, over up to rows rows, to up to cols columns.
+typedef struct {
+  double *v;         // rows x BLOCK
+  double *vT;        // BLOCK x rows
+  double *t;         // BLOCK x BLOCK
+  double *gram;      // BLOCK x BLOCK
+  double *w, *tW;    // BLOCK x cols, each
+} Reflector_t;
+
+static bool reflectorAlloc(Reflector_t *reflector,
+                           AnmatArena_t *scratch,
+                           unsigned int rows,
+                           unsigned int cols)
+{
+  reflector->v = (double *)anmatArenaAlloc(scratch,
+                                           ((size_t)rows * BLOCK
+                                            * sizeof(double)));
+  reflector->vT = (double *)anmatArenaAlloc(scratch,
+                                            ((size_t)rows * BLOCK
+                                             * sizeof(double)));
+  reflector->t = (double *)anmatArenaAlloc(scratch,
+                                           BLOCK * BLOCK * sizeof(double));
+  reflector->gram = (double *)anmatArenaAlloc(scratch,
+                                              BLOCK * BLOCK * sizeof(double));
+  reflector->w = (double *)anmatArenaAlloc(scratch,
+                                           ((size_t)cols * BLOCK
+                                            * sizeof(double)));
+  reflector->tW = (double *)anmatArenaAlloc(scratch,
+                                            ((size_t)cols * BLOCK
+                                             * sizeof(double)));
+
+  return (reflector->v && reflector->vT && reflector->t && reflector->gram
+          && reflector->w && reflector->tW);
+}
+
+// Factor the rows x cols block at a (rows >= cols is not needed), one column
+// at a time, into R on and above the diagonal, and the vectors of the
+// reflections below it (like AnmatQr_t), with their tau's in tau. The
+// temporary has room for cols values.
+static void factorUnblocked(double *a,
+                            unsigned int lda,
+                            unsigned int rows,
+                            unsigned int cols,
+                            double *tau,
+                            double *w)
+{
+  unsigned int j, rowI, rest;
+  double alpha, beta, length, *rowJ, *row;
+
+  for (j = 0; j < cols && j < rows; j ++) {
+    rowJ = rowOf(a, lda, j);
+    alpha = rowJ[j];
+    length = 0;
+    for (rowI = j + 1; rowI < rows; rowI ++) {
+      length += rowOf(a, lda, rowI)[j] * rowOf(a, lda, rowI)[j];
+    }
+
+    // Nothing to zero out, so H(j) is I.
+    if (length == 0) {
+      tau[j] = 0;
+      continue;
+    }
+
+    // H(j) takes the column to (beta, 0, ..., 0), with the sign of beta
+    // picked so that alpha - beta does not cancel out.
+    beta = -copysign(sqrt((alpha * alpha) + length), alpha);
+    tau[j] = (beta - alpha) / beta;
+    for (rowI = j + 1; rowI < rows; rowI ++) {
+      rowOf(a, lda, rowI)[j] /= (alpha - beta);
+    }
+    rowJ[j] = beta;
+
+    // Apply H(j) to the columns to the right: w = v' * C, then
+    // C = C - (tau * v * w).
+    rest = cols - j - 1;
+    if (!rest) {
+      continue;
+    }
+    memcpy(w, rowJ + j + 1, rest * sizeof(double));
+    for (rowI = j + 1; rowI < rows; rowI ++) {
+      row = rowOf(a, lda, rowI);
+      anmatKernels->axpby(row + j + 1, row[j], w, 1, w, rest);
+    }
+    anmatKernels->axpby(w, -tau[j], rowJ + j + 1, 1, rowJ + j + 1, rest);
+    for (rowI = j + 1; rowI < rows; rowI ++) {
+      row = rowOf(a, lda, rowI);
+      anmatKernels->axpby(w, -tau[j] * row[j], row + j + 1, 1, row + j + 1,
+                          rest);
+    }
+  }
+}
+
+// Put together the reflections of the rows x count panel at a, which has
+// been factored, into V, V' and T.
+static AnmatStatus_t buildReflector(Reflector_t *reflector,
+                                    const double *a,
+                                    unsigned int lda,
+                                    unsigned int rows,
+                                    unsigned int count,
+                                    const double *tau)
+{
+  double *v = reflector->v, *t = reflector->t, *gram = reflector->gram;
+  unsigned int rowI, colI, i;
+  AnmatStatus_t status;
+  double total;
+
+  for (rowI = 0; rowI < rows; rowI ++) {
+    for (colI = 0; colI < count; colI ++) {
+      rowOf(v, count, rowI)[colI] = (rowI > colI
+                                     ? rowOf(a, lda, rowI)[colI]
+                                     : (rowI == colI ? 1 : 0));
+    }
+  }
+  anmatTranspose(v, count, reflector->vT, rows, rows, count);
+
+  // T(0:i, i) = -tau[i] * T(0:i, 0:i) * (V(:, 0:i)' * v(i)), from the dot
+  // products of the vectors.
+  status = anmatGemm(count, count, rows, 1, reflector->vT, rows, v, count,
+                     0, gram, count);
+  if (status != ANMAT_SUCCESS) {
+    return status;
+  }
+  memset(t, 0, (size_t)count * count * sizeof(double));
+  for (colI = 0; colI < count; colI ++) {
+    for (rowI = 0; rowI < colI; rowI ++) {
+      total = 0;
+      for (i = rowI; i < colI; i ++) {
+        total += rowOf(t, count, rowI)[i] * rowOf(gram, count, i)[colI];
+      }
+      rowOf(t, count, rowI)[colI] = -tau[colI] * total;
+    }
+    rowOf(t, count, colI)[colI] = tau[colI];
+  }
+
+  return ANMAT_SUCCESS;
+}
+
+// C = Q' * C = C - (V * (T' * (V' * C))), for the rows x cols C at c and the
+// reflections of count columns.
+static AnmatStatus_t applyReflector(Reflector_t *reflector,
+                                    unsigned int rows,
+                                    unsigned int count,
+                                    double *c,
+                                    unsigned int ldc,
+                                    unsigned int cols)
+{
+  double *w = reflector->w, *tW = reflector->tW, *t = reflector->t;
+  unsigned int i, k;
+  AnmatStatus_t status;
+
+  status = anmatGemm(count, cols, rows, 1, reflector->vT, rows, c, ldc,
+                     0, w, cols);
+  if (status != ANMAT_SUCCESS) {
+    return status;
+  }
+
+  // T' is lower triangular, so row i of T' * W only takes rows 0 through i
+  // of W.
+  for (i = 0; i < count; i ++) {
+    memset(rowOf(tW, cols, i), 0, cols * sizeof(double));
+    for (k = 0; k <= i; k ++) {
+      anmatKernels->axpby(rowOf(w, cols, k), rowOf(t, count, k)[i],
+                          rowOf(tW, cols, i), 1, rowOf(tW, cols, i), cols);
+    }
+  }
+
+  return anmatGemm(rows, cols, count, -1, reflector->v, count, tW, cols,
+                   1, c, ldc);
+}
+
+// Check that none of the first n values on the diagonal of R are 0.
+static bool isFullRank(const double *r, unsigned int ldr, unsigned int n)
+{
+  unsigned int i;
+
+  for (i = 0; i < n; i ++) {
+    if (rowOf(r, ldr, i)[i] == 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Find the n x nrhs X at x that makes A * X closest to the m x nrhs B at b.
+static AnmatStatus_t solve(AnmatQr_t *qr,
+                           unsigned int nrhs,
+                           const double *b,
+                           unsigned int ldb,
+                           double *x,
+                           unsigned int ldx)
+{
+  AnmatMatrix_t *factors = &qr->factors;
+  unsigned int m = factors->rows, n = factors->cols, rowI, start, end;
+  AnmatStatus_t status = ANMAT_MEM_ERR;
+  Reflector_t reflector;
+  AnmatArena_t *scratch;
+  AnmatArenaMark_t mark;
+  double *y;
+
+  if (!isFullRank(factors->data, factors->stride, n)) {
+    return ANMAT_BAD_ARG;
+  }
+
+  scratch = anmatArenaScratch();
+  mark = anmatArenaMark(scratch);
+  y = (double *)anmatArenaAlloc(scratch,
+                                (size_t)m * nrhs * sizeof(double));
+  if (!y || !reflectorAlloc(&reflector, scratch, m, nrhs)) {
+    goto done;
+  }
+  for (rowI = 0; rowI < m; rowI ++) {
+    memcpy(rowOf(y, nrhs, rowI), rowOf(b, ldb, rowI), nrhs * sizeof(double));
+  }
+
+  // Y = Q' * B, a panel at a time, then X = R^-1 * Y(0:n).
+  status = ANMAT_SUCCESS;
+  for (start = 0; start < n && status == ANMAT_SUCCESS; start = end) {
+    end = min(n, start + BLOCK);
+    status = buildReflector(&reflector,
+                            anmatMatrixRow(factors, start) + start,
+                            factors->stride, m - start, end - start,
+                            qr->tau + start);
+    if (status == ANMAT_SUCCESS) {
+      status = applyReflector(&reflector, m - start, end - start,
+                              rowOf(y, nrhs, start), nrhs, nrhs);
+    }
+  }
+  if (status == ANMAT_SUCCESS) {
+    status = anmatTrsm(false, false, n, nrhs, factors->data, factors->stride,
+                       y, nrhs);
+  }
+  if (status == ANMAT_SUCCESS) {
+    for (rowI = 0; rowI < n; rowI ++) {
+      memcpy(rowOf(x, ldx, rowI), rowOf(y, nrhs, rowI),
+             nrhs * sizeof(double));
+    }
+  }
+
+ done:
+  anmatArenaReset(scratch, mark);
+
+  return status;
+}
+
+// -----------------------------------------------------------------------------
+// TSQR
+
+// The rows of [A B] are split into blocks, one per task, and each block is
+// factored on its own. The R of a block (its top cols rows) is then copied
+// into a stack of R's, which is factored again. Since Q' * [A B] = [R Q'B],
+// the top right of the final R is Q' * B, so Q is never needed.
+
+typedef struct {
+  double *ab;             // m x cols, [A B]
+  unsigned int m, cols;
+  double *tau, *w;        // cols per task, each
+  double *stack;          // (taskCount * cols) x cols
+  unsigned int taskCount;
+} TsqrJob_t;
+
+static void tsqrTask(void *context, unsigned int taskI)
+{
+  TsqrJob_t *job = (TsqrJob_t *)context;
+  unsigned int cols = job->cols, start, end, rowI, count;
+  double *block, *stack;
+
+  anmatPoolSplit(job->m, 1, taskI, job->taskCount, &start, &end);
+  block = rowOf(job->ab, cols, start);
+  factorUnblocked(block, cols, end - start, cols,
+                  job->tau + ((size_t)taskI * cols),
+                  job->w + ((size_t)taskI * cols));
+
+  // Copy R (which is only end - start rows, for a short block), with the
+  // vectors below the diagonal taken out.
+  stack = rowOf(job->stack, cols, (size_t)taskI * cols);
+  memset(stack, 0, (size_t)cols * cols * sizeof(double));
+  count = min(end - start, cols);
+  for (rowI = 0; rowI < count; rowI ++) {
+    memcpy(rowOf(stack, cols, rowI) + rowI, rowOf(block, cols, rowI) + rowI,
+           (cols - rowI) * sizeof(double));
+  }
+}
+
+static AnmatStatus_t tsqr(AnmatMatrix_t *matrixA,
+                          AnmatMatrix_t *matrixB,
+                          AnmatMatrix_t *matrixX)
+{
+  unsigned int m = matrixA->rows, n = matrixA->cols, k = matrixB->cols;
+  unsigned int cols = n + k, rowI;
+  AnmatStatus_t status = ANMAT_MEM_ERR;
+  AnmatArena_t *scratch;
+  AnmatArenaMark_t mark;
+  TsqrJob_t job;
+
+  // Each block should have at least as many rows as cols.
+  job.taskCount = anmatPoolTaskCount((size_t)m * cols * cols);
+  if (job.taskCount > m / cols) {
+    job.taskCount = (m / cols ? m / cols : 1);
+  }
+  job.m = m;
+  job.cols = cols;
+
+  scratch = anmatArenaScratch();
+  mark = anmatArenaMark(scratch);
+  job.ab = (double *)anmatArenaAlloc(scratch,
+                                     (size_t)m * cols * sizeof(double));
+  job.tau = (double *)anmatArenaAlloc(scratch,
+                                      ((size_t)job.taskCount * cols
+                                       * sizeof(double)));
+  job.w = (double *)anmatArenaAlloc(scratch,
+                                    ((size_t)job.taskCount * cols
+                                     * sizeof(double)));
+  job.stack = (double *)anmatArenaAlloc(scratch,
+                                        ((size_t)job.taskCount * cols * cols
+                                         * sizeof(double)));
+  if (!job.ab || !job.tau || !job.w || !job.stack) {
+    goto done;
+  }
+
+  for (rowI = 0; rowI < m; rowI ++) {
+    memcpy(rowOf(job.ab, cols, rowI), anmatMatrixRow(matrixA, rowI),
+           n * sizeof(double));
+    memcpy(rowOf(job.ab, cols, rowI) + n, anmatMatrixRow(matrixB, rowI),
+           k * sizeof(double));
+  }
+
+  note("tsqr: %u x %u in %u blocks\n", m, cols, job.taskCount);
+
+  anmatPoolRun(tsqrTask, &job, job.taskCount);
+  if (job.taskCount > 1) {
+    factorUnblocked(job.stack, cols, job.taskCount * cols, cols,
+                    job.tau, job.w);
+  }
+
+  // X = R^-1 * (Q' * B)(0:n).
+  if (!isFullRank(job.stack, cols, n)) {
+    status = ANMAT_BAD_ARG;
+    goto done;
+  }
+  status = anmatTrsm(false, false, n, k, job.stack, cols, job.stack + n, cols);
+  if (status == ANMAT_SUCCESS) {
+    for (rowI = 0; rowI < n; rowI ++) {
+      memcpy(anmatMatrixRow(matrixX, rowI), rowOf(job.stack, cols, rowI) + n,
+             k * sizeof(double));
+    }
+  }
+
+ done:
+  anmatArenaReset(scratch, mark);
+
+  return status;
+}
+
+// -----------------------------------------------------------------------------
+// Factorization
+
+AnmatStatus_t anmatQrFactor(AnmatQr_t *qr, AnmatMatrix_t *matrix)
+{
+  AnmatMatrix_t *factors = &qr->factors;
+  unsigned int m = matrix->rows, n = matrix->cols, rowI, start, end;
+  AnmatStatus_t status;
+  Reflector_t reflector;
+  AnmatArena_t *scratch;
+  AnmatArenaMark_t mark;
+  double *w;
+
+  if (m < n) {
+    return ANMAT_BAD_ARG;
+  }
+
+  status = anmatMatrixAlloc(factors, m, n);
+  if (status != ANMAT_SUCCESS) {
+    return status;
+  }
+  qr->tau = (double *)anmatAllocAligned(factors->allocator,
+                                        n * sizeof(double),
+                                        ANMAT_DATA_ALIGNMENT);
+  if (!qr->tau) {
+    anmatMatrixFree(factors);
+    return ANMAT_MEM_ERR;
+  }
+
+  for (rowI = 0; rowI < m; rowI ++) {
+    memcpy(anmatMatrixRow(factors, rowI), anmatMatrixRow(matrix, rowI),
+           n * sizeof(double));
+  }
+
+  scratch = anmatArenaScratch();
+  mark = anmatArenaMark(scratch);
+  w = (double *)anmatArenaAlloc(scratch, BLOCK * sizeof(double));
+  if (!w || !reflectorAlloc(&reflector, scratch, m, n)) {
+    status = ANMAT_MEM_ERR;
+  }
+
+  for (start = 0; start < n && status == ANMAT_SUCCESS; start = end) {
+    end = min(n, start + BLOCK);
+    factorUnblocked(anmatMatrixRow(factors, start) + start, factors->stride,
+                    m - start, end - start, qr->tau + start, w);
+    if (end < n) {
+      status = buildReflector(&reflector,
+                              anmatMatrixRow(factors, start) + start,
+                              factors->stride, m - start, end - start,
+                              qr->tau + start);
+    }
+    if (end < n && status == ANMAT_SUCCESS) {
+      status = applyReflector(&reflector, m - start, end - start,
+                              anmatMatrixRow(factors, start) + end,
+                              factors->stride, n - end);
+    }
+  }
+
+  anmatArenaReset(scratch, mark);
+
+  if (status != ANMAT_SUCCESS) {
+    anmatQrFree(qr);
+  }
+
+  return status;
+}
+
+void anmatQrFree(AnmatQr_t *qr)
+{
+  anmatFree(qr->factors.allocator, qr->tau);
+  anmatMatrixFree(&qr->factors);
+}
+
+// -----------------------------------------------------------------------------
+// Operations
+
+AnmatStatus_t anmatQrSolve(AnmatQr_t *qr,
+                           AnmatMatrix_t *matrixB,
+                           AnmatMatrix_t *matrixX)
+{
+  if (matrixB->rows != qr->factors.rows
+      || matrixX->rows != qr->factors.cols
+      || matrixX->cols != matrixB->cols) {
+    return ANMAT_BAD_ARG;
+  }
+
+  return solve(qr, matrixB->cols, matrixB->data, matrixB->stride,
+               matrixX->data, matrixX->stride);
+}
+
+AnmatStatus_t anmatQrSolveVector(AnmatQr_t *qr,
+                                 AnmatVector_t *vectorB,
+                                 AnmatVector_t *vectorX)
+{
+  if (vectorB->count != qr->factors.rows
+      || vectorX->count != qr->factors.cols) {
+    return ANMAT_BAD_ARG;
+  }
+
+  return solve(qr, 1, vectorB->data, 1, vectorX->data, 1);
+}
+
+AnmatStatus_t anmatLeastSquares(AnmatQrMode_t mode,
+                                AnmatMatrix_t *matrixA,
+                                AnmatMatrix_t *matrixB,
+                                AnmatMatrix_t *matrixX)
+{
+  AnmatStatus_t status;
+  AnmatQr_t qr;
+
+  if ((mode != ANMAT_QR_BLOCKED && mode != ANMAT_QR_TSQR)
+      || matrixA->rows < matrixA->cols
+      || matrixB->rows != matrixA->rows
+      || matrixX->rows != matrixA->cols
+      || matrixX->cols != matrixB->cols) {
+    return ANMAT_BAD_ARG;
+  }
+
+  if (mode == ANMAT_QR_TSQR) {
+    return tsqr(matrixA, matrixB, matrixX);
+  }
+
+  status = anmatQrFactor(&qr, matrixA);
+  if (status == ANMAT_SUCCESS) {
+    status = anmatQrSolve(&qr, matrixB, matrixX);
+    anmatQrFree(&qr);
+  }
+
+  return status;
+}
@@ -0,0 +1,253 @@
+//
+// simd.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// SIMD API.
+//
+
+#include <stdlib.h> // getenv()
+#include <string.h> // strcmp()
+
+#include "simd.h"
+#include "src/kernels.h"
+
+//#define SIMD_DEBUG
+#ifdef SIMD_DEBUG
+  #define note(...) printf(__VA_ARGS__), fflush(0);
+#else
+  #define note(...)
+#endif
+
+// -----------------------------------------------------------------------------
+// Kernels
+
+// Each level is included once for doubles and once for floats. A vector of
+// floats holds twice as many values, so the float tiles are twice as wide.
+
+// Portable C, with the 16 byte vectors that every x86-64 (and ARMv8)
+// processor has. A 4 x 4 tile of doubles is 8 of them, which leaves room in
+// the 16 vector registers for a row of the B sliver and a broadcast value of
+// A.
+#define KERNEL_TARGET
+#define KERNEL_MR           (4)
+
+#define ANMAT_VALUE         double
+#define ANMAT_TYPE(name)    name ## _t
+#define KERNEL(name)        portable ## name
+#define KERNEL_LANES        (2)
+#define KERNEL_NR           (4)
+#include "src/kernels-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_TYPE
+#undef KERNEL
+#undef KERNEL_LANES
+#undef KERNEL_NR
+
+#define ANMAT_VALUE         float
+#define ANMAT_TYPE(name)    name ## F_t
+#define KERNEL(name)        portable ## name ## F
+#define KERNEL_LANES        (4)
+#define KERNEL_NR           (8)
+#include "src/kernels-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_TYPE
+#undef KERNEL
+#undef KERNEL_LANES
+#undef KERNEL_NR
+
+#undef KERNEL_TARGET
+#undef KERNEL_MR
+
+#ifdef __x86_64__
+
+// AVX2 has 16 32 byte registers. A 6 x 8 tile of doubles is 12 of them, plus
+// 2 for a row of the B sliver and 1 for a broadcast value of A. The tile is
+// updated with FMA instructions.
+#define KERNEL_TARGET       __attribute__((target("avx2,fma")))
+#define KERNEL_MR           (6)
+
+#define ANMAT_VALUE         double
+#define ANMAT_TYPE(name)    name ## _t
+#define KERNEL(name)        avx2 ## name
+#define KERNEL_LANES        (4)
+#define KERNEL_NR           (8)
+#include "src/kernels-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_TYPE
+#undef KERNEL
+#undef KERNEL_LANES
+#undef KERNEL_NR
+
+#define ANMAT_VALUE         float
+#define ANMAT_TYPE(name)    name ## F_t
+#define KERNEL(name)        avx2 ## name ## F
+#define KERNEL_LANES        (8)
+#define KERNEL_NR           (16)
+#include "src/kernels-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_TYPE
+#undef KERNEL
+#undef KERNEL_LANES
+#undef KERNEL_NR
+
+#undef KERNEL_TARGET
+#undef KERNEL_MR
+
+// AVX-512 has 32 64 byte registers. An 8 x 16 tile of doubles is 16 of them.
+#define KERNEL_TARGET       __attribute__((target("avx512f")))
+#define KERNEL_MR           (8)
+
+#define ANMAT_VALUE         double
+#define ANMAT_TYPE(name)    name ## _t
+#define KERNEL(name)        avx512 ## name
+#define KERNEL_LANES        (8)
+#define KERNEL_NR           (16)
+#include "src/kernels-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_TYPE
+#undef KERNEL
+#undef KERNEL_LANES
+#undef KERNEL_NR
+
+#define ANMAT_VALUE         float
+#define ANMAT_TYPE(name)    name ## F_t
+#define KERNEL(name)        avx512 ## name ## F
+#define KERNEL_LANES        (16)
+#define KERNEL_NR           (32)
+#include "src/kernels-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_TYPE
+#undef KERNEL
+#undef KERNEL_LANES
+#undef KERNEL_NR
+
+#undef KERNEL_TARGET
+#undef KERNEL_MR
+
+#endif /* __x86_64__ */
+
+const Kernels_t *anmatKernels = &portablekernels;
+const KernelsF_t *anmatKernelsF = &portablekernelsF;
+
+// -----------------------------------------------------------------------------
+// Levels
+
+static AnmatSimdLevel_t currentLevel = ANMAT_SIMD_PORTABLE;
+
+static const char *levelNames[] = {
+  [ANMAT_SIMD_AUTO]     = "auto",
+  [ANMAT_SIMD_PORTABLE] = "portable",
+  [ANMAT_SIMD_AVX2]     = "avx2",
+  [ANMAT_SIMD_AVX512]   = "avx512",
+};
+#define LEVEL_COUNT (sizeof(levelNames) / sizeof(levelNames[0]))
+
+// Point anmatKernels and anmatKernelsF at a level's tables.
+static void useKernels(AnmatSimdLevel_t level)
+{
+  switch (level) {
+#ifdef __x86_64__
+  case ANMAT_SIMD_AVX2:
+    anmatKernels = &avx2kernels;
+    anmatKernelsF = &avx2kernelsF;
+    break;
+  case ANMAT_SIMD_AVX512:
+    anmatKernels = &avx512kernels;
+    anmatKernelsF = &avx512kernelsF;
+    break;
+#endif
+  default:
+    anmatKernels = &portablekernels;
+    anmatKernelsF = &portablekernelsF;
+    break;
+  }
+}
+
+static AnmatSimdLevel_t bestLevel(void)
+{
+  AnmatSimdLevel_t best = ANMAT_SIMD_PORTABLE;
+  unsigned int levelI;
+
+  for (levelI = ANMAT_SIMD_PORTABLE; levelI < LEVEL_COUNT; levelI ++) {
+    if (anmatSimdLevelSupported((AnmatSimdLevel_t)levelI)) {
+      best = (AnmatSimdLevel_t)levelI;
+    }
+  }
+
+  return best;
+}
+
+// Pick the level before main() runs, so that nothing ever sees the kernels
+// change underneath it unless it asks for it.
+__attribute__((constructor))
+static void pickLevel(void)
+{
+  const char *name = getenv("ANMAT_SIMD_LEVEL");
+  unsigned int levelI;
+
+  if (name) {
+    for (levelI = 0; levelI < LEVEL_COUNT; levelI ++) {
+      if (!strcmp(name, levelNames[levelI])
+          && anmatSimdLevelSet((AnmatSimdLevel_t)levelI) == ANMAT_SUCCESS) {
+        note("simd: using %s from the environment\n", name);
+        return;
+      }
+    }
+    note("simd: ignoring ANMAT_SIMD_LEVEL=%s\n", name);
+  }
+
+  anmatSimdLevelSet(ANMAT_SIMD_AUTO);
+}
+
+// -----------------------------------------------------------------------------
+// API
+
+AnmatStatus_t anmatSimdLevelSet(AnmatSimdLevel_t newLevel)
+{
+  if (newLevel == ANMAT_SIMD_AUTO) {
+    newLevel = bestLevel();
+  }
+
+  if (!anmatSimdLevelSupported(newLevel)) {
+    return ANMAT_BAD_ARG;
+  }
+
+  currentLevel = newLevel;
+  useKernels(newLevel);
+  note("simd: using %s\n", levelNames[currentLevel]);
+
+  return ANMAT_SUCCESS;
+}
+
+AnmatSimdLevel_t anmatSimdLevelGet(void)
+{
+  return currentLevel;
+}
+
+bool anmatSimdLevelSupported(AnmatSimdLevel_t level)
+{
+  switch (level) {
+  case ANMAT_SIMD_AUTO:
+  case ANMAT_SIMD_PORTABLE:
+    return true;
+#ifdef __x86_64__
+  case ANMAT_SIMD_AVX2:
+    __builtin_cpu_init();
+    return (__builtin_cpu_supports("avx2")
+            && __builtin_cpu_supports("fma"));
+  case ANMAT_SIMD_AVX512:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f");
+#endif
+  default:
+    return false;
+  }
+}
+
+const char *anmatSimdLevelName(AnmatSimdLevel_t level)
+{
+  return ((unsigned int)level < LEVEL_COUNT ? levelNames[level] : NULL);
+}
@@ -0,0 +1,661 @@
+//
+// sparse.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Sparse matrix API.
+//
+
+#include <stdlib.h> // qsort()
+#include <string.h> // memcpy(), memmove(), memset()
+
+#include "sparse.h"
+#include "src/kernels.h"
+#include "src/pool.h"
+
+//#define SPARSE_DEBUG
+#ifdef SPARSE_DEBUG
+  #define note(...) printf(__VA_ARGS__), fflush(0);
+#else
+  #define note(...)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+
+// Everything below is written for CSR, in terms of majors (rows) and minors
+// (columns). A CSC matrix is the CSR matrix of its transpose, so the same code
+// works on it with the majors and minors swapped.
+
+#define isFormat(format) \
+  ((format) == ANMAT_SPARSE_CSR || (format) == ANMAT_SPARSE_CSC)
+
+#define majorsOf(format, rows, cols) \
+  ((format) == ANMAT_SPARSE_CSR ? (rows) : (cols))
+#define minorsOf(format, rows, cols) \
+  ((format) == ANMAT_SPARSE_CSR ? (cols) : (rows))
+
+#define majorCount(sparse) majorsOf((sparse)->format, (sparse)->rows, \
+                                    (sparse)->cols)
+#define minorCount(sparse) minorsOf((sparse)->format, (sparse)->rows, \
+                                    (sparse)->cols)
+
+// Allocate the arrays of a sparse matrix, in one allocation that is aligned
+// to ANMAT_DATA_ALIGNMENT: the values come first, then the starts, and then
+// the indices. The values of each array are at least as big as the values
+// of the one after it, so every array starts aligned for its own values.
+static AnmatStatus_t allocArrays(AnmatSparse_t *sparse,
+                                 AnmatSparseFormat_t format,
+                                 unsigned int rows,
+                                 unsigned int cols,
+                                 size_t count)
+{
+  size_t majors = majorsOf(format, rows, cols);
+  char *memory;
+
+  sparse->format = format;
+  sparse->rows = rows;
+  sparse->cols = cols;
+  sparse->count = count;
+  sparse->allocator = anmatAllocatorGet();
+
+  memory = (char *)anmatAllocAligned(sparse->allocator,
+                                     ((count * sizeof(double))
+                                      + ((majors + 1) * sizeof(size_t))
+                                      + (count * sizeof(unsigned int))),
+                                     ANMAT_DATA_ALIGNMENT);
+  if (!memory) {
+    return ANMAT_MEM_ERR;
+  }
+
+  sparse->values = (double *)memory;
+  sparse->starts = (size_t *)(memory + (count * sizeof(double)));
+  sparse->indices = (unsigned int *)(sparse->starts + majors + 1);
+
+  return ANMAT_SUCCESS;
+}
+
+// Turn counts[0] through counts[majors - 1], stored at starts[1] through
+// starts[majors], into starts.
+static void countsToStarts(size_t *starts, unsigned int majors)
+{
+  unsigned int majorI;
+
+  starts[0] = 0;
+  for (majorI = 0; majorI < majors; majorI ++) {
+    starts[majorI + 1] += starts[majorI];
+  }
+}
+
+// Put the transpose of the compressed matrix at (starts, indices, values),
+// with majors majors and minors minors, into (tStarts, tIndices, tValues),
+// which have room for it. The entries of each major of the transpose come
+// out in order of their indices.
+static void transposeArrays(unsigned int majors,
+                            unsigned int minors,
+                            const size_t *starts,
+                            const unsigned int *indices,
+                            const double *values,
+                            size_t *tStarts,
+                            unsigned int *tIndices,
+                            double *tValues)
+{
+  size_t valueI, to;
+  unsigned int majorI;
+
+  memset(tStarts, 0, ((size_t)minors + 1) * sizeof(size_t));
+  for (valueI = 0; valueI < starts[majors]; valueI ++) {
+    tStarts[indices[valueI] + 1] ++;
+  }
+  countsToStarts(tStarts, minors);
+
+  // tStarts[m] moves along as major m of the transpose fills up, so that it
+  // ends up at the start of major m + 1. Shift them back after.
+  for (majorI = 0; majorI < majors; majorI ++) {
+    for (valueI = starts[majorI]; valueI < starts[majorI + 1]; valueI ++) {
+      to = tStarts[indices[valueI]] ++;
+      tIndices[to] = majorI;
+      tValues[to] = values[valueI];
+    }
+  }
+  memmove(tStarts + 1, tStarts, (size_t)minors * sizeof(size_t));
+  tStarts[0] = 0;
+}
+
+static int compareIndices(const void *a, const void *b)
+{
+  unsigned int indexA = *(const unsigned int *)a;
+  unsigned int indexB = *(const unsigned int *)b;
+
+  return (indexA > indexB) - (indexA < indexB);
+}
+
+// -----------------------------------------------------------------------------
+// Memory Management
+
+AnmatStatus_t anmatSparseFromTriplets(AnmatSparse_t *sparse,
+                                      AnmatSparseFormat_t format,
+                                      unsigned int rows,
+                                      unsigned int cols,
+                                      size_t count,
+                                      const unsigned int *rowIs,
+                                      const unsigned int *colIs,
+                                      const double *values)
+{
+  AnmatStatus_t status = ANMAT_MEM_ERR;
+  AnmatArena_t *scratch;
+  AnmatArenaMark_t mark;
+  unsigned int majors, minors, majorI, lastIndex;
+  const unsigned int *majorIs, *minorIs;
+  size_t *tStarts, *starts, valueI, to, merged;
+  unsigned int *tIndices, *indices;
+  double *tValues, *sorted;
+
+  if (!isFormat(format) || !rows || !cols) {
+    return ANMAT_BAD_ARG;
+  }
+  for (valueI = 0; valueI < count; valueI ++) {
+    if (rowIs[valueI] >= rows || colIs[valueI] >= cols) {
+      return ANMAT_BAD_ARG;
+    }
+  }
+
+  majors = majorsOf(format, rows, cols);
+  minors = minorsOf(format, rows, cols);
+  majorIs = (format == ANMAT_SPARSE_CSR ? rowIs : colIs);
+  minorIs = (format == ANMAT_SPARSE_CSR ? colIs : rowIs);
+
+  scratch = anmatArenaScratch();
+  mark = anmatArenaMark(scratch);
+  tStarts = (size_t *)anmatArenaAlloc(scratch,
+                                      ((size_t)minors + 1) * sizeof(size_t));
+  tIndices = (unsigned int *)anmatArenaAlloc(scratch,
+                                             count * sizeof(unsigned int));
+  tValues = (double *)anmatArenaAlloc(scratch, count * sizeof(double));
+  starts = (size_t *)anmatArenaAlloc(scratch,
+                                     ((size_t)majors + 1) * sizeof(size_t));
+  indices = (unsigned int *)anmatArenaAlloc(scratch,
+                                            count * sizeof(unsigned int));
+  sorted = (double *)anmatArenaAlloc(scratch, count * sizeof(double));
+  if (!tStarts || !starts
+      || (count && (!tIndices || !tValues || !indices || !sorted))) {
+    goto done;
+  }
+
+  // Bucket the triplets by minor, which is the transpose, in no particular
+  // order. Transposing that puts them in order within each major.
+  memset(tStarts, 0, ((size_t)minors + 1) * sizeof(size_t));
+  for (valueI = 0; valueI < count; valueI ++) {
+    tStarts[minorIs[valueI] + 1] ++;
+  }
+  countsToStarts(tStarts, minors);
+  for (valueI = 0; valueI < count; valueI ++) {
+    to = tStarts[minorIs[valueI]] ++;
+    tIndices[to] = majorIs[valueI];
+    tValues[to] = values[valueI];
+  }
+  memmove(tStarts + 1, tStarts, (size_t)minors * sizeof(size_t));
+  tStarts[0] = 0;
+
+  transposeArrays(minors, majors, tStarts, tIndices, tValues,
+                  starts, indices, sorted);
+
+  // Add up the values at the same index, now that they are next to each
+  // other. They only move down, so this can be done in place.
+  merged = 0;
+  for (majorI = 0; majorI < majors; majorI ++) {
+    lastIndex = minors;
+    valueI = starts[majorI];
+    starts[majorI] = merged;
+    for (; valueI < starts[majorI + 1]; valueI ++) {
+      if (indices[valueI] == lastIndex) {
+        sorted[merged - 1] += sorted[valueI];
+      } else {
+        lastIndex = indices[valueI];
+        indices[merged] = lastIndex;
+        sorted[merged] = sorted[valueI];
+        merged ++;
+      }
+    }
+  }
+  starts[majors] = merged;
+  note("anmatSparseFromTriplets: merged %zu duplicates\n", count - merged);
+
+  status = allocArrays(sparse, format, rows, cols, merged);
+  if (status == ANMAT_SUCCESS) {
+    memcpy(sparse->starts, starts, ((size_t)majors + 1) * sizeof(size_t));
+  }
+  if (status == ANMAT_SUCCESS && merged) {
+    memcpy(sparse->indices, indices, merged * sizeof(unsigned int));
+    memcpy(sparse->values, sorted, merged * sizeof(double));
+  }
+
+ done:
+  anmatArenaReset(scratch, mark);
+
+  return status;
+}
+
+AnmatStatus_t anmatSparseFromDense(AnmatSparse_t *sparse,
+                                   AnmatSparseFormat_t format,
+                                   AnmatMatrix_t *matrix)
+{
+  AnmatStatus_t status;
+  unsigned int rowI, colI;
+  size_t count = 0, valueI;
+  double *row;
+  AnmatSparse_t csr;
+
+  if (!isFormat(format)) {
+    return ANMAT_BAD_ARG;
+  }
+
+  for (rowI = 0; rowI < matrix->rows; rowI ++) {
+    row = anmatMatrixRow(matrix, rowI);
+    for (colI = 0; colI < matrix->cols; colI ++) {
+      count += (row[colI] != 0);
+    }
+  }
+
+  // Read the matrix row by row into CSR, then transpose it for CSC.
+  status = allocArrays(&csr, ANMAT_SPARSE_CSR,
+                       matrix->rows, matrix->cols, count);
+  if (status != ANMAT_SUCCESS) {
+    return status;
+  }
+  valueI = 0;
+  csr.starts[0] = 0;
+  for (rowI = 0; rowI < matrix->rows; rowI ++) {
+    row = anmatMatrixRow(matrix, rowI);
+    for (colI = 0; colI < matrix->cols; colI ++) {
+      if (row[colI] != 0) {
+        csr.indices[valueI] = colI;
+        csr.values[valueI] = row[colI];
+        valueI ++;
+      }
+    }
+    csr.starts[rowI + 1] = valueI;
+  }
+
+  if (format == ANMAT_SPARSE_CSR) {
+    *sparse = csr;
+    return ANMAT_SUCCESS;
+  }
+
+  status = anmatSparseConvert(&csr, format, sparse);
+  anmatSparseFree(&csr);
+
+  return status;
+}
+
+AnmatStatus_t anmatSparseConvert(AnmatSparse_t *sparse,
+                                 AnmatSparseFormat_t format,
+                                 AnmatSparse_t *converted)
+{
+  AnmatStatus_t status;
+  unsigned int majors = majorCount(sparse);
+
+  if (!isFormat(format)) {
+    return ANMAT_BAD_ARG;
+  }
+
+  status = allocArrays(converted, format,
+                       sparse->rows, sparse->cols, sparse->count);
+  if (status != ANMAT_SUCCESS) {
+    return status;
+  }
+
+  if (format == sparse->format) {
+    memcpy(converted->starts, sparse->starts,
+           ((size_t)majors + 1) * sizeof(size_t));
+    memcpy(converted->indices, sparse->indices,
+           sparse->count * sizeof(unsigned int));
+    memcpy(converted->values, sparse->values,
+           sparse->count * sizeof(double));
+  } else {
+    transposeArrays(majors, minorCount(sparse),
+                    sparse->starts, sparse->indices, sparse->values,
+                    converted->starts, converted->indices, converted->values);
+  }
+
+  return ANMAT_SUCCESS;
+}
+
+void anmatSparseFree(AnmatSparse_t *sparse)
+{
+  if (sparse->values) {
+    anmatFree(sparse->allocator, sparse->values);
+  }
+}
+
+AnmatStatus_t anmatSparseToDense(AnmatSparse_t *sparse,
+                                 AnmatMatrix_t *matrix)
+{
+  unsigned int rowI, majorI;
+  size_t valueI;
+
+  if (matrix->rows != sparse->rows || matrix->cols != sparse->cols) {
+    return ANMAT_BAD_ARG;
+  }
+
+  for (rowI = 0; rowI < matrix->rows; rowI ++) {
+    memset(anmatMatrixRow(matrix, rowI), 0, matrix->cols * sizeof(double));
+  }
+
+  for (majorI = 0; majorI < majorCount(sparse); majorI ++) {
+    for (valueI = sparse->starts[majorI];
+         valueI < sparse->starts[majorI + 1];
+         valueI ++) {
+      if (sparse->format == ANMAT_SPARSE_CSR) {
+        anmatMatrixData(matrix, majorI, sparse->indices[valueI])
+          = sparse->values[valueI];
+      } else {
+        anmatMatrixData(matrix, sparse->indices[valueI], majorI)
+          = sparse->values[valueI];
+      }
+    }
+  }
+
+  return ANMAT_SUCCESS;
+}
+
+// -----------------------------------------------------------------------------
+// Sparse x Dense
+
+// CSR multiplies are split up by rows of the product, which each read one
+// row of the sparse matrix. A CSC multiply by a vector adds each column of
+// the sparse matrix into the whole product, so it stays serial. A CSC
+// multiply by a matrix is split up by columns of the product instead.
+
+typedef struct {
+  AnmatSparse_t *sparse;
+  AnmatVector_t *vectorX, *vectorY;
+  AnmatMatrix_t *matrixB, *matrixC;
+  unsigned int taskCount;
+} DenseJob_t;
+
+static void vectorTask(void *context, unsigned int taskI)
+{
+  DenseJob_t *job = (DenseJob_t *)context;
+  AnmatSparse_t *sparse = job->sparse;
+  unsigned int rowI, start, end;
+  size_t valueI;
+  double total;
+
+  anmatPoolSplit(sparse->rows, 1, taskI, job->taskCount, &start, &end);
+  for (rowI = start; rowI < end; rowI ++) {
+    total = 0;
+    for (valueI = sparse->starts[rowI];
+         valueI < sparse->starts[rowI + 1];
+         valueI ++) {
+      total += (sparse->values[valueI]
+                * job->vectorX->data[sparse->indices[valueI]]);
+    }
+    job->vectorY->data[rowI] = total;
+  }
+}
+
+AnmatStatus_t anmatSparseMultiplyVector(AnmatSparse_t *sparse,
+                                        AnmatVector_t *vectorX,
+                                        AnmatVector_t *vectorY)
+{
+  DenseJob_t job = { sparse, vectorX, vectorY, NULL, NULL, };
+  unsigned int colI;
+  size_t valueI;
+  double x;
+
+  if (vectorX->count != sparse->cols || vectorY->count != sparse->rows) {
+    return ANMAT_BAD_ARG;
+  }
+
+  if (sparse->format == ANMAT_SPARSE_CSR) {
+    job.taskCount = anmatPoolTaskCount(sparse->count);
+    anmatPoolRun(vectorTask, &job, job.taskCount);
+    return ANMAT_SUCCESS;
+  }
+
+  memset(vectorY->data, 0, vectorY->count * sizeof(double));
+  for (colI = 0; colI < sparse->cols; colI ++) {
+    x = vectorX->data[colI];
+    for (valueI = sparse->starts[colI];
+         valueI < sparse->starts[colI + 1];
+         valueI ++) {
+      vectorY->data[sparse->indices[valueI]] += sparse->values[valueI] * x;
+    }
+  }
+
+  return ANMAT_SUCCESS;
+}
+
+// Each nonzero (i, k) of the sparse matrix adds its value times row k of B to
+// row i of C, with the axpby kernel. A CSR task does whole rows of C, and a
+// CSC task does the columns colStart to colEnd of every row of C.
+static void denseTask(void *context, unsigned int taskI)
+{
+  DenseJob_t *job = (DenseJob_t *)context;
+  AnmatSparse_t *sparse = job->sparse;
+  AnmatMatrix_t *matrixB = job->matrixB, *matrixC = job->matrixC;
+  unsigned int majorI, start, end, colStart = 0, colEnd = matrixC->cols;
+  unsigned int rowStart = 0, rowEnd = matrixC->rows, rowI, cols;
+  size_t valueI;
+  double *rowB, *rowC;
+
+  if (sparse->format == ANMAT_SPARSE_CSR) {
+    anmatPoolSplit(matrixC->rows, 1, taskI, job->taskCount, &rowStart, &rowEnd);
+  } else {
+    anmatPoolSplit(matrixC->cols, 8, taskI, job->taskCount, &colStart, &colEnd);
+  }
+  cols = colEnd - colStart;
+  if (!cols || rowStart == rowEnd) {
+    return;
+  }
+
+  for (rowI = rowStart; rowI < rowEnd; rowI ++) {
+    memset(anmatMatrixRow(matrixC, rowI) + colStart, 0, cols * sizeof(double));
+  }
+
+  start = (sparse->format == ANMAT_SPARSE_CSR ? rowStart : 0);
+  end = (sparse->format == ANMAT_SPARSE_CSR ? rowEnd : sparse->cols);
+  for (majorI = start; majorI < end; majorI ++) {
+    for (valueI = sparse->starts[majorI];
+         valueI < sparse->starts[majorI + 1];
+         valueI ++) {
+      if (sparse->format == ANMAT_SPARSE_CSR) {
+        rowB = anmatMatrixRow(matrixB, sparse->indices[valueI]);
+        rowC = anmatMatrixRow(matrixC, majorI);
+      } else {
+        rowB = anmatMatrixRow(matrixB, majorI);
+        rowC = anmatMatrixRow(matrixC, sparse->indices[valueI]);
+      }
+      anmatKernels->axpby(rowB + colStart, sparse->values[valueI],
+                          rowC + colStart, 1,
+                          rowC + colStart, cols);
+    }
+  }
+}
+
+AnmatStatus_t anmatSparseMultiplyDense(AnmatSparse_t *sparse,
+                                       AnmatMatrix_t *matrixB,
+                                       AnmatMatrix_t *matrixC)
+{
+  DenseJob_t job = { sparse, NULL, NULL, matrixB, matrixC, };
+
+  if (matrixB->rows != sparse->cols
+      || matrixC->rows != sparse->rows
+      || matrixC->cols != matrixB->cols) {
+    return ANMAT_BAD_ARG;
+  }
+
+  job.taskCount = anmatPoolTaskCount(sparse->count * matrixB->cols);
+  anmatPoolRun(denseTask, &job, job.taskCount);
+
+  return ANMAT_SUCCESS;
+}
+
+// -----------------------------------------------------------------------------
+// Sparse x Sparse
+
+// Row i of C is the sum of the rows k of B for the nonzeros (i, k) of A, each
+// times the value of A at (i, k) (Gustavson's algorithm). The rows of C are
+// found twice: once to count their nonzeros, so that C can be allocated, and
+// then again to fill them in. Each task keeps a dense row of sums and, for
+// each column, the last row that it showed up in, so a row costs as much as
+// its products and nothing more. Both come from the scratch arena, before
+// the tasks run.
+// For CSC, C' = B' A', and the CSC arrays of a matrix are the CSR arrays of
+// its transpose, so A and B trade places.
+
+typedef struct {
+  AnmatSparse_t *left, *right, *product;
+  unsigned int minors;
+  unsigned int *marks;
+  double *sums;
+  unsigned int taskCount;
+} SparseJob_t;
+
+static void countTask(void *context, unsigned int taskI)
+{
+  SparseJob_t *job = (SparseJob_t *)context;
+  AnmatSparse_t *left = job->left, *right = job->right;
+  unsigned int *marks = job->marks + ((size_t)taskI * job->minors);
+  unsigned int majorI, innerI, index, start, end;
+  size_t valueI, rightI, count;
+
+  anmatPoolSplit(majorCount(left), 1, taskI, job->taskCount, &start, &end);
+  for (majorI = start; majorI < end; majorI ++) {
+    count = 0;
+    for (valueI = left->starts[majorI];
+         valueI < left->starts[majorI + 1];
+         valueI ++) {
+      innerI = left->indices[valueI];
+      for (rightI = right->starts[innerI];
+           rightI < right->starts[innerI + 1];
+           rightI ++) {
+        index = right->indices[rightI];
+        if (marks[index] != majorI + 1) {
+          marks[index] = majorI + 1;
+          count ++;
+        }
+      }
+    }
+    job->product->starts[majorI + 1] = count;
+  }
+}
+
+static void fillTask(void *context, unsigned int taskI)
+{
+  SparseJob_t *job = (SparseJob_t *)context;
+  AnmatSparse_t *left = job->left, *right = job->right;
+  AnmatSparse_t *product = job->product;
+  unsigned int *marks = job->marks + ((size_t)taskI * job->minors);
+  double *sums = job->sums + ((size_t)taskI * job->minors), value;
+  unsigned int majorI, innerI, index, start, end;
+  size_t valueI, rightI, to;
+
+  anmatPoolSplit(majorCount(left), 1, taskI, job->taskCount, &start, &end);
+  for (majorI = start; majorI < end; majorI ++) {
+    to = product->starts[majorI];
+    for (valueI = left->starts[majorI];
+         valueI < left->starts[majorI + 1];
+         valueI ++) {
+      innerI = left->indices[valueI];
+      value = left->values[valueI];
+      for (rightI = right->starts[innerI];
+           rightI < right->starts[innerI + 1];
+           rightI ++) {
+        index = right->indices[rightI];
+        if (marks[index] != majorI + 1) {
+          marks[index] = majorI + 1;
+          sums[index] = value * right->values[rightI];
+          product->indices[to ++] = index;
+        } else {
+          sums[index] += value * right->values[rightI];
+        }
+      }
+    }
+
+    qsort(product->indices + product->starts[majorI],
+          product->starts[majorI + 1] - product->starts[majorI],
+          sizeof(unsigned int),
+          compareIndices);
+    for (to = product->starts[majorI];
+         to < product->starts[majorI + 1];
+         to ++) {
+      product->values[to] = sums[product->indices[to]];
+    }
+  }
+}
+
+AnmatStatus_t anmatSparseMultiply(AnmatSparse_t *sparseA,
+                                  AnmatSparse_t *sparseB,
+                                  AnmatSparse_t *sparseC)
+{
+  AnmatStatus_t status = ANMAT_MEM_ERR;
+  SparseJob_t job;
+  AnmatSparse_t counts;
+  AnmatArena_t *scratch;
+  AnmatArenaMark_t mark;
+  unsigned int majors, majorI;
+  size_t work = 0, valueI, markBytes;
+
+  if (sparseA->format != sparseB->format || sparseA->cols != sparseB->rows) {
+    return ANMAT_BAD_ARG;
+  }
+
+  job.left = (sparseA->format == ANMAT_SPARSE_CSR ? sparseA : sparseB);
+  job.right = (sparseA->format == ANMAT_SPARSE_CSR ? sparseB : sparseA);
+  job.minors = minorCount(job.right);
+  majors = majorCount(job.left);
+
+  // The products, to split up the work.
+  for (valueI = 0; valueI < job.left->count; valueI ++) {
+    majorI = job.left->indices[valueI];
+    work += job.right->starts[majorI + 1] - job.right->starts[majorI];
+  }
+  job.taskCount = anmatPoolTaskCount(work);
+
+  scratch = anmatArenaScratch();
+  mark = anmatArenaMark(scratch);
+  markBytes = (size_t)job.taskCount * job.minors * sizeof(unsigned int);
+  job.marks = (unsigned int *)anmatArenaAlloc(scratch, markBytes);
+  job.sums = (double *)anmatArenaAlloc(scratch,
+                                       ((size_t)job.taskCount * job.minors
+                                        * sizeof(double)));
+  counts.format = sparseA->format;
+  counts.rows = sparseA->rows;
+  counts.cols = sparseB->cols;
+  counts.starts = (size_t *)anmatArenaAlloc(scratch,
+                                            ((size_t)majors + 1)
+                                            * sizeof(size_t));
+  if (!job.marks || !job.sums || !counts.starts) {
+    goto done;
+  }
+
+  // Count, then allocate C.
+  memset(job.marks, 0, markBytes);
+  job.product = &counts;
+  anmatPoolRun(countTask, &job, job.taskCount);
+  countsToStarts(counts.starts, majors);
+  note("anmatSparseMultiply: %zu products, %zu nonzeros\n",
+       work, counts.starts[majors]);
+
+  status = allocArrays(sparseC, counts.format, counts.rows, counts.cols,
+                       counts.starts[majors]);
+  if (status != ANMAT_SUCCESS) {
+    goto done;
+  }
+  memcpy(sparseC->starts, counts.starts,
+         ((size_t)majors + 1) * sizeof(size_t));
+
+  // Fill it in.
+  memset(job.marks, 0, markBytes);
+  job.product = sparseC;
+  anmatPoolRun(fillTask, &job, job.taskCount);
+
+ done:
+  anmatArenaReset(scratch, mark);
+
+  return status;
+}
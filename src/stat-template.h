@@ -0,0 +1,73 @@
+//
+// stat-template.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// The statistics API for one precision.
+//
+// This is included by stat.c once per precision, with the same macros as
+// inc/matrix-template.h.
+//
+
+// -----------------------------------------------------------------------------
+// Memory Management
+
+// Allocate a vector.
+AnmatStatus_t ANMAT_NAME(anmatVectorAlloc)(ANMAT_TYPE(AnmatVector) *vector,
+                                           unsigned int count)
+{
+  return ANMAT_NAME(anmatVectorAllocWith)(vector, count, NULL);
+}
+
+// Allocate a vector from a specific allocator.
+AnmatStatus_t
+ANMAT_NAME(anmatVectorAllocWith)(ANMAT_TYPE(AnmatVector) *vector,
+                                 unsigned int count,
+                                 const AnmatAllocator_t *allocator)
+{
+  AnmatStatus_t status = ANMAT_BAD_ARG;
+
+  if (count) {
+    vector->allocator = (allocator ? allocator : anmatAllocatorGet());
+    vector->data = (ANMAT_VALUE *)anmatAllocAligned(vector->allocator,
+                                                    count * sizeof(ANMAT_VALUE),
+                                                    ANMAT_DATA_ALIGNMENT);
+    status = (vector->data ? ANMAT_SUCCESS : ANMAT_MEM_ERR);
+    vector->count = count;
+  }
+
+  return status;
+}
+
+// Free a vector.
+void ANMAT_NAME(anmatVectorFree)(ANMAT_TYPE(AnmatVector) *vector)
+{
+  if (vector->data) {
+    anmatFree(vector->allocator, vector->data);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Elementary Operations
+
+ANMAT_VALUE ANMAT_NAME(anmatStatAverage)(ANMAT_TYPE(AnmatVector) *vector)
+{
+  return (ANMAT_NAME(anmatKernels)->sum(vector->data, vector->count)
+          / vector->count);
+}
+
+AnmatStatus_t ANMAT_NAME(anmatVectorDot)(ANMAT_TYPE(AnmatVector) *vectorA,
+                                         ANMAT_TYPE(AnmatVector) *vectorB,
+                                         ANMAT_VALUE *dot)
+{
+  if (vectorA->count != vectorB->count) {
+    return ANMAT_BAD_ARG;
+  }
+
+  *dot = ANMAT_NAME(anmatKernels)->dot(vectorA->data, vectorB->data,
+                                        vectorA->count);
+
+  return ANMAT_SUCCESS;
+}
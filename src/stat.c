@@ -9,7 +9,7 @@
 //
 
 #include "stat.h"
-#include "src/heap.h"
+#include "src/kernels.h"
 
 // -----------------------------------------------------------------------------
 // Private Stuff
@@ -18,42 +18,55 @@
   for (valueI = 0; valueI < (vector)->count; valueI ++)
 
 // -----------------------------------------------------------------------------
-// Memory Management
+// Precisions
 
-// Allocate a vector.
-AnmatStatus_t anmatVectorAlloc(AnmatVector_t *vector,
-                                unsigned int count)
-{
-  AnmatStatus_t status = ANMAT_BAD_ARG;
+#define ANMAT_VALUE      double
+#define ANMAT_NAME(name) name
+#define ANMAT_TYPE(name) name ## _t
+#include "src/stat-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_NAME
+#undef ANMAT_TYPE
 
-  if (count) {
-    vector->data = (double *)heapAlloc(count * sizeof(double));
-    status = (vector->data ? ANMAT_SUCCESS : ANMAT_MEM_ERR);
-    vector->count = count;
-  }
+#define ANMAT_VALUE      float
+#define ANMAT_NAME(name) name ## F
+#define ANMAT_TYPE(name) name ## F_t
+#include "src/stat-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_NAME
+#undef ANMAT_TYPE
 
-  return status;
-}
+// -----------------------------------------------------------------------------
+// Conversions
 
-// Free a vector.
-void anmatVectorFree(AnmatVector_t *vector)
+AnmatStatus_t anmatVectorToFloat(AnmatVector_t *vector,
+                                 AnmatVectorF_t *vectorF)
 {
-  if (vector->data) {
-    heapFree(vector->data);
+  unsigned int valueI;
+
+  if (vector->count != vectorF->count) {
+    return ANMAT_BAD_ARG;
   }
-}
 
-// -----------------------------------------------------------------------------
-// Elementary Operations
+  FOR_VALUE(vector, valueI) {
+    vectorF->data[valueI] = (float)vector->data[valueI];
+  }
 
-double anmatStatAverage(AnmatVector_t *vector)
+  return ANMAT_SUCCESS;
+}
+
+AnmatStatus_t anmatVectorToDouble(AnmatVectorF_t *vectorF,
+                                  AnmatVector_t *vector)
 {
-  double total = 0;
   unsigned int valueI;
 
+  if (vectorF->count != vector->count) {
+    return ANMAT_BAD_ARG;
+  }
+
   FOR_VALUE(vector, valueI) {
-    total += vector->data[valueI];
+    vector->data[valueI] = vectorF->data[valueI];
   }
 
-  return (total / vector->count);
+  return ANMAT_SUCCESS;
 }
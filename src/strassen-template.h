@@ -0,0 +1,197 @@
+//
+// strassen-template.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Strassen-Winograd matrix multiply for one precision.
+//
+// This is included by strassen.c once per precision, with the same macros as
+// matrix-template.h.
+//
+
+// -----------------------------------------------------------------------------
+// Blocks
+
+// c = a + (scale * b), for rows x cols blocks. c may be a or b.
+static void ANMAT_NAME(addBlocks)(unsigned int rows,
+                                  unsigned int cols,
+                                  const ANMAT_VALUE *a,
+                                  unsigned int lda,
+                                  const ANMAT_VALUE *b,
+                                  unsigned int ldb,
+                                  ANMAT_VALUE scale,
+                                  ANMAT_VALUE *c,
+                                  unsigned int ldc)
+{
+  unsigned int rowI;
+
+  for (rowI = 0; rowI < rows; rowI ++) {
+    ANMAT_NAME(anmatKernels)->axpby(a + ((size_t)rowI * lda),
+                                    1,
+                                    b + ((size_t)rowI * ldb),
+                                    scale,
+                                    c + ((size_t)rowI * ldc),
+                                    cols);
+  }
+}
+
+// How many values the temporaries of every level take.
+static size_t ANMAT_NAME(scratchCount)(unsigned int crossover,
+                                       unsigned int m,
+                                       unsigned int n,
+                                       unsigned int k)
+{
+  size_t count = 0;
+
+  while (shouldSplit(crossover, m, n, k)) {
+    m /= 2;
+    n /= 2;
+    k /= 2;
+    count += ((size_t)m * ldFor(max(k, n))) + ((size_t)k * ldFor(n));
+  }
+
+  return count;
+}
+
+// -----------------------------------------------------------------------------
+// Recursion
+
+static AnmatStatus_t ANMAT_NAME(multiply)(unsigned int crossover,
+                                          unsigned int m,
+                                          unsigned int n,
+                                          unsigned int k,
+                                          const ANMAT_VALUE *a,
+                                          unsigned int lda,
+                                          const ANMAT_VALUE *b,
+                                          unsigned int ldb,
+                                          ANMAT_VALUE *c,
+                                          unsigned int ldc,
+                                          ANMAT_VALUE *scratch)
+{
+  unsigned int mh = m / 2, nh = n / 2, kh = k / 2;
+  unsigned int ldx = ldFor(max(kh, nh)), ldy = ldFor(nh);
+  const ANMAT_VALUE *a11, *a12, *a21, *a22, *b11, *b12, *b21, *b22;
+  ANMAT_VALUE *c11, *c12, *c21, *c22, *x, *y, *next;
+
+  if (!shouldSplit(crossover, m, n, k)) {
+    return ANMAT_NAME(anmatGemm)(m, n, k, 1, a, lda, b, ldb, 0, c, ldc);
+  }
+
+  note("strassen: %u x %u x %u\n", m, n, k);
+
+  a11 = a;
+  a12 = a + kh;
+  a21 = a + ((size_t)mh * lda);
+  a22 = a21 + kh;
+  b11 = b;
+  b12 = b + nh;
+  b21 = b + ((size_t)kh * ldb);
+  b22 = b21 + nh;
+  c11 = c;
+  c12 = c + nh;
+  c21 = c + ((size_t)mh * ldc);
+  c22 = c21 + nh;
+  x = scratch;
+  y = x + ((size_t)mh * ldx);
+  next = y + ((size_t)kh * ldy);
+
+#define recurse(a, lda, b, ldb, c, ldc)                               \
+  check(ANMAT_NAME(multiply)(crossover, mh, nh, kh, a, lda, b, ldb, c, ldc, \
+                             next))
+
+  ANMAT_NAME(addBlocks)(mh, kh, a11, lda, a21, lda, -1, x, ldx);
+  ANMAT_NAME(addBlocks)(kh, nh, b22, ldb, b12, ldb, -1, y, ldy);
+  recurse(x, ldx, y, ldy, c21, ldc);
+
+  ANMAT_NAME(addBlocks)(mh, kh, a21, lda, a22, lda, 1, x, ldx);
+  ANMAT_NAME(addBlocks)(kh, nh, b12, ldb, b11, ldb, -1, y, ldy);
+  recurse(x, ldx, y, ldy, c22, ldc);
+
+  ANMAT_NAME(addBlocks)(mh, kh, x, ldx, a11, lda, -1, x, ldx);
+  ANMAT_NAME(addBlocks)(kh, nh, b22, ldb, y, ldy, -1, y, ldy);
+  recurse(x, ldx, y, ldy, c12, ldc);
+
+  ANMAT_NAME(addBlocks)(mh, kh, a12, lda, x, ldx, -1, x, ldx);
+  recurse(x, ldx, b22, ldb, c11, ldc);
+
+  recurse(a11, lda, b11, ldb, x, ldx);
+
+  ANMAT_NAME(addBlocks)(mh, nh, x, ldx, c12, ldc, 1, c12, ldc);
+  ANMAT_NAME(addBlocks)(mh, nh, c12, ldc, c21, ldc, 1, c21, ldc);
+  ANMAT_NAME(addBlocks)(mh, nh, c12, ldc, c22, ldc, 1, c12, ldc);
+  ANMAT_NAME(addBlocks)(mh, nh, c21, ldc, c22, ldc, 1, c22, ldc);
+  ANMAT_NAME(addBlocks)(mh, nh, c12, ldc, c11, ldc, 1, c12, ldc);
+
+  ANMAT_NAME(addBlocks)(kh, nh, y, ldy, b21, ldb, -1, y, ldy);
+  recurse(a22, lda, y, ldy, c11, ldc);
+  ANMAT_NAME(addBlocks)(mh, nh, c21, ldc, c11, ldc, -1, c21, ldc);
+
+  recurse(a12, lda, b21, ldb, c11, ldc);
+  ANMAT_NAME(addBlocks)(mh, nh, x, ldx, c11, ldc, 1, c11, ldc);
+
+#undef recurse
+
+  // Peel off the odd ones.
+  if (k & 1) {
+    check(ANMAT_NAME(anmatGemm)(2 * mh, 2 * nh, 1,
+                           1, a + (2 * kh), lda,
+                           b + ((size_t)(2 * kh) * ldb), ldb,
+                           1, c, ldc));
+  }
+  if (n & 1) {
+    check(ANMAT_NAME(anmatGemm)(2 * mh, 1, k,
+                           1, a, lda,
+                           b + (2 * nh), ldb,
+                           0, c + (2 * nh), ldc));
+  }
+  if (m & 1) {
+    check(ANMAT_NAME(anmatGemm)(1, n, k,
+                           1, a + ((size_t)(2 * mh) * lda), lda,
+                           b, ldb,
+                           0, c + ((size_t)(2 * mh) * ldc), ldc));
+  }
+
+  return ANMAT_SUCCESS;
+}
+
+// -----------------------------------------------------------------------------
+// API
+
+AnmatStatus_t ANMAT_NAME(anmatStrassen)(unsigned int crossover,
+                                        unsigned int m,
+                                        unsigned int n,
+                                        unsigned int k,
+                                        const ANMAT_VALUE *a,
+                                        unsigned int lda,
+                                        const ANMAT_VALUE *b,
+                                        unsigned int ldb,
+                                        ANMAT_VALUE *c,
+                                        unsigned int ldc)
+{
+  AnmatArena_t *scratch;
+  AnmatArenaMark_t mark;
+  AnmatStatus_t status;
+  size_t count;
+  ANMAT_VALUE *temporaries = NULL;
+
+  count = ANMAT_NAME(scratchCount)(crossover, m, n, k);
+  scratch = anmatArenaScratch();
+  mark = anmatArenaMark(scratch);
+  if (count) {
+    temporaries = (ANMAT_VALUE *)anmatArenaAlloc(scratch,
+                                                 count * sizeof(ANMAT_VALUE));
+    if (!temporaries) {
+      anmatArenaReset(scratch, mark);
+      return ANMAT_MEM_ERR;
+    }
+  }
+
+  status = ANMAT_NAME(multiply)(crossover, m, n, k, a, lda, b, ldb, c, ldc,
+                                temporaries);
+
+  anmatArenaReset(scratch, mark);
+
+  return status;
+}
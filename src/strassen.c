@@ -0,0 +1,108 @@
+//
+// strassen.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Strassen-Winograd matrix multiply for the anmat library.
+//
+
+#include "strassen.h"
+#include "src/gemm.h"
+#include "src/kernels.h"
+
+//#define STRASSEN_DEBUG
+#ifdef STRASSEN_DEBUG
+  #define note(...) printf(__VA_ARGS__), fflush(0);
+#else
+  #define note(...)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+
+// Each level splits A, B and C into 2 x 2 quadrants and computes C with 7
+// multiplies of quadrants (instead of 8) and 15 additions, in the order from
+// Boyer, Dumas, Pernet and Zhou, "Memory efficient scheduling of
+// Strassen-Winograd's matrix multiplication algorithm" (2009). That order
+// only needs two temporaries, X and Y, next to the quadrants of C:
+//
+//   X = A11 - A21          Y = B22 - B12          C21 = X * Y
+//   X = A21 + A22          Y = B12 - B11          C22 = X * Y
+//   X = X - A11            Y = B22 - Y            C12 = X * Y
+//   X = A12 - X                                   C11 = X * B22
+//   X = A11 * B11
+//   C12 = X + C12          C21 = C12 + C21        C12 = C12 + C22
+//   C22 = C21 + C22        C12 = C12 + C11
+//   Y = Y - B21            C11 = A22 * Y          C21 = C21 - C11
+//   C11 = A12 * B21        C11 = X + C11
+//
+// A row, column or inner dimension that is odd is peeled off and done with
+// gemm (dynamic peeling), so any size works.
+//
+// The temporaries for every level are allocated from the scratch arena once,
+// up front, and each level hands the rest of them down to the next one.
+
+// Temporaries start rows on a 64 byte boundary, like matrices do. This is
+// only used in the template, where ANMAT_VALUE is defined.
+#define roundUp(value, multiple) \
+  ((((value) + (multiple) - 1) / (multiple)) * (multiple))
+#define ldFor(cols) roundUp(cols, ANMAT_DATA_ALIGNMENT / sizeof(ANMAT_VALUE))
+
+#define max(a, b) ((a) > (b) ? (a) : (b))
+
+#define shouldSplit(crossover, m, n, k) \
+  ((m) > (crossover) && (n) > (crossover) && (k) > (crossover))
+
+#define check(call)                             \
+  do {                                          \
+    AnmatStatus_t status_ = (call);             \
+    if (status_ != ANMAT_SUCCESS) {             \
+      return status_;                           \
+    }                                           \
+  } while (0)
+
+// -----------------------------------------------------------------------------
+// Precisions
+
+#define ANMAT_VALUE      double
+#define ANMAT_NAME(name) name
+#define ANMAT_TYPE(name) name ## _t
+#include "src/strassen-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_NAME
+#undef ANMAT_TYPE
+
+#define ANMAT_VALUE      float
+#define ANMAT_NAME(name) name ## F
+#define ANMAT_TYPE(name) name ## F_t
+#include "src/strassen-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_NAME
+#undef ANMAT_TYPE
+
+// -----------------------------------------------------------------------------
+// API
+
+unsigned int anmatStrassenLevels(unsigned int crossover,
+                                 unsigned int m,
+                                 unsigned int n,
+                                 unsigned int k,
+                                 unsigned int *leafK)
+{
+  unsigned int levels = 0;
+
+  while (shouldSplit(crossover, m, n, k)) {
+    m /= 2;
+    n /= 2;
+    k /= 2;
+    levels ++;
+  }
+
+  if (leafK) {
+    *leafK = k;
+  }
+
+  return levels;
+}
@@ -0,0 +1,53 @@
+//
+// strassen.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Strassen-Winograd matrix multiply for the anmat library.
+//
+
+#ifndef __STRASSEN_H__
+#define __STRASSEN_H__
+
+#include "anmat.h"
+
+// Get how many times strassen would split an m x n x k multiply in half
+// before handing the pieces to gemm, and the k of those pieces (if leafK is
+// not NULL). A multiply is only split while m, n and k are all bigger than
+// crossover.
+unsigned int anmatStrassenLevels(unsigned int crossover,
+                                 unsigned int m,
+                                 unsigned int n,
+                                 unsigned int k,
+                                 unsigned int *leafK);
+
+// Compute C = A * B with the Strassen-Winograd recursion, where A is m x k,
+// B is k x n and C is m x n (see gemm.h for the leading dimensions). The
+// recursion stops at crossover (see strassenLevels), and the pieces are
+// multiplied with gemm. C must not overlap A or B.
+// Returns ANMAT_MEM_ERR if there is no room for the temporaries.
+// anmatStrassenF is the same, for floats.
+AnmatStatus_t anmatStrassen(unsigned int crossover,
+                            unsigned int m,
+                            unsigned int n,
+                            unsigned int k,
+                            const double *a,
+                            unsigned int lda,
+                            const double *b,
+                            unsigned int ldb,
+                            double *c,
+                            unsigned int ldc);
+AnmatStatus_t anmatStrassenF(unsigned int crossover,
+                             unsigned int m,
+                             unsigned int n,
+                             unsigned int k,
+                             const float *a,
+                             unsigned int lda,
+                             const float *b,
+                             unsigned int ldb,
+                             float *c,
+                             unsigned int ldc);
+
+#endif /* __STRASSEN_H__ */
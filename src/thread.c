@@ -0,0 +1,248 @@
+//
+// thread.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Thread API.
+//
+
+#include <pthread.h>
+#include <stdlib.h> // getenv(), strtoul()
+#include <unistd.h> // sysconf()
+
+#include "thread.h"
+#include "src/pool.h"
+
+//#define THREAD_DEBUG
+#ifdef THREAD_DEBUG
+  #define note(...) printf(__VA_ARGS__), fflush(0);
+#else
+  #define note(...)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+
+// The workers are started the first time that they are needed, and then wait
+// for jobs until the program exits. The thread that calls anmatPoolRun works on
+// the job too, so there are at most threadCount - 1 workers.
+//
+// Tasks are handed out with an atomic counter. Each job has a generation, so a
+// worker can tell a new job from the one that it just finished.
+
+typedef struct {
+  PoolTask_t task;
+  void *context;
+  unsigned int taskCount;
+
+  // The next task to hand out.
+  unsigned int nextTask;
+
+  // How many of the workers should help. The rest just check in.
+  unsigned int helperCount;
+} PoolJob_t;
+
+static unsigned int threadCount = 1;
+static size_t threshold = ANMAT_THREAD_THRESHOLD_DEFAULT;
+
+// Only one job runs at a time.
+static pthread_mutex_t runLock = PTHREAD_MUTEX_INITIALIZER;
+
+// Protects everything below.
+static pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobReady = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t jobDone = PTHREAD_COND_INITIALIZER;
+
+static PoolJob_t job;
+static unsigned long generation = 0;
+static unsigned int finishedCount = 0;
+
+static pthread_t workers[ANMAT_THREAD_MAX - 1];
+static unsigned long workerGenerations[ANMAT_THREAD_MAX - 1];
+static unsigned int workerCount = 0;
+
+// Whether this thread is a worker, which never starts a job of its own.
+static __thread bool isWorker = false;
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+
+// -----------------------------------------------------------------------------
+// Workers
+
+static void runTasks(void)
+{
+  unsigned int taskI;
+
+  while ((taskI = __atomic_fetch_add(&job.nextTask, 1, __ATOMIC_RELAXED))
+         < job.taskCount) {
+    job.task(job.context, taskI);
+  }
+}
+
+static void *workerLoop(void *argument)
+{
+  unsigned int workerI = (unsigned int)(uintptr_t)argument;
+  unsigned long seen = workerGenerations[workerI];
+  bool helping;
+
+  isWorker = true;
+
+  while (true) {
+    pthread_mutex_lock(&poolLock);
+    while (generation == seen) {
+      pthread_cond_wait(&jobReady, &poolLock);
+    }
+    seen = generation;
+    helping = (workerI < job.helperCount);
+    pthread_mutex_unlock(&poolLock);
+
+    if (helping) {
+      runTasks();
+    }
+
+    pthread_mutex_lock(&poolLock);
+    if (++finishedCount == workerCount) {
+      pthread_cond_signal(&jobDone);
+    }
+    pthread_mutex_unlock(&poolLock);
+  }
+
+  return NULL;
+}
+
+// Start workers until there are count of them (or as many as could be
+// started). Must hold runLock.
+static void startWorkers(unsigned int count)
+{
+  pthread_mutex_lock(&poolLock);
+  while (workerCount < count) {
+    // The worker may not get to run until after the next job has started, so
+    // tell it which generation it was started in.
+    workerGenerations[workerCount] = generation;
+    if (pthread_create(&workers[workerCount],
+                       NULL,
+                       workerLoop,
+                       (void *)(uintptr_t)workerCount)) {
+      note("pool: could not start worker %u\n", workerCount);
+      break;
+    }
+    workerCount ++;
+  }
+  pthread_mutex_unlock(&poolLock);
+}
+
+// -----------------------------------------------------------------------------
+// Pool
+
+unsigned int anmatPoolTaskCount(size_t work)
+{
+  size_t count = work / threshold;
+
+  if (threadCount <= 1 || count <= 1) {
+    return 1;
+  }
+
+  return (unsigned int)min(count, threadCount);
+}
+
+void anmatPoolRun(PoolTask_t task, void *context, unsigned int taskCount)
+{
+  unsigned int taskI, helperCount;
+
+  helperCount = min(taskCount, threadCount) - 1;
+  if (!helperCount || isWorker || pthread_mutex_trylock(&runLock)) {
+    for (taskI = 0; taskI < taskCount; taskI ++) {
+      task(context, taskI);
+    }
+    return;
+  }
+
+  startWorkers(helperCount);
+
+  pthread_mutex_lock(&poolLock);
+  job.task = task;
+  job.context = context;
+  job.taskCount = taskCount;
+  job.nextTask = 0;
+  job.helperCount = helperCount;
+  finishedCount = 0;
+  generation ++;
+  pthread_cond_broadcast(&jobReady);
+  pthread_mutex_unlock(&poolLock);
+
+  note("pool: %u tasks on %u threads\n", taskCount, helperCount + 1);
+
+  runTasks();
+
+  pthread_mutex_lock(&poolLock);
+  while (finishedCount < workerCount) {
+    pthread_cond_wait(&jobDone, &poolLock);
+  }
+  pthread_mutex_unlock(&poolLock);
+
+  pthread_mutex_unlock(&runLock);
+}
+
+void anmatPoolSplit(unsigned int count,
+                    unsigned int multiple,
+                    unsigned int taskI,
+                    unsigned int taskCount,
+                    unsigned int *start,
+                    unsigned int *end)
+{
+  size_t chunks = (count + multiple - 1) / multiple;
+
+  *start = (unsigned int)min((chunks * taskI / taskCount) * multiple, count);
+  *end = (unsigned int)min((chunks * (taskI + 1) / taskCount) * multiple,
+                           count);
+}
+
+// -----------------------------------------------------------------------------
+// API
+
+__attribute__((constructor))
+static void readThreadCount(void)
+{
+  const char *count = getenv("ANMAT_THREADS");
+
+  if (!count
+      || anmatThreadCountSet(strtoul(count, NULL, 10)) != ANMAT_SUCCESS) {
+    anmatThreadCountSet(0);
+  }
+}
+
+AnmatStatus_t anmatThreadCountSet(unsigned int count)
+{
+  long processors;
+
+  if (count > ANMAT_THREAD_MAX) {
+    return ANMAT_BAD_ARG;
+  }
+
+  if (!count) {
+    processors = sysconf(_SC_NPROCESSORS_ONLN);
+    count = (processors < 1 ? 1 : min(processors, ANMAT_THREAD_MAX));
+  }
+
+  threadCount = count;
+  note("thread: using %u threads\n", threadCount);
+
+  return ANMAT_SUCCESS;
+}
+
+unsigned int anmatThreadCountGet(void)
+{
+  return threadCount;
+}
+
+void anmatThreadThresholdSet(size_t work)
+{
+  threshold = (work ? work : ANMAT_THREAD_THRESHOLD_DEFAULT);
+}
+
+size_t anmatThreadThresholdGet(void)
+{
+  return threshold;
+}
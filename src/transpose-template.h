@@ -0,0 +1,147 @@
+//
+// transpose-template.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Matrix transpose for one precision.
+//
+// This is included by transpose.c once per precision, with the same macros as
+// matrix-template.h.
+//
+
+// -----------------------------------------------------------------------------
+// Out of Place
+
+void ANMAT_NAME(anmatTranspose)(const ANMAT_VALUE *a,
+                                unsigned int lda,
+                                ANMAT_VALUE *b,
+                                unsigned int ldb,
+                                unsigned int rows,
+                                unsigned int cols)
+{
+  unsigned int h;
+
+  if (rows <= LEAF && cols <= LEAF) {
+    ANMAT_NAME(anmatKernels)->transpose(a, lda, b, ldb, rows, cols);
+  } else if (rows >= cols) {
+    h = half(rows);
+    ANMAT_NAME(anmatTranspose)(a, lda, b, ldb, h, cols);
+    ANMAT_NAME(anmatTranspose)(a + ((size_t)h * lda), lda, b + h, ldb,
+                               rows - h, cols);
+  } else {
+    h = half(cols);
+    ANMAT_NAME(anmatTranspose)(a, lda, b, ldb, rows, h);
+    ANMAT_NAME(anmatTranspose)(a + h, lda, b + ((size_t)h * ldb), ldb,
+                               rows, cols - h);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Square In Place
+
+// Swap the rows x cols block at x with the transpose of the cols x rows
+// block at y. The blocks must not overlap.
+static void ANMAT_NAME(swapTransposed)(ANMAT_VALUE *x,
+                                       ANMAT_VALUE *y,
+                                       unsigned int ld,
+                                       unsigned int rows,
+                                       unsigned int cols)
+{
+  ANMAT_VALUE leaf[LEAF * LEAF];
+  unsigned int rowI, h;
+
+  if (rows <= LEAF && cols <= LEAF) {
+    ANMAT_NAME(anmatKernels)->transpose(x, ld, leaf, rows, rows, cols);
+    ANMAT_NAME(anmatKernels)->transpose(y, ld, x, ld, cols, rows);
+    for (rowI = 0; rowI < cols; rowI ++) {
+      memcpy(y + ((size_t)rowI * ld), leaf + (rowI * rows),
+             rows * sizeof(ANMAT_VALUE));
+    }
+  } else if (rows >= cols) {
+    h = half(rows);
+    ANMAT_NAME(swapTransposed)(x, y, ld, h, cols);
+    ANMAT_NAME(swapTransposed)(x + ((size_t)h * ld), y + h, ld,
+                               rows - h, cols);
+  } else {
+    h = half(cols);
+    ANMAT_NAME(swapTransposed)(x, y, ld, rows, h);
+    ANMAT_NAME(swapTransposed)(x + h, y + ((size_t)h * ld), ld,
+                               rows, cols - h);
+  }
+}
+
+void ANMAT_NAME(anmatTransposeSquare)(ANMAT_VALUE *a,
+                                      unsigned int lda,
+                                      unsigned int n)
+{
+  ANMAT_VALUE leaf[LEAF * LEAF];
+  unsigned int rowI, h;
+
+  if (n <= LEAF) {
+    ANMAT_NAME(anmatKernels)->transpose(a, lda, leaf, n, n, n);
+    for (rowI = 0; rowI < n; rowI ++) {
+      memcpy(a + ((size_t)rowI * lda), leaf + (rowI * n),
+             n * sizeof(ANMAT_VALUE));
+    }
+  } else {
+    // The two blocks on the diagonal stay where they are, and the other two
+    // trade places.
+    h = half(n);
+    ANMAT_NAME(anmatTransposeSquare)(a, lda, h);
+    ANMAT_NAME(anmatTransposeSquare)(a + ((size_t)h * lda) + h, lda, n - h);
+    ANMAT_NAME(swapTransposed)(a + h, a + ((size_t)h * lda), lda, h, n - h);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Rectangular In Place
+
+AnmatStatus_t ANMAT_NAME(anmatTransposeDense)(ANMAT_VALUE *a,
+                                              unsigned int rows,
+                                              unsigned int cols)
+{
+  AnmatArena_t *scratch;
+  AnmatArenaMark_t mark;
+  size_t count = (size_t)rows * cols, words, start, i;
+  uint64_t *bitmap;
+  ANMAT_VALUE value, displaced;
+
+  if (rows <= 1 || cols <= 1) {
+    return ANMAT_SUCCESS;
+  }
+
+  words = (count + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS;
+  scratch = anmatArenaScratch();
+  mark = anmatArenaMark(scratch);
+  bitmap = (uint64_t *)anmatArenaAlloc(scratch, words * sizeof(uint64_t));
+  if (!bitmap) {
+    anmatArenaReset(scratch, mark);
+    return ANMAT_MEM_ERR;
+  }
+  memset(bitmap, 0, words * sizeof(uint64_t));
+
+  note("transposeDense: %u x %u\n", rows, cols);
+
+  // The first and last values never move.
+  for (start = 1; start < count - 1; start ++) {
+    if (visited(bitmap, start)) {
+      continue;
+    }
+
+    value = a[start];
+    i = start;
+    do {
+      i = ((i % cols) * rows) + (i / cols);
+      displaced = a[i];
+      a[i] = value;
+      value = displaced;
+      visit(bitmap, i);
+    } while (i != start);
+  }
+
+  anmatArenaReset(scratch, mark);
+
+  return ANMAT_SUCCESS;
+}
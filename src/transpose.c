@@ -0,0 +1,70 @@
+//
+// transpose.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Matrix transpose for the anmat library.
+//
+
+#include <string.h> // memcpy()
+
+#include "transpose.h"
+#include "src/kernels.h"
+
+//#define TRANSPOSE_DEBUG
+#ifdef TRANSPOSE_DEBUG
+  #define note(...) printf(__VA_ARGS__), fflush(0);
+#else
+  #define note(...)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+
+// Transposing row by row reads A in order, but every write to B lands on a
+// different row of B. Once B is bigger than the cache, each of those is a
+// miss. Instead, the transposes here are cache oblivious: they split the
+// block in half along its longer side, over and over, until the pieces fit
+// in the L1 cache (whatever size it is), and then hand them to the transpose
+// kernel.
+
+// The biggest piece is LEAF x LEAF: 8 KiB of doubles (4 KiB of floats) from
+// each of A and B.
+#define LEAF (32)
+
+// Split n in half, on a multiple of 16 so that the kernel does whole squares
+// (16 x 16 is the biggest, for floats with AVX-512).
+#define half(n) (((n) / 2) & ~15U)
+
+// The value at index i of a rows x cols matrix (row i / cols, col i % cols)
+// belongs at index ((i % cols) * rows) + (i / cols) of the transpose. Those
+// moves form cycles, and each cycle is followed from its smallest index,
+// carrying one value along. A bitmap remembers which indices have been
+// visited already, so each value is moved exactly once.
+
+#define BITMAP_WORD_BITS (64)
+#define visited(bitmap, i) \
+  ((bitmap)[(i) / BITMAP_WORD_BITS] & (1ULL << ((i) % BITMAP_WORD_BITS)))
+#define visit(bitmap, i) \
+  ((bitmap)[(i) / BITMAP_WORD_BITS] |= (1ULL << ((i) % BITMAP_WORD_BITS)))
+
+// -----------------------------------------------------------------------------
+// Precisions
+
+#define ANMAT_VALUE      double
+#define ANMAT_NAME(name) name
+#define ANMAT_TYPE(name) name ## _t
+#include "src/transpose-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_NAME
+#undef ANMAT_TYPE
+
+#define ANMAT_VALUE      float
+#define ANMAT_NAME(name) name ## F
+#define ANMAT_TYPE(name) name ## F_t
+#include "src/transpose-template.h"
+#undef ANMAT_VALUE
+#undef ANMAT_NAME
+#undef ANMAT_TYPE
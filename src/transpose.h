@@ -0,0 +1,47 @@
+//
+// transpose.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Matrix transpose for the anmat library.
+//
+
+#ifndef __TRANSPOSE_H__
+#define __TRANSPOSE_H__
+
+#include "anmat.h"
+
+// Put the transpose of the rows x cols block at a into b, with lda and ldb
+// doubles from the start of one row to the start of the next (see gemm.h).
+// The blocks must not overlap.
+void anmatTranspose(const double *a,
+                    unsigned int lda,
+                    double *b,
+                    unsigned int ldb,
+                    unsigned int rows,
+                    unsigned int cols);
+
+// Transpose the n x n block at a in place.
+void anmatTransposeSquare(double *a, unsigned int lda, unsigned int n);
+
+// Transpose the rows x cols values at a, stored row after row with no gaps,
+// into cols x rows values stored the same way.
+// Returns ANMAT_MEM_ERR if there is no room for the bookkeeping, which is one
+// bit per value.
+AnmatStatus_t anmatTransposeDense(double *a, unsigned int rows,
+                                  unsigned int cols);
+
+// The same, for floats.
+void anmatTransposeF(const float *a,
+                     unsigned int lda,
+                     float *b,
+                     unsigned int ldb,
+                     unsigned int rows,
+                     unsigned int cols);
+void anmatTransposeSquareF(float *a, unsigned int lda, unsigned int n);
+AnmatStatus_t anmatTransposeDenseF(float *a, unsigned int rows,
+                                   unsigned int cols);
+
+#endif /* __TRANSPOSE_H__ */
@@ -0,0 +1,115 @@
+//
+// trsm.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Triangular solves for the anmat library.
+//
+
+#include "trsm.h"
+#include "src/gemm.h"
+#include "src/kernels.h"
+
+//#define TRSM_DEBUG
+#ifdef TRSM_DEBUG
+  #define note(...) printf(__VA_ARGS__), fflush(0);
+#else
+  #define note(...)
+#endif
+
+// -----------------------------------------------------------------------------
+// Definitions
+
+// T is walked down (or, for an upper T, up) its diagonal in blocks of
+// BLOCK rows. The rows of X for a block are solved by substitution, one
+// row of B at a time, and then taken out of the rest of B with one gemm, so
+// most of the work is a multiply.
+
+#define BLOCK (64)
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+
+#define rowOf(b, ldb, rowI) ((b) + ((size_t)(rowI) * (ldb)))
+
+// Solve the rows start through end - 1 of B by substitution, against only
+// the block of T on the diagonal between them.
+static void solveBlock(bool lower,
+                       bool unit,
+                       unsigned int start,
+                       unsigned int end,
+                       unsigned int nrhs,
+                       const double *t,
+                       unsigned int ldt,
+                       double *b,
+                       unsigned int ldb)
+{
+  unsigned int i, j, rowI;
+  const double *rowT;
+  double *rowB;
+
+  for (i = start; i < end; i ++) {
+    rowI = (lower ? i : start + end - 1 - i);
+    rowT = rowOf(t, ldt, rowI);
+    rowB = rowOf(b, ldb, rowI);
+    if (lower) {
+      for (j = start; j < rowI; j ++) {
+        anmatKernels->axpby(rowOf(b, ldb, j), -rowT[j], rowB, 1, rowB, nrhs);
+      }
+    } else {
+      for (j = rowI + 1; j < end; j ++) {
+        anmatKernels->axpby(rowOf(b, ldb, j), -rowT[j], rowB, 1, rowB, nrhs);
+      }
+    }
+    if (!unit) {
+      anmatKernels->scale(rowB, 1 / rowT[rowI], rowB, nrhs);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// API
+
+AnmatStatus_t anmatTrsm(bool lower,
+                        bool unit,
+                        unsigned int n,
+                        unsigned int nrhs,
+                        const double *t,
+                        unsigned int ldt,
+                        double *b,
+                        unsigned int ldb)
+{
+  AnmatStatus_t status = ANMAT_SUCCESS;
+  unsigned int start, end, size;
+
+  note("trsm: %s %u x %u\n", (lower ? "lower" : "upper"), n, nrhs);
+
+  for (size = 0; size < n && status == ANMAT_SUCCESS; size += end - start) {
+    // The next block, from the top for a lower T, or the bottom for an upper.
+    if (lower) {
+      start = size;
+      end = min(n, start + BLOCK);
+    } else {
+      end = n - size;
+      start = (end > BLOCK ? end - BLOCK : 0);
+    }
+
+    solveBlock(lower, unit, start, end, nrhs, t, ldt, b, ldb);
+
+    // Take the block out of the rows of B that are still to be solved.
+    if (lower && end < n) {
+      status = anmatGemm(n - end, nrhs, end - start,
+                         -1, rowOf(t, ldt, end) + start, ldt,
+                         rowOf(b, ldb, start), ldb,
+                         1, rowOf(b, ldb, end), ldb);
+    } else if (!lower && start > 0) {
+      status = anmatGemm(start, nrhs, end - start,
+                         -1, t + start, ldt,
+                         rowOf(b, ldb, start), ldb,
+                         1, b, ldb);
+    }
+  }
+
+  return status;
+}
@@ -0,0 +1,32 @@
+//
+// trsm.h
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Triangular solves for the anmat library.
+//
+
+#ifndef __TRSM_H__
+#define __TRSM_H__
+
+#include "anmat.h"
+
+// Solve T * X = B for X in place, where T is the n x n lower (or upper)
+// triangle at t, and B is n x nrhs at b (see gemm.h for the leading
+// dimensions). The values of t on the other side of the diagonal are not
+// read. If unit is true, the diagonal of T is taken to be all 1's, and is not
+// read either. B must not overlap T.
+// Returns ANMAT_MEM_ERR if there is no room for the packed panels of the
+// updates (see gemm.c).
+AnmatStatus_t anmatTrsm(bool lower,
+                        bool unit,
+                        unsigned int n,
+                        unsigned int nrhs,
+                        const double *t,
+                        unsigned int ldt,
+                        double *b,
+                        unsigned int ldb);
+
+#endif /* __TRSM_H__ */
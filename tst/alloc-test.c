@@ -0,0 +1,178 @@
+//
+// alloc-test.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Allocator unit test.
+//
+
+#include <unit-test.h>
+#include <stdint.h>   // uintptr_t
+#include <stdlib.h>   // malloc(), posix_memalign(), realloc(), free()
+
+#include "anmat.h"
+
+#include "./test-util.h"
+
+// An allocator that uses libc, and counts what it is asked to do.
+typedef struct {
+  unsigned int allocs, reallocs, frees;
+} Counts_t;
+
+static void *countingAlloc(void *context, size_t size)
+{
+  ((Counts_t *)context)->allocs ++;
+  return malloc(size);
+}
+
+static void *countingAllocAligned(void *context,
+                                  size_t size,
+                                  size_t alignment)
+{
+  void *memory;
+
+  ((Counts_t *)context)->allocs ++;
+  if (alignment < sizeof(void *)) {
+    alignment = sizeof(void *);
+  }
+  return (posix_memalign(&memory, alignment, size) ? NULL : memory);
+}
+
+static void *countingRealloc(void *context, void *memory, size_t size)
+{
+  ((Counts_t *)context)->reallocs ++;
+  return realloc(memory, size);
+}
+
+static void countingFree(void *context, void *memory)
+{
+  ((Counts_t *)context)->frees ++;
+  free(memory);
+}
+
+static Counts_t counts;
+
+static const AnmatAllocator_t countingAllocator = {
+  countingAlloc,
+  countingAllocAligned,
+  countingRealloc,
+  countingFree,
+  &counts,
+};
+
+static int defaultTest(void)
+{
+  AnmatMatrix_t matrix;
+
+  // The heap is the default.
+  expect(anmatAllocatorGet() == &anmatHeapAllocator);
+  expectHeapEmpty();
+  expectEquals(anmatMatrixAlloc(&matrix, 3, 3), ANMAT_SUCCESS);
+  expect(matrix.allocator == &anmatHeapAllocator);
+  expect(heapFreeBytesCount < HEAP_SIZE);
+  anmatMatrixFree(&matrix);
+  expectHeapEmpty();
+
+  return 0;
+}
+
+static int installTest(void)
+{
+  AnmatMatrix_t matrix;
+  AnmatVector_t vector;
+
+  counts = (Counts_t) { 0 };
+
+  // Everything goes to the installed allocator, and not the heap.
+  anmatAllocatorSet(&countingAllocator);
+  expect(anmatAllocatorGet() == &countingAllocator);
+  expectEquals(anmatMatrixAlloc(&matrix, 3, 4), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAlloc(&vector, 10), ANMAT_SUCCESS);
+  expectAligned(anmatMatrixRow(&matrix, 0), ANMAT_DATA_ALIGNMENT);
+  expectAligned(vector.data, ANMAT_DATA_ALIGNMENT);
+  expect(counts.allocs > 0);
+  expectHeapEmpty();
+
+  // Putting the heap back does not change where they get freed.
+  anmatAllocatorSet(NULL);
+  expect(anmatAllocatorGet() == &anmatHeapAllocator);
+  anmatMatrixFree(&matrix);
+  anmatVectorFree(&vector);
+  expectEquals(counts.frees, counts.allocs);
+  expectHeapEmpty();
+
+  return 0;
+}
+
+static int withTest(void)
+{
+  AnmatMatrix_t matrix;
+  AnmatVector_t vector;
+
+  counts = (Counts_t) { 0 };
+
+  // One matrix and one vector from somewhere else.
+  expectEquals(anmatMatrixAllocWith(&matrix, 2, 2, &countingAllocator),
+               ANMAT_SUCCESS);
+  expectEquals(anmatVectorAllocWith(&vector, 4, &countingAllocator),
+               ANMAT_SUCCESS);
+  expect(matrix.allocator == &countingAllocator);
+  expect(counts.allocs > 0);
+  expectHeapEmpty();
+
+  anmatMatrixFree(&matrix);
+  anmatVectorFree(&vector);
+  expectEquals(counts.frees, counts.allocs);
+
+  return 0;
+}
+
+static int scanTest(void)
+{
+  AnmatMatrix_t matrixA, matrixB;
+  unsigned int rowI, colI;
+  FILE *stream;
+
+  counts = (Counts_t) { 0 };
+
+  expectEquals(anmatMatrixAlloc(&matrixA, 4, 4), ANMAT_SUCCESS);
+  for (rowI = 0; rowI < 4; rowI ++) {
+    for (colI = 0; colI < 4; colI ++) {
+      anmatMatrixData(&matrixA, rowI, colI) = rowI * 4 + colI;
+    }
+  }
+  stream = tmpfile();
+  expect(stream != NULL);
+  expectEquals(anmatMatrixPrint(&matrixA, stream), ANMAT_SUCCESS);
+  rewind(stream);
+
+  // The scanner grows its list of values through the allocator too.
+  anmatAllocatorSet(&countingAllocator);
+  expectEquals(anmatMatrixScan(&matrixB, stream), ANMAT_SUCCESS);
+  anmatAllocatorSet(NULL);
+  fclose(stream);
+
+  expect(counts.reallocs > 0);
+  expect(anmatMatrixEquals(&matrixA, &matrixB));
+
+  anmatMatrixFree(&matrixA);
+  anmatMatrixFree(&matrixB);
+  expectEquals(counts.frees, counts.allocs);
+  expectHeapEmpty();
+
+  return 0;
+}
+
+int main(void)
+{
+  announce();
+
+  run(defaultTest);
+  run(installTest);
+  run(withTest);
+  run(scanTest);
+
+  return 0;
+}
@@ -0,0 +1,134 @@
+//
+// arena-test.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Arena unit test.
+//
+
+#include <unit-test.h>
+#include <stdint.h>   // uintptr_t
+
+#include "arena.h"
+
+#include "./test-util.h"
+
+#define CHUNK_SIZE (1 << 12)
+
+#define isAligned(pointer) \
+  (!(((uintptr_t)(pointer)) & (ANMAT_ARENA_ALIGNMENT - 1)))
+
+static int allocTest(void)
+{
+  AnmatArena_t arena;
+  double *pointers[2];
+
+  expectEquals(anmatArenaInit(&arena, CHUNK_SIZE), ANMAT_SUCCESS);
+
+  // Can't allocate 0 bytes!
+  expect(anmatArenaAlloc(&arena, 0) == NULL);
+
+  // Allocations should be aligned and not overlap.
+  pointers[0] = (double *)anmatArenaAlloc(&arena, 3 * sizeof(double));
+  expect(pointers[0] != NULL);
+  expect(isAligned(pointers[0]));
+  pointers[1] = (double *)anmatArenaAlloc(&arena, 5 * sizeof(double));
+  expect(pointers[1] != NULL);
+  expect(isAligned(pointers[1]));
+  expect(pointers[1] >= pointers[0] + 3);
+  pointers[0][2] = 1.5;
+  pointers[1][0] = 2.5;
+  expectEquals(pointers[0][2], 1.5);
+  expectEquals(pointers[1][0], 2.5);
+
+  // Something bigger than a chunk should still fit.
+  pointers[0] = (double *)anmatArenaAlloc(&arena, CHUNK_SIZE * 4);
+  expect(pointers[0] != NULL);
+  pointers[0][0] = 1;
+  pointers[0][((CHUNK_SIZE * 4) / sizeof(double)) - 1] = 2;
+
+  // None of that should have come from the heap.
+  expectHeapEmpty();
+
+  anmatArenaFree(&arena);
+
+  return 0;
+}
+
+static int scopeTest(void)
+{
+  AnmatArena_t arena;
+  AnmatArenaMark_t outer, inner;
+  unsigned char *pointers[3];
+  unsigned int i;
+
+  expectEquals(anmatArenaInit(&arena, CHUNK_SIZE), ANMAT_SUCCESS);
+
+  // Resetting to a mark taken before anything was allocated gives everything
+  // back.
+  outer = anmatArenaMark(&arena);
+  pointers[0] = (unsigned char *)anmatArenaAlloc(&arena, 10);
+  expect(pointers[0] != NULL);
+  anmatArenaReset(&arena, outer);
+  expect(anmatArenaAlloc(&arena, 10) == pointers[0]);
+
+  // Nested scopes.
+  inner = anmatArenaMark(&arena);
+  pointers[1] = (unsigned char *)anmatArenaAlloc(&arena, 100);
+  expect(pointers[1] != NULL);
+  anmatArenaReset(&arena, inner);
+  pointers[2] = (unsigned char *)anmatArenaAlloc(&arena, 100);
+  expect(pointers[2] == pointers[1]);
+  anmatArenaReset(&arena, outer);
+
+  // Resetting across chunks should reuse the chunks that were already mapped.
+  for (i = 0; i < 16; i ++) {
+    expect(anmatArenaAlloc(&arena, CHUNK_SIZE / 2) != NULL);
+  }
+  pointers[1] = (unsigned char *)anmatArenaAlloc(&arena, 1);
+  anmatArenaReset(&arena, outer);
+  for (i = 0; i < 16; i ++) {
+    expect(anmatArenaAlloc(&arena, CHUNK_SIZE / 2) != NULL);
+  }
+  pointers[2] = (unsigned char *)anmatArenaAlloc(&arena, 1);
+  expect(pointers[2] == pointers[1]);
+
+  anmatArenaFree(&arena);
+
+  return 0;
+}
+
+static int scratchTest(void)
+{
+  AnmatArena_t *scratch = anmatArenaScratch();
+  AnmatArenaMark_t mark;
+  void *pointer;
+
+  // There is only one scratch arena.
+  expect(scratch != NULL);
+  expect(anmatArenaScratch() == scratch);
+
+  mark = anmatArenaMark(scratch);
+  pointer = anmatArenaAlloc(scratch, 123);
+  expect(pointer != NULL);
+  anmatArenaReset(scratch, mark);
+  expect(anmatArenaAlloc(scratch, 123) == pointer);
+  anmatArenaReset(scratch, mark);
+
+  expectHeapEmpty();
+
+  return 0;
+}
+
+int main(void)
+{
+  announce();
+
+  run(allocTest);
+  run(scopeTest);
+  run(scratchTest);
+
+  return 0;
+}
@@ -0,0 +1,203 @@
+//
+// batch-test.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Batch unit test.
+//
+
+#include <unit-test.h>
+#include <stdlib.h>   // srand(), malloc(), free()
+
+#include "batch.h"
+#include "simd.h"
+#include "thread.h"
+
+#include "./test-util.h"
+
+// Where value v of problem p is, in a batch of count problems with values
+// values each.
+static size_t indexOf(AnmatBatchLayout_t layout,
+                      unsigned int count,
+                      unsigned int values,
+                      unsigned int p,
+                      unsigned int v)
+{
+  return (layout == ANMAT_BATCH_AOS
+          ? ((size_t)p * values) + v
+          : ((size_t)v * count) + p);
+}
+
+// Multiply a batch, and check every product against the one from the
+// textbook loop.
+static int check(AnmatBatchLayout_t layout,
+                 unsigned int count,
+                 unsigned int m,
+                 unsigned int n,
+                 unsigned int k)
+{
+  size_t aCount = (size_t)count * m * k, bCount = (size_t)count * k * n;
+  size_t cCount = (size_t)count * m * n;
+  double *a = (double *)malloc(aCount * sizeof(double));
+  double *b = (double *)malloc(bCount * sizeof(double));
+  double *c = (double *)malloc(cCount * sizeof(double));
+  double expected;
+  unsigned int p, i, j, l;
+
+  expect(a && b && c);
+  randomValues(a, aCount);
+  randomValues(b, bCount);
+  randomValues(c, cCount);
+
+  expectEquals(anmatBatchMultiply(layout, count, m, n, k, a, b, c),
+               ANMAT_SUCCESS);
+
+  for (p = 0; p < count; p ++) {
+    for (i = 0; i < m; i ++) {
+      for (j = 0; j < n; j ++) {
+        expected = 0;
+        for (l = 0; l < k; l ++) {
+          expected += (a[indexOf(layout, count, m * k, p, (i * k) + l)]
+                       * b[indexOf(layout, count, k * n, p, (l * n) + j)]);
+        }
+        expectNeighborhood(c[indexOf(layout, count, m * n, p, (i * n) + j)],
+                           expected,
+                           1e-9);
+      }
+    }
+  }
+
+  free(a);
+  free(b);
+  free(c);
+
+  return 0;
+}
+
+static int badArgTest(void)
+{
+  double a[4] = { 1, 2, 3, 4, }, b[4] = { 5, 6, 7, 8, }, c[8] = { 0, };
+
+  expectEquals(anmatBatchMultiply((AnmatBatchLayout_t)2, 1, 2, 2, 1, a, b, c),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatBatchMultiply(ANMAT_BATCH_AOS, 1, 0, 2, 1, a, b, c),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatBatchMultiply(ANMAT_BATCH_SOA, 1, 2, 0, 1, a, b, c),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatBatchMultiply(ANMAT_BATCH_SOA, 1, 2, 2, 0, a, b, c),
+               ANMAT_BAD_ARG);
+
+  // Nothing to do.
+  expectEquals(anmatBatchMultiply(ANMAT_BATCH_AOS, 0, 2, 2, 1, a, b, c),
+               ANMAT_SUCCESS);
+  expectEquals(c[0], 0);
+
+  return 0;
+}
+
+static int layoutTest(void)
+{
+  double a[4] = { 1, 2, 3, 4, }, b[4] = { 5, 6, 7, 8, }, c[8];
+
+  // Two 2 x 1 by 1 x 2 problems, problem by problem: [1; 2] * [5 6] and
+  // [3; 4] * [7 8].
+  expectEquals(anmatBatchMultiply(ANMAT_BATCH_AOS, 2, 2, 2, 1, a, b, c),
+               ANMAT_SUCCESS);
+  expectEquals(c[0], 5);
+  expectEquals(c[3], 12);
+  expectEquals(c[4], 21);
+  expectEquals(c[7], 32);
+
+  // Value by value: [1; 3] * [5 7] and [2; 4] * [6 8].
+  expectEquals(anmatBatchMultiply(ANMAT_BATCH_SOA, 2, 2, 2, 1, a, b, c),
+               ANMAT_SUCCESS);
+  expectEquals(c[0], 5);
+  expectEquals(c[1], 12);
+  expectEquals(c[2], 7);
+  expectEquals(c[7], 32);
+
+  return 0;
+}
+
+// Every size that has its own kernel, and some that do not, with problems
+// left over after the vectors and after the chunks (see batch.c).
+static const unsigned int sizes[][3] = {
+  { 2, 2, 2, }, { 3, 3, 3, }, { 4, 4, 4, }, { 8, 8, 8, },
+  { 1, 1, 1, }, { 5, 5, 5, }, { 3, 1, 3, }, { 4, 4, 1, }, { 2, 7, 3, },
+};
+#define SIZE_COUNT (sizeof(sizes) / sizeof(sizes[0]))
+
+static const unsigned int counts[] = { 1, 7, 8, 13, 64, 100, };
+#define COUNT_COUNT (sizeof(counts) / sizeof(counts[0]))
+
+static int multiplyTest(void)
+{
+  AnmatBatchLayout_t layout;
+  AnmatSimdLevel_t level, original = anmatSimdLevelGet();
+  unsigned int sizeI, countI;
+
+  srand(1);
+
+  for (level = ANMAT_SIMD_PORTABLE; anmatSimdLevelName(level); level ++) {
+    if (anmatSimdLevelSet(level) != ANMAT_SUCCESS) {
+      continue;
+    }
+    for (layout = ANMAT_BATCH_AOS; layout <= ANMAT_BATCH_SOA; layout ++) {
+      for (sizeI = 0; sizeI < SIZE_COUNT; sizeI ++) {
+        for (countI = 0; countI < COUNT_COUNT; countI ++) {
+          expect(!check(layout, counts[countI],
+                        sizes[sizeI][0], sizes[sizeI][1], sizes[sizeI][2]));
+        }
+      }
+    }
+  }
+
+  expectEquals(anmatSimdLevelSet(original), ANMAT_SUCCESS);
+
+  return 0;
+}
+
+static int bigTest(void)
+{
+  srand(2);
+
+  // Too big to chunk, so each one goes to gemm.
+  expect(!check(ANMAT_BATCH_AOS, 3, 40, 30, 20));
+  expect(!check(ANMAT_BATCH_SOA, 3, 40, 30, 20));
+
+  return 0;
+}
+
+static int threadTest(void)
+{
+  srand(3);
+
+  // Split every batch up.
+  anmatThreadCountSet(3);
+  anmatThreadThresholdSet(1);
+
+  expect(!check(ANMAT_BATCH_AOS, 1000, 4, 4, 4));
+  expect(!check(ANMAT_BATCH_SOA, 1000, 4, 4, 4));
+  expect(!check(ANMAT_BATCH_AOS, 77, 3, 2, 5));
+  expect(!check(ANMAT_BATCH_SOA, 77, 3, 2, 5));
+
+  anmatThreadThresholdSet(0);
+  anmatThreadCountSet(0);
+
+  return 0;
+}
+
+int main(void)
+{
+  announce();
+
+  run(badArgTest);
+  run(layoutTest);
+  run(multiplyTest);
+  run(bigTest);
+  run(threadTest);
+
+  return 0;
+}
@@ -0,0 +1,332 @@
+//
+// cholesky-test.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Cholesky unit test.
+//
+
+#include <unit-test.h>
+#include <math.h>     // log()
+#include <stdlib.h>   // srand()
+#include <string.h>   // memcmp()
+
+#include "cholesky.h"
+#include "matrix.h"
+#include "stat.h"
+#include "thread.h"
+
+#include "./test-util.h"
+
+// A random n x n symmetric positive definite matrix: M * M' + n * I. The
+// values above the diagonal are garbage, since they should not be read.
+static int fill(AnmatMatrix_t *matrix, unsigned int n)
+{
+  AnmatMatrix_t matrixM, matrixMT;
+  unsigned int rowI, colI;
+
+  expectEquals(anmatMatrixAlloc(&matrixM, n, n), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&matrixMT, n, n), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(matrix, n, n), ANMAT_SUCCESS);
+  for (rowI = 0; rowI < n; rowI ++) {
+    for (colI = 0; colI < n; colI ++) {
+      anmatMatrixData(&matrixM, rowI, colI) = randomValue() / n;
+    }
+  }
+  expectEquals(anmatMatrixTranspose(&matrixM, &matrixMT), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixMultiply(&matrixM, &matrixMT, matrix),
+               ANMAT_SUCCESS);
+  for (rowI = 0; rowI < n; rowI ++) {
+    anmatMatrixData(matrix, rowI, rowI) += 1;
+    for (colI = rowI + 1; colI < n; colI ++) {
+      anmatMatrixData(matrix, rowI, colI) = 1e300;
+    }
+  }
+
+  anmatMatrixFree(&matrixM);
+  anmatMatrixFree(&matrixMT);
+
+  return 0;
+}
+
+// Get the value of the n x n matrix at row i and column j from its lower
+// triangle.
+#define lowerData(matrix, i, j) \
+  ((j) <= (i) ? anmatMatrixData(matrix, i, j) : anmatMatrixData(matrix, j, i))
+
+// Check that L * L' is the matrix.
+static int checkFactor(AnmatCholesky_t *cholesky, AnmatMatrix_t *matrix)
+{
+  unsigned int n = cholesky->n, i, j, k;
+  double total;
+
+  for (i = 0; i < n; i ++) {
+    if (i > 0) {
+      expect(anmatCholeskyRow(cholesky, i)
+             >= anmatCholeskyRow(cholesky, i - 1) + i);
+    }
+    for (j = 0; j <= i; j ++) {
+      total = 0;
+      for (k = 0; k <= j; k ++) {
+        total += (anmatCholeskyData(cholesky, i, k)
+                  * anmatCholeskyData(cholesky, j, k));
+      }
+      expectNeighborhood(total, anmatMatrixData(matrix, i, j), 1e-9);
+    }
+  }
+
+  return 0;
+}
+
+static int badArgTest(void)
+{
+  AnmatMatrix_t matrix, other;
+  AnmatVector_t vector;
+  AnmatCholesky_t cholesky;
+
+  expectEquals(anmatMatrixAlloc(&matrix, 2, 3), ANMAT_SUCCESS);
+  expectEquals(anmatCholeskyFactor(&cholesky, &matrix), ANMAT_BAD_ARG);
+  anmatMatrixFree(&matrix);
+
+  // Symmetric, but not positive definite.
+  expectEquals(anmatMatrixAlloc(&matrix, 2, 2), ANMAT_SUCCESS);
+  anmatMatrixData(&matrix, 0, 0) = 1;
+  anmatMatrixData(&matrix, 1, 0) = 2;
+  anmatMatrixData(&matrix, 1, 1) = 1;
+  expectEquals(anmatCholeskyFactor(&cholesky, &matrix), ANMAT_BAD_ARG);
+
+  anmatMatrixData(&matrix, 1, 1) = 5;
+  expectEquals(anmatCholeskyFactor(&cholesky, &matrix), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&other, 3, 2), ANMAT_SUCCESS);
+  expectEquals(anmatCholeskySolve(&cholesky, &other, &other), ANMAT_BAD_ARG);
+  expectEquals(anmatCholeskySolve(&cholesky, &matrix, &other),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatVectorAlloc(&vector, 3), ANMAT_SUCCESS);
+  expectEquals(anmatCholeskySolveVector(&cholesky, &vector, &vector),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatCholeskyUpdate(&cholesky, &vector), ANMAT_BAD_ARG);
+  expectEquals(anmatCholeskyDowndate(&cholesky, &vector), ANMAT_BAD_ARG);
+  anmatCholeskyFree(&cholesky);
+
+  anmatMatrixFree(&matrix);
+  anmatMatrixFree(&other);
+  anmatVectorFree(&vector);
+
+  return 0;
+}
+
+static int factorTest(void)
+{
+  static const unsigned int sizes[] = { 1, 2, 63, 64, 65, 150, };
+  AnmatCholesky_t cholesky;
+  AnmatMatrix_t matrix;
+  unsigned int sizeI;
+
+  srand(1);
+
+  for (sizeI = 0; sizeI < sizeof(sizes) / sizeof(sizes[0]); sizeI ++) {
+    expect(!fill(&matrix, sizes[sizeI]));
+    expectEquals(anmatCholeskyFactor(&cholesky, &matrix), ANMAT_SUCCESS);
+    expectEquals(cholesky.n, sizes[sizeI]);
+    expect(!checkFactor(&cholesky, &matrix));
+    anmatCholeskyFree(&cholesky);
+    anmatMatrixFree(&matrix);
+  }
+
+  return 0;
+}
+
+static int solveTest(void)
+{
+  AnmatMatrix_t matrixA, matrixB, matrixX;
+  AnmatVector_t vectorB, vectorX;
+  AnmatCholesky_t cholesky;
+  unsigned int n = 200, nrhs = 9, i, j, k;
+  double total;
+
+  srand(2);
+
+  expect(!fill(&matrixA, n));
+  expectEquals(anmatMatrixAlloc(&matrixB, n, nrhs), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&matrixX, n, nrhs), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAlloc(&vectorB, n), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAlloc(&vectorX, n), ANMAT_SUCCESS);
+  for (i = 0; i < n; i ++) {
+    for (j = 0; j < nrhs; j ++) {
+      anmatMatrixData(&matrixB, i, j) = randomValue();
+    }
+    anmatVectorData(&vectorB, i) = anmatMatrixData(&matrixB, i, 0);
+  }
+
+  expectEquals(anmatCholeskyFactor(&cholesky, &matrixA), ANMAT_SUCCESS);
+  expectEquals(anmatCholeskySolve(&cholesky, &matrixB, &matrixX),
+               ANMAT_SUCCESS);
+  for (i = 0; i < n; i ++) {
+    for (j = 0; j < nrhs; j ++) {
+      total = 0;
+      for (k = 0; k < n; k ++) {
+        total += lowerData(&matrixA, i, k) * anmatMatrixData(&matrixX, k, j);
+      }
+      expectNeighborhood(total, anmatMatrixData(&matrixB, i, j), 1e-9);
+    }
+  }
+
+  expectEquals(anmatCholeskySolveVector(&cholesky, &vectorB, &vectorX),
+               ANMAT_SUCCESS);
+  for (i = 0; i < n; i ++) {
+    expectNeighborhood(anmatVectorData(&vectorX, i),
+                       anmatMatrixData(&matrixX, i, 0),
+                       1e-12);
+  }
+
+  // In place.
+  expectEquals(anmatCholeskySolve(&cholesky, &matrixB, &matrixB),
+               ANMAT_SUCCESS);
+  expect(anmatMatrixEquals(&matrixB, &matrixX));
+
+  anmatCholeskyFree(&cholesky);
+  anmatMatrixFree(&matrixA);
+  anmatMatrixFree(&matrixB);
+  anmatMatrixFree(&matrixX);
+  anmatVectorFree(&vectorB);
+  anmatVectorFree(&vectorX);
+
+  return 0;
+}
+
+static int logDeterminantTest(void)
+{
+  AnmatCholesky_t cholesky;
+  AnmatMatrix_t matrix;
+  unsigned int n = 400, i;
+
+  expectEquals(anmatMatrixAlloc(&matrix, 3, 3), ANMAT_SUCCESS);
+  anmatMatrixData(&matrix, 0, 0) = 4;
+  anmatMatrixData(&matrix, 1, 0) = 2;
+  anmatMatrixData(&matrix, 1, 1) = 5;
+  anmatMatrixData(&matrix, 2, 2) = 3;
+  expectEquals(anmatCholeskyFactor(&cholesky, &matrix), ANMAT_SUCCESS);
+  expectNeighborhood(anmatCholeskyLogDeterminant(&cholesky), log(48),
+                     1e-12);
+  anmatCholeskyFree(&cholesky);
+  anmatMatrixFree(&matrix);
+
+  // The determinant is 10^400, which is too big for a double.
+  expectEquals(anmatMatrixAlloc(&matrix, n, n), ANMAT_SUCCESS);
+  for (i = 0; i < n; i ++) {
+    anmatMatrixData(&matrix, i, i) = 10;
+  }
+  expectEquals(anmatCholeskyFactor(&cholesky, &matrix), ANMAT_SUCCESS);
+  expectNeighborhood(anmatCholeskyLogDeterminant(&cholesky), n * log(10),
+                     1e-9);
+  anmatCholeskyFree(&cholesky);
+  anmatMatrixFree(&matrix);
+
+  return 0;
+}
+
+static int updateTest(void)
+{
+  AnmatCholesky_t cholesky, updated;
+  AnmatMatrix_t matrix;
+  AnmatVector_t vector;
+  unsigned int n = 100, i, j;
+  double *before;
+  size_t bytes;
+
+  srand(3);
+
+  expect(!fill(&matrix, n));
+  expectEquals(anmatVectorAlloc(&vector, n), ANMAT_SUCCESS);
+  for (i = 0; i < n; i ++) {
+    anmatVectorData(&vector, i) = randomValue() / 10;
+  }
+  expectEquals(anmatCholeskyFactor(&cholesky, &matrix), ANMAT_SUCCESS);
+
+  // Updating is the same as factoring A + x * x'.
+  expectEquals(anmatCholeskyUpdate(&cholesky, &vector), ANMAT_SUCCESS);
+  for (i = 0; i < n; i ++) {
+    for (j = 0; j <= i; j ++) {
+      anmatMatrixData(&matrix, i, j)
+        += anmatVectorData(&vector, i) * anmatVectorData(&vector, j);
+    }
+  }
+  expect(!checkFactor(&cholesky, &matrix));
+  expectEquals(anmatCholeskyFactor(&updated, &matrix), ANMAT_SUCCESS);
+  for (i = 0; i < n; i ++) {
+    for (j = 0; j <= i; j ++) {
+      expectNeighborhood(anmatCholeskyData(&cholesky, i, j),
+                         anmatCholeskyData(&updated, i, j),
+                         1e-9);
+    }
+  }
+  anmatCholeskyFree(&updated);
+
+  // Downdating takes it back out.
+  expectEquals(anmatCholeskyDowndate(&cholesky, &vector), ANMAT_SUCCESS);
+  for (i = 0; i < n; i ++) {
+    for (j = 0; j <= i; j ++) {
+      anmatMatrixData(&matrix, i, j)
+        -= anmatVectorData(&vector, i) * anmatVectorData(&vector, j);
+    }
+  }
+  expect(!checkFactor(&cholesky, &matrix));
+
+  // Taking too much out would not leave A positive definite, so nothing
+  // changes.
+  bytes = (size_t)(anmatCholeskyRow(&cholesky, n - 1) + n - cholesky.data)
+          * sizeof(double);
+  before = (double *)malloc(bytes);
+  memcpy(before, cholesky.data, bytes);
+  for (i = 0; i < n; i ++) {
+    anmatVectorData(&vector, i) = 100;
+  }
+  expectEquals(anmatCholeskyDowndate(&cholesky, &vector), ANMAT_BAD_ARG);
+  expect(!memcmp(before, cholesky.data, bytes));
+  free(before);
+
+  anmatCholeskyFree(&cholesky);
+  anmatMatrixFree(&matrix);
+  anmatVectorFree(&vector);
+
+  return 0;
+}
+
+static int threadTest(void)
+{
+  AnmatCholesky_t cholesky;
+  AnmatMatrix_t matrix;
+
+  srand(4);
+
+  // Split every multiply up.
+  anmatThreadCountSet(3);
+  anmatThreadThresholdSet(1);
+
+  expect(!fill(&matrix, 300));
+  expectEquals(anmatCholeskyFactor(&cholesky, &matrix), ANMAT_SUCCESS);
+  expect(!checkFactor(&cholesky, &matrix));
+  anmatCholeskyFree(&cholesky);
+  anmatMatrixFree(&matrix);
+
+  anmatThreadThresholdSet(0);
+  anmatThreadCountSet(0);
+
+  return 0;
+}
+
+int main(void)
+{
+  announce();
+
+  run(badArgTest);
+  run(factorTest);
+  run(solveTest);
+  run(logDeterminantTest);
+  run(updateTest);
+  run(threadTest);
+
+  return 0;
+}
@@ -0,0 +1,495 @@
+//
+// float-test.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Single precision unit test.
+//
+
+#include <unit-test.h>
+#include <float.h>    // FLT_EPSILON
+#include <stdlib.h>   // srand()
+
+#include "matrix.h"
+#include "stat.h"
+#include "batch.h"
+#include "simd.h"
+
+#include "./test-util.h"
+
+// Each float op is checked against the same double op, on the same values
+// (converted to floats first, so both start out the same). The float answer
+// only has to be as close as float roundoff allows.
+#define FLOAT_EPSILON(magnitude) (8 * FLT_EPSILON * (magnitude))
+
+// Fill matrix with random values that floats hold exactly, and copy them into
+// matrixF.
+static int fill(AnmatMatrix_t *matrix, AnmatMatrixF_t *matrixF)
+{
+  unsigned int rowI, colI;
+
+  for (rowI = 0; rowI < anmatMatrixRowCount(matrix); rowI ++) {
+    for (colI = 0; colI < anmatMatrixColCount(matrix); colI ++) {
+      anmatMatrixData(matrix, rowI, colI) = (float)randomValue();
+    }
+  }
+  expectEquals(anmatMatrixToFloat(matrix, matrixF), ANMAT_SUCCESS);
+
+  return 0;
+}
+
+// Check that matrixF is within epsilon of matrix, value by value.
+static int near(AnmatMatrixF_t *matrixF,
+                AnmatMatrix_t *matrix,
+                double epsilon)
+{
+  unsigned int rowI, colI;
+
+  expectEquals(anmatMatrixRowCount(matrixF), anmatMatrixRowCount(matrix));
+  expectEquals(anmatMatrixColCount(matrixF), anmatMatrixColCount(matrix));
+  for (rowI = 0; rowI < anmatMatrixRowCount(matrix); rowI ++) {
+    for (colI = 0; colI < anmatMatrixColCount(matrix); colI ++) {
+      expectNeighborhood(anmatMatrixData(matrixF, rowI, colI),
+                         anmatMatrixData(matrix, rowI, colI),
+                         epsilon);
+    }
+  }
+
+  return 0;
+}
+
+static int allocTest(void)
+{
+  AnmatMatrixF_t matrix, view;
+  AnmatVectorF_t vector;
+
+  // Heap should be fresh.
+  expectHeapEmpty();
+
+  expectEquals(anmatMatrixAllocF(&matrix, 0, 1), ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixAllocF(&matrix, 5, 5), ANMAT_SUCCESS);
+
+  // The data is aligned, and rows shorter than the alignment are not padded.
+  expectAligned(anmatMatrixRow(&matrix, 0), ANMAT_DATA_ALIGNMENT);
+  expectEquals(matrix.stride, 5);
+  expectHeapSize(HEAP_SIZE
+                 // 5 rows, with 1 alloc byte
+                 - (5 * matrix.stride * sizeof(float)) - 1
+                 - 0);
+  expectEquals(anmatMatrixData(&matrix, 4, 4), 0);
+
+  // Views and the range macros work the same way.
+  expectEquals(anmatMatrixRowRangeF(&view, &matrix, 1, 5), ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixColRangeF(&view, &matrix, 3, 2), ANMAT_SUCCESS);
+  anmatMatrixData(&view, 4, 1) = 1.5f;
+  expectEquals(anmatMatrixData(&matrix, 4, 4), 1.5f);
+  anmatMatrixFreeF(&view);
+
+  anmatMatrixFreeF(&matrix);
+
+  expectEquals(anmatVectorAllocF(&vector, 5), ANMAT_SUCCESS);
+  expectAligned(vector.data, ANMAT_DATA_ALIGNMENT);
+  anmatVectorFreeF(&vector);
+
+  // Heap should be full.
+  expectHeapEmpty();
+
+  return 0;
+}
+
+static int convertTest(void)
+{
+  AnmatMatrix_t matrix, other;
+  AnmatMatrixF_t matrixF;
+
+  expectEquals(anmatMatrixAlloc(&matrix, 2, 3), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&other, 3, 2), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAllocF(&matrixF, 2, 3), ANMAT_SUCCESS);
+
+  // The dimensions have to match.
+  expectEquals(anmatMatrixToFloat(&other, &matrixF), ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixToDouble(&matrixF, &other), ANMAT_BAD_ARG);
+
+  // Values are rounded to the nearest float, and come back the same.
+  anmatMatrixData(&matrix, 0, 0) = 0.5;
+  anmatMatrixData(&matrix, 0, 1) = 0.1;
+  anmatMatrixData(&matrix, 1, 2) = -3e10;
+  expectEquals(anmatMatrixToFloat(&matrix, &matrixF), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixData(&matrixF, 0, 0), 0.5f);
+  expectEquals(anmatMatrixData(&matrixF, 0, 1), 0.1f);
+  expectEquals(anmatMatrixData(&matrixF, 1, 2), -3e10f);
+  expectEquals(anmatMatrixData(&matrixF, 1, 1), 0);
+
+  expectEquals(anmatMatrixToDouble(&matrixF, &matrix), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixData(&matrix, 0, 0), 0.5);
+  expectEquals(anmatMatrixData(&matrix, 0, 1), (double)0.1f);
+  expectEquals(anmatMatrixData(&matrix, 1, 2), (double)-3e10f);
+
+  anmatMatrixFree(&matrix);
+  anmatMatrixFree(&other);
+  anmatMatrixFreeF(&matrixF);
+
+  return 0;
+}
+
+// Run every op in both precisions on rows x cols matrices (and a cols x inner
+// one, for the multiply).
+static int checkOps(unsigned int rows, unsigned int cols, unsigned int inner)
+{
+  AnmatMatrix_t a, b, c, t, k, p;
+  AnmatMatrixF_t aF, bF, cF, tF, kF, pF;
+  unsigned int rowI, colI;
+  double bound;
+
+  expectEquals(anmatMatrixAlloc(&a, rows, cols), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&b, rows, cols), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&c, rows, cols), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&t, cols, rows), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&k, cols, inner), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&p, rows, inner), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAllocF(&aF, rows, cols), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAllocF(&bF, rows, cols), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAllocF(&cF, rows, cols), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAllocF(&tF, cols, rows), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAllocF(&kF, cols, inner), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAllocF(&pF, rows, inner), ANMAT_SUCCESS);
+  expect(!fill(&a, &aF));
+  expect(!fill(&b, &bF));
+  expect(!fill(&k, &kF));
+
+  // No zeros to divide by.
+  for (rowI = 0; rowI < rows; rowI ++) {
+    for (colI = 0; colI < cols; colI ++) {
+      if (anmatMatrixData(&b, rowI, colI) == 0) {
+        anmatMatrixData(&b, rowI, colI) = 0.5;
+        anmatMatrixData(&bF, rowI, colI) = 0.5f;
+      }
+    }
+  }
+
+  expectEquals(anmatMatrixAdd(&a, &b, &c), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAddF(&aF, &bF, &cF), ANMAT_SUCCESS);
+  expect(!near(&cF, &c, FLOAT_EPSILON(28)));
+
+  expectEquals(anmatMatrixSubtract(&a, &b, &c), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixSubtractF(&aF, &bF, &cF), ANMAT_SUCCESS);
+  expect(!near(&cF, &c, FLOAT_EPSILON(28)));
+
+  expectEquals(anmatMatrixScale(&a, 0.25, &c), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixScaleF(&aF, 0.25f, &cF), ANMAT_SUCCESS);
+  expect(!near(&cF, &c, 0));
+
+  expectEquals(anmatMatrixAxpby(1.5, &a, -2, &b, &c), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAxpbyF(1.5f, &aF, -2, &bF, &cF), ANMAT_SUCCESS);
+  expect(!near(&cF, &c, FLOAT_EPSILON(50)));
+
+  expectEquals(anmatMatrixHadamardMultiply(&a, &b, &c), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixHadamardMultiplyF(&aF, &bF, &cF), ANMAT_SUCCESS);
+  expect(!near(&cF, &c, FLOAT_EPSILON(196)));
+
+  expectEquals(anmatMatrixHadamardDivide(&a, &b, &c), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixHadamardDivideF(&aF, &bF, &cF), ANMAT_SUCCESS);
+  expect(!near(&cF, &c, FLOAT_EPSILON(196)));
+
+  expectEquals(anmatMatrixClampF(&aF, 1, -1, &cF), ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixClamp(&a, -3, 5, &c), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixClampF(&aF, -3, 5, &cF), ANMAT_SUCCESS);
+  expect(!near(&cF, &c, 0));
+
+  expectEquals(anmatMatrixTranspose(&a, &t), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixTransposeF(&aF, &tF), ANMAT_SUCCESS);
+  expect(!near(&tF, &t, 0));
+
+  // The double product is (close to) exact, as far as floats can tell.
+  expectEquals(anmatMatrixMultiplyF(&aF, &kF, &tF), ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixMultiply(&a, &k, &p), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixMultiplyF(&aF, &kF, &pF), ANMAT_SUCCESS);
+  bound = anmatMatrixMultiplyErrorBoundF(&aF, &kF);
+  expect(bound > anmatMatrixMultiplyErrorBound(&a, &k));
+  expect(!near(&pF, &p, bound));
+
+  anmatMatrixFree(&a);
+  anmatMatrixFree(&b);
+  anmatMatrixFree(&c);
+  anmatMatrixFree(&t);
+  anmatMatrixFree(&k);
+  anmatMatrixFree(&p);
+  anmatMatrixFreeF(&aF);
+  anmatMatrixFreeF(&bF);
+  anmatMatrixFreeF(&cF);
+  anmatMatrixFreeF(&tF);
+  anmatMatrixFreeF(&kF);
+  anmatMatrixFreeF(&pF);
+
+  return 0;
+}
+
+static int opsTest(void)
+{
+  AnmatSimdLevel_t level, original = anmatSimdLevelGet();
+
+  srand(1);
+
+  // Every level, with sizes that fill the widest float vectors and tiles
+  // exactly, and sizes that leave some over.
+  for (level = ANMAT_SIMD_PORTABLE; anmatSimdLevelName(level); level ++) {
+    if (anmatSimdLevelSet(level) != ANMAT_SUCCESS) {
+      continue;
+    }
+    expect(!checkOps(1, 1, 2));
+    expect(!checkOps(16, 32, 16));
+    expect(!checkOps(37, 53, 41));
+    expect(!checkOps(70, 65, 300));
+  }
+
+  expectEquals(anmatSimdLevelSet(original), ANMAT_SUCCESS);
+
+  return 0;
+}
+
+static int strassenTest(void)
+{
+  AnmatStrassenConfig_t config = { true, ANMAT_STRASSEN_CROSSOVER_MIN, };
+  AnmatMatrix_t a, b, c;
+  AnmatMatrixF_t aF, bF, cF;
+  double bound, gemmBound;
+
+  srand(2);
+
+  expectEquals(anmatMatrixAlloc(&a, 70, 66), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&b, 66, 68), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&c, 70, 68), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAllocF(&aF, 70, 66), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAllocF(&bF, 66, 68), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAllocF(&cF, 70, 68), ANMAT_SUCCESS);
+  expect(!fill(&a, &aF));
+  expect(!fill(&b, &bF));
+
+  // The same config applies to both precisions.
+  expectEquals(anmatMatrixMultiply(&a, &b, &c), ANMAT_SUCCESS);
+  gemmBound = anmatMatrixMultiplyErrorBoundF(&aF, &bF);
+  expectEquals(anmatMatrixStrassenSet(&config), ANMAT_SUCCESS);
+  bound = anmatMatrixMultiplyErrorBoundF(&aF, &bF);
+  expect(bound > gemmBound);
+  expectEquals(anmatMatrixMultiplyF(&aF, &bF, &cF), ANMAT_SUCCESS);
+  expect(!near(&cF, &c, bound));
+  expectEquals(anmatMatrixStrassenSet(NULL), ANMAT_SUCCESS);
+
+  anmatMatrixFree(&a);
+  anmatMatrixFree(&b);
+  anmatMatrixFree(&c);
+  anmatMatrixFreeF(&aF);
+  anmatMatrixFreeF(&bF);
+  anmatMatrixFreeF(&cF);
+
+  return 0;
+}
+
+static int transposeInPlaceTest(void)
+{
+  AnmatMatrix_t matrix, expected;
+  AnmatMatrixF_t matrixF, squareF, viewF;
+  unsigned int rowI, colI;
+
+  srand(3);
+
+  // Not square: the shape and the stride change. The padded rows of the
+  // transpose fit, in floats.
+  expectEquals(anmatMatrixAlloc(&matrix, 45, 17), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&expected, 17, 45), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAllocF(&matrixF, 45, 17), ANMAT_SUCCESS);
+  expect(!fill(&matrix, &matrixF));
+  expectEquals(anmatMatrixTranspose(&matrix, &expected), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixTransposeInPlaceF(&matrixF), ANMAT_SUCCESS);
+  expectEquals(matrixF.stride, 48);
+  expect(!near(&matrixF, &expected, 0));
+
+  // A view that is not square cannot change shape.
+  expectEquals(anmatMatrixViewF(&viewF, &matrixF, 0, 0, 2, 3), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixTransposeInPlaceF(&viewF), ANMAT_BAD_ARG);
+
+  // Square, across a few leaves.
+  expectEquals(anmatMatrixAllocF(&squareF, 75, 75), ANMAT_SUCCESS);
+  for (rowI = 0; rowI < 75; rowI ++) {
+    for (colI = 0; colI < 75; colI ++) {
+      anmatMatrixData(&squareF, rowI, colI) = (rowI * 75) + colI;
+    }
+  }
+  expectEquals(anmatMatrixTransposeInPlaceF(&squareF), ANMAT_SUCCESS);
+  for (rowI = 0; rowI < 75; rowI ++) {
+    for (colI = 0; colI < 75; colI ++) {
+      expectEquals(anmatMatrixData(&squareF, rowI, colI), (colI * 75) + rowI);
+    }
+  }
+
+  anmatMatrixFree(&matrix);
+  anmatMatrixFree(&expected);
+  anmatMatrixFreeF(&matrixF);
+  anmatMatrixFreeF(&squareF);
+
+  return 0;
+}
+
+static int ioTest(void)
+{
+  AnmatMatrixF_t matrixF, scannedF;
+  FILE *stream;
+
+  expectEquals(anmatMatrixAllocF(&matrixF, 2, 3), ANMAT_SUCCESS);
+  anmatMatrixData(&matrixF, 0, 0) = 1.5f;
+  anmatMatrixData(&matrixF, 0, 2) = -2.25f;
+  anmatMatrixData(&matrixF, 1, 1) = 100;
+
+  stream = tmpfile();
+  expect(stream != NULL);
+  expectEquals(anmatMatrixPrintF(&matrixF, stream), ANMAT_SUCCESS);
+  rewind(stream);
+  expectEquals(anmatMatrixScanF(&scannedF, stream), ANMAT_SUCCESS);
+  fclose(stream);
+
+  expectEquals(anmatMatrixRowCount(&scannedF), 2);
+  expectEquals(anmatMatrixColCount(&scannedF), 3);
+  expect(anmatMatrixEqualsF(&scannedF, &matrixF));
+  anmatMatrixData(&scannedF, 1, 2) = 1;
+  expect(!anmatMatrixEqualsF(&scannedF, &matrixF));
+
+  anmatMatrixFreeF(&matrixF);
+  anmatMatrixFreeF(&scannedF);
+
+  // Heap should be full.
+  expectHeapEmpty();
+
+  return 0;
+}
+
+static int vectorTest(void)
+{
+  AnmatVector_t vectorA, vectorB, other;
+  AnmatVectorF_t vectorAF, vectorBF;
+  AnmatSimdLevel_t level, original = anmatSimdLevelGet();
+  double dot;
+  float dotF;
+  unsigned int valueI;
+
+  srand(4);
+
+  expectEquals(anmatVectorAlloc(&vectorA, 101), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAlloc(&vectorB, 101), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAlloc(&other, 100), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAllocF(&vectorAF, 101), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAllocF(&vectorBF, 101), ANMAT_SUCCESS);
+  for (valueI = 0; valueI < 101; valueI ++) {
+    anmatVectorData(&vectorA, valueI) = randomValue();
+    anmatVectorData(&vectorB, valueI) = randomValue();
+  }
+
+  expectEquals(anmatVectorToFloat(&other, &vectorAF), ANMAT_BAD_ARG);
+  expectEquals(anmatVectorToFloat(&vectorA, &vectorAF), ANMAT_SUCCESS);
+  expectEquals(anmatVectorToFloat(&vectorB, &vectorBF), ANMAT_SUCCESS);
+  expectEquals(anmatVectorToDouble(&vectorAF, &other), ANMAT_BAD_ARG);
+  expectEquals(anmatVectorToDouble(&vectorAF, &vectorA), ANMAT_SUCCESS);
+  expectEquals(anmatVectorToDouble(&vectorBF, &vectorB), ANMAT_SUCCESS);
+  expectEquals(anmatVectorData(&vectorA, 100),
+               anmatVectorData(&vectorAF, 100));
+
+  for (level = ANMAT_SIMD_PORTABLE; anmatSimdLevelName(level); level ++) {
+    if (anmatSimdLevelSet(level) != ANMAT_SUCCESS) {
+      continue;
+    }
+
+    expectNeighborhood(anmatStatAverageF(&vectorAF),
+                       anmatStatAverage(&vectorA),
+                       FLOAT_EPSILON(14 * 101));
+
+    expectEquals(anmatVectorDot(&vectorA, &vectorB, &dot), ANMAT_SUCCESS);
+    expectEquals(anmatVectorDotF(&vectorAF, &vectorBF, &dotF),
+                 ANMAT_SUCCESS);
+    expectNeighborhood(dotF, dot, FLOAT_EPSILON(196 * 101));
+  }
+
+  expectEquals(anmatSimdLevelSet(original), ANMAT_SUCCESS);
+
+  anmatVectorFree(&vectorA);
+  anmatVectorFree(&vectorB);
+  anmatVectorFree(&other);
+  anmatVectorFreeF(&vectorAF);
+  anmatVectorFreeF(&vectorBF);
+
+  return 0;
+}
+
+static int batchTest(void)
+{
+  // Two 2 x 1 by 1 x 2 problems, as in the double test.
+  float a[4] = { 1, 2, 3, 4, }, b[4] = { 5, 6, 7, 8, }, c[8];
+  float bigA[100 * 9], bigB[100 * 9], bigC[100 * 9];
+  double expected;
+  AnmatSimdLevel_t level, original = anmatSimdLevelGet();
+  AnmatBatchLayout_t layout;
+  unsigned int i, j, l, p;
+
+  expectEquals(anmatBatchMultiplyF(ANMAT_BATCH_AOS, 2, 2, 2, 1, a, b, c),
+               ANMAT_SUCCESS);
+  expectEquals(c[0], 5);
+  expectEquals(c[3], 12);
+  expectEquals(c[7], 32);
+
+  srand(5);
+  for (i = 0; i < 100 * 9; i ++) {
+    bigA[i] = randomValue();
+    bigB[i] = randomValue();
+  }
+
+  // 100 3 x 3 problems, which is some whole vectors and some left over.
+  for (level = ANMAT_SIMD_PORTABLE; anmatSimdLevelName(level); level ++) {
+    if (anmatSimdLevelSet(level) != ANMAT_SUCCESS) {
+      continue;
+    }
+    for (layout = ANMAT_BATCH_AOS; layout <= ANMAT_BATCH_SOA; layout ++) {
+      expectEquals(anmatBatchMultiplyF(layout, 100, 3, 3, 3,
+                                       bigA, bigB, bigC),
+                   ANMAT_SUCCESS);
+      for (p = 0; p < 100; p ++) {
+        for (i = 0; i < 3; i ++) {
+          for (j = 0; j < 3; j ++) {
+            expected = 0;
+            for (l = 0; l < 3; l ++) {
+              expected += (layout == ANMAT_BATCH_AOS
+                           ? (bigA[(p * 9) + (i * 3) + l]
+                              * bigB[(p * 9) + (l * 3) + j])
+                           : (bigA[(((i * 3) + l) * 100) + p]
+                              * bigB[(((l * 3) + j) * 100) + p]));
+            }
+            expectNeighborhood((layout == ANMAT_BATCH_AOS
+                                ? bigC[(p * 9) + (i * 3) + j]
+                                : bigC[(((i * 3) + j) * 100) + p]),
+                               expected,
+                               FLOAT_EPSILON(3 * 196));
+          }
+        }
+      }
+    }
+  }
+
+  expectEquals(anmatSimdLevelSet(original), ANMAT_SUCCESS);
+
+  return 0;
+}
+
+int main(void)
+{
+  announce();
+
+  run(allocTest);
+  run(convertTest);
+  run(opsTest);
+  run(strassenTest);
+  run(transposeInPlaceTest);
+  run(ioTest);
+  run(vectorTest);
+  run(batchTest);
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+//
+// gemm-test.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// General matrix multiply test.
+//
+
+#include <unit-test.h>
+#include <math.h>     // NAN
+#include <stdlib.h>   // srand()
+
+#include "src/gemm.h"
+
+#include "./test-util.h"
+
+// Room for the biggest case, with a leading dimension bigger than the rows.
+#define MAX_M  (300)
+#define MAX_N  (140)
+#define MAX_K  (600)
+#define PAD    (3)
+
+static double a[MAX_M * (MAX_K + PAD)];
+static double b[MAX_K * (MAX_N + PAD)];
+static double c[MAX_M * (MAX_N + PAD)];
+static double expected[MAX_M * MAX_N];
+
+// Multiply with the textbook loops, and check gemm against it.
+static int check(unsigned int m,
+                 unsigned int n,
+                 unsigned int k,
+                 double alpha,
+                 double beta)
+{
+  unsigned int lda = k + PAD, ldb = n + PAD, ldc = n + PAD;
+  unsigned int rowI, colI, p;
+  double total;
+
+  randomValues(a, m * lda);
+  randomValues(b, k * ldb);
+  randomValues(c, m * ldc);
+
+  for (rowI = 0; rowI < m; rowI ++) {
+    for (colI = 0; colI < n; colI ++) {
+      total = 0;
+      for (p = 0; p < k; p ++) {
+        total += a[(rowI * lda) + p] * b[(p * ldb) + colI];
+      }
+      expected[(rowI * n) + colI] = ((alpha * total)
+                                     + (beta == 0
+                                        ? 0
+                                        : beta * c[(rowI * ldc) + colI]));
+    }
+  }
+
+  // With beta = 0, what was in C does not matter, even a NaN.
+  if (beta == 0) {
+    c[0] = NAN;
+  }
+
+  expectEquals(anmatGemm(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc),
+               ANMAT_SUCCESS);
+
+  for (rowI = 0; rowI < m; rowI ++) {
+    for (colI = 0; colI < n; colI ++) {
+      expectNeighborhood(c[(rowI * ldc) + colI],
+                         expected[(rowI * n) + colI],
+                         1e-6);
+    }
+  }
+
+  return 0;
+}
+
+static int sizeTest(void)
+{
+  srand(1);
+
+  // Smaller than one tile.
+  expect(!check(1, 1, 1, 1, 0));
+  expect(!check(3, 5, 2, 1, 0));
+
+  // Not square, and not a multiple of the tile in any direction.
+  expect(!check(5, 3, 7, 1, 0));
+  expect(!check(7, 13, 5, 1, 0));
+
+  // Bigger than a panel of A, and more than one pass over k.
+  expect(!check(MAX_M, 37, MAX_K, 1, 0));
+  expect(!check(131, MAX_N, 257, 1, 0));
+
+  return 0;
+}
+
+static int scaleTest(void)
+{
+  srand(2);
+
+  // Accumulating into C, which the factorizations need.
+  expect(!check(9, 17, 300, -1, 1));
+  expect(!check(33, 9, 20, 0.5, -2));
+
+  // Nothing to multiply still scales C.
+  expect(!check(4, 4, 0, 1, 3));
+  expect(!check(4, 4, 8, 0, 3));
+
+  // Nothing in C.
+  expectEquals(anmatGemm(0, 4, 4, 1, a, 4, b, 4, 0, c, 4), ANMAT_SUCCESS);
+
+  return 0;
+}
+
+int main(void)
+{
+  announce();
+
+  run(sizeTest);
+  run(scaleTest);
+
+  return 0;
+}
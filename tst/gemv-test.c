@@ -0,0 +1,210 @@
+//
+// gemv-test.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Matrix-vector unit test.
+//
+
+#include <unit-test.h>
+#include <math.h>     // NAN
+#include <stdlib.h>   // srand()
+
+#include "gemv.h"
+#include "matrix.h"
+#include "stat.h"
+#include "thread.h"
+
+#include "./test-util.h"
+
+// Check alpha * op(A) * x + beta * y against the loops, for a rows x cols A
+// (a view, if padded), and both precisions.
+static int check(AnmatTranspose_t op,
+                 unsigned int rows,
+                 unsigned int cols,
+                 double alpha,
+                 double beta,
+                 bool padded)
+{
+  AnmatMatrix_t matrix, matrixA;
+  AnmatMatrixF_t matrixF, matrixAF;
+  AnmatVector_t vectorX, vectorY;
+  AnmatVectorF_t vectorXF, vectorYF;
+  unsigned int xCount = (op == ANMAT_TRANSPOSE ? rows : cols);
+  unsigned int yCount = (op == ANMAT_TRANSPOSE ? cols : rows);
+  unsigned int rowI, colI, i;
+  double expected[512], total, a;
+
+  expectEquals(anmatMatrixAlloc(&matrix, rows + padded, cols + padded),
+               ANMAT_SUCCESS);
+  expectEquals(anmatMatrixView(&matrixA, &matrix, padded, padded, rows, cols),
+               ANMAT_SUCCESS);
+  for (rowI = 0; rowI < rows + padded; rowI ++) {
+    for (colI = 0; colI < cols + padded; colI ++) {
+      anmatMatrixData(&matrix, rowI, colI) = randomValue();
+    }
+  }
+  expectEquals(anmatVectorAlloc(&vectorX, xCount), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAlloc(&vectorY, yCount), ANMAT_SUCCESS);
+  for (i = 0; i < xCount; i ++) {
+    anmatVectorData(&vectorX, i) = randomValue();
+  }
+  for (i = 0; i < yCount; i ++) {
+    // A beta of 0 means y is not read, so garbage in it should not matter.
+    anmatVectorData(&vectorY, i) = (beta == 0 ? NAN : randomValue());
+  }
+
+  expect(yCount <= sizeof(expected) / sizeof(expected[0]));
+  for (i = 0; i < yCount; i ++) {
+    total = 0;
+    for (colI = 0; colI < xCount; colI ++) {
+      a = (op == ANMAT_TRANSPOSE
+           ? anmatMatrixData(&matrixA, colI, i)
+           : anmatMatrixData(&matrixA, i, colI));
+      total += a * anmatVectorData(&vectorX, colI);
+    }
+    expected[i] = alpha * total;
+    if (beta != 0) {
+      expected[i] += beta * anmatVectorData(&vectorY, i);
+    }
+  }
+
+  // The floats, from the same values.
+  expectEquals(anmatMatrixAllocF(&matrixF, rows + padded, cols + padded),
+               ANMAT_SUCCESS);
+  expectEquals(anmatMatrixToFloat(&matrix, &matrixF), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixViewF(&matrixAF, &matrixF, padded, padded,
+                                rows, cols),
+               ANMAT_SUCCESS);
+  expectEquals(anmatVectorAllocF(&vectorXF, xCount), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAllocF(&vectorYF, yCount), ANMAT_SUCCESS);
+  expectEquals(anmatVectorToFloat(&vectorX, &vectorXF), ANMAT_SUCCESS);
+  expectEquals(anmatVectorToFloat(&vectorY, &vectorYF), ANMAT_SUCCESS);
+
+  expectEquals(anmatMatrixVectorMultiply(op, alpha, &matrixA, &vectorX,
+                                         beta, &vectorY),
+               ANMAT_SUCCESS);
+  expectEquals(anmatMatrixVectorMultiplyF(op, alpha, &matrixAF, &vectorXF,
+                                          beta, &vectorYF),
+               ANMAT_SUCCESS);
+  for (i = 0; i < yCount; i ++) {
+    expectNeighborhood(anmatVectorData(&vectorY, i), expected[i], 1e-9);
+    expectNeighborhood(anmatVectorData(&vectorYF, i), expected[i],
+                       1e-5 * xCount * 200);
+  }
+
+  anmatMatrixFree(&matrix);
+  anmatMatrixFreeF(&matrixF);
+  anmatVectorFree(&vectorX);
+  anmatVectorFree(&vectorY);
+  anmatVectorFreeF(&vectorXF);
+  anmatVectorFreeF(&vectorYF);
+
+  return 0;
+}
+
+static int badArgTest(void)
+{
+  AnmatMatrix_t matrix;
+  AnmatVector_t vector3, vector4;
+
+  expectEquals(anmatMatrixAlloc(&matrix, 3, 4), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAlloc(&vector3, 3), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAlloc(&vector4, 4), ANMAT_SUCCESS);
+
+  expectEquals(anmatMatrixVectorMultiply(ANMAT_NO_TRANSPOSE, 1, &matrix,
+                                         &vector3, 0, &vector3),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixVectorMultiply(ANMAT_NO_TRANSPOSE, 1, &matrix,
+                                         &vector4, 0, &vector4),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixVectorMultiply(ANMAT_TRANSPOSE, 1, &matrix,
+                                         &vector4, 0, &vector3),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixVectorMultiply((AnmatTranspose_t)2, 1, &matrix,
+                                         &vector4, 0, &vector3),
+               ANMAT_BAD_ARG);
+
+  expectEquals(anmatMatrixVectorMultiply(ANMAT_NO_TRANSPOSE, 1, &matrix,
+                                         &vector4, 0, &vector3),
+               ANMAT_SUCCESS);
+  expectEquals(anmatMatrixVectorMultiply(ANMAT_TRANSPOSE, 1, &matrix,
+                                         &vector3, 0, &vector4),
+               ANMAT_SUCCESS);
+
+  anmatMatrixFree(&matrix);
+  anmatVectorFree(&vector3);
+  anmatVectorFree(&vector4);
+
+  return 0;
+}
+
+static int multiplyTest(void)
+{
+  AnmatTranspose_t op;
+
+  srand(1);
+
+  for (op = ANMAT_NO_TRANSPOSE; op <= ANMAT_TRANSPOSE; op ++) {
+    expect(!check(op, 1, 1, 1, 0, false));
+    expect(!check(op, 3, 4, 1, 0, false));
+    expect(!check(op, 17, 9, 2.5, 0, false));
+    expect(!check(op, 9, 17, 1, 1, false));
+    expect(!check(op, 33, 65, -1, 0.5, false));
+    expect(!check(op, 100, 3, 0.25, -2, false));
+  }
+
+  return 0;
+}
+
+static int viewTest(void)
+{
+  AnmatTranspose_t op;
+
+  srand(2);
+
+  // Rows that are padded, and do not start on a boundary.
+  for (op = ANMAT_NO_TRANSPOSE; op <= ANMAT_TRANSPOSE; op ++) {
+    expect(!check(op, 5, 7, 1, 0, true));
+    expect(!check(op, 31, 20, -3, 1, true));
+  }
+
+  return 0;
+}
+
+static int threadTest(void)
+{
+  AnmatTranspose_t op;
+
+  srand(3);
+
+  // Split every multiply up, even into more tasks than rows.
+  anmatThreadCountSet(3);
+  anmatThreadThresholdSet(1);
+
+  for (op = ANMAT_NO_TRANSPOSE; op <= ANMAT_TRANSPOSE; op ++) {
+    expect(!check(op, 2, 50, 1, 0, false));
+    expect(!check(op, 200, 37, 1.5, 0, false));
+    expect(!check(op, 200, 37, 1, -1, true));
+    expect(!check(op, 57, 300, -1, 2, false));
+  }
+
+  anmatThreadThresholdSet(0);
+  anmatThreadCountSet(0);
+
+  return 0;
+}
+
+int main(void)
+{
+  announce();
+
+  run(badArgTest);
+  run(multiplyTest);
+  run(viewTest);
+  run(threadTest);
+
+  return 0;
+}
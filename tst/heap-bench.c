@@ -0,0 +1,95 @@
+//
+// heap-bench.c
+//
+// Heap allocation benchmark.
+//
+// Build this against src/heap.c with and without HEAP_BITWISE_SEARCH to
+// compare the word at a time free run search with the bit at a time one
+// (see the bench target in the makefile).
+//
+
+#include <stdlib.h> // srand(), rand()
+#include <time.h>   // clock_gettime()
+
+#include "src/heap.h"
+
+#define HEAP_SIZE (1 << 20)
+
+#define ITERATIONS (1000)
+
+// Allocations bigger than this skip the free lists, so frees punch holes
+// into the bitmap.
+#define SMALLEST_HOLE (256)
+
+static double now(void)
+{
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + (time.tv_nsec / 1e9);
+}
+
+// Fill the heap with allocations of random sizes and then free every other
+// one, so the free space is spread out in holes of at most maxHole bytes.
+static void fragment(unsigned int maxHole)
+{
+  static void *pointers[HEAP_SIZE / SMALLEST_HOLE];
+  HeapConfig_t config = { HEAP_SIZE, false, };
+  unsigned int count, i;
+
+  heapInit(&config);
+  srand(1);
+
+  for (count = 0; count < HEAP_SIZE / SMALLEST_HOLE; count ++) {
+    pointers[count] = heapAlloc(SMALLEST_HOLE
+                                + (rand() % (maxHole - SMALLEST_HOLE)));
+    if (!pointers[count]) {
+      break;
+    }
+  }
+
+  for (i = 0; i < count; i += 2) {
+    heapFree(pointers[i]);
+  }
+}
+
+// Time allocating and freeing count bytes on a fragmented heap.
+static void bench(const char *name, unsigned int count)
+{
+  unsigned int i;
+  double start, elapsed;
+  void *pointer;
+
+  fragment(SMALLEST_HOLE * 2);
+
+  start = now();
+  for (i = 0; i < ITERATIONS; i ++) {
+    pointer = heapAlloc(count);
+    if (pointer) {
+      heapFree(pointer);
+    }
+  }
+  elapsed = now() - start;
+
+  printf("  %-24s %10.1f ns/op (%u free bytes)\n",
+         name, (elapsed * 1e9) / ITERATIONS, heapFreeBytesCount);
+}
+
+int main(void)
+{
+#ifdef HEAP_BITWISE_SEARCH
+  printf("heap-bench: bit at a time search, %d byte heap\n", HEAP_SIZE);
+#else
+  printf("heap-bench: word at a time search, %d byte heap\n", HEAP_SIZE);
+#endif
+
+  // Fits in the first hole.
+  bench("first hole", SMALLEST_HOLE - 1);
+
+  // Fits in some hole along the way.
+  bench("some hole", (SMALLEST_HOLE * 2) - 64);
+
+  // Does not fit in any hole, so the whole heap is searched.
+  bench("no hole", SMALLEST_HOLE * 4);
+
+  return 0;
+}
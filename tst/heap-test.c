@@ -14,8 +14,24 @@
 #include "src/heap.h"
 #include "util.h" // anmatMemcpy()
 
+#include <string.h> // strstr()
+
+#ifdef ANMAT_HEAP_THREAD_SAFE
+  #include <pthread.h>
+#endif
+
+#ifdef ANMAT_HEAP_CHECK
+  #include <signal.h>   // SIGABRT
+  #include <stdio.h>    // freopen()
+  #include <unistd.h>   // fork(), _exit()
+  #include <sys/wait.h> // waitpid()
+#endif
+
 #include "./test-util.h"
 
+// A heap that cannot grow, so that it can be filled up.
+static const HeapConfig_t fixedConfig = { HEAP_SIZE, false, };
+
 static int doubleTest(void)
 {
   double *pointers[2] = {NULL,NULL,};
@@ -71,7 +87,7 @@ static int stressTest(void)
   unsigned char *pointers[3] = {NULL, NULL, NULL,};
 
   // Initializing the heap should mean all the bytes are available.
-  heapInit();
+  heapInit(&fixedConfig);
   expectHeapEmpty();
   
   // Let's allocate the whole heap with two chunks. One will be
@@ -125,7 +141,7 @@ static int structTest(void)
   expectEquals(sizeof(struct SmallTestStruct_t), 8);
   expectEquals(sizeof(struct LargeTestStruct_t), 16);
 
-  heapInit();  
+  heapInit(NULL);
 
   // Allocate memory for a small struct and make sure it functions properly.
   struct SmallTestStruct_t *smallStructPointer
@@ -171,7 +187,7 @@ static int arrayTest(void)
 {
   int **matrix, i;
 
-  heapInit();
+  heapInit(NULL);
   expectHeapEmpty();
 
   // Allocate room for 3 pointers.
@@ -206,6 +222,432 @@ static int arrayTest(void)
   return 0;
 }
 
+static int freeListTest(void)
+{
+  unsigned char *pointers[64], *pointer;
+  unsigned int i;
+
+  heapInit(&fixedConfig);
+  expectHeapEmpty();
+
+  // Freeing a small allocation and asking for the same size again should give
+  // back the same memory.
+  pointers[0] = (unsigned char *)heapAlloc(2 * sizeof(double));
+  expect(pointers[0] != NULL);
+  pointers[1] = (unsigned char *)heapAlloc(2 * sizeof(double));
+  expect(pointers[1] != NULL);
+  heapFree(pointers[0]);
+  expectHeapSize(HEAP_SIZE - (2 * sizeof(double)) - 1);
+  pointer = (unsigned char *)heapAlloc(2 * sizeof(double));
+  expect(pointer == pointers[0]);
+  heapFree(pointer);
+  heapFree(pointers[1]);
+  expectHeapEmpty();
+
+  // Fill the heap with small allocations, 64 bytes apiece with their alloc
+  // byte, and then free all of them.
+  heapInit(&fixedConfig);
+  for (i = 0; i < 64; i ++) {
+    pointers[i] = (unsigned char *)heapAlloc((HEAP_SIZE / 64) - 1);
+    expect(pointers[i] != NULL);
+  }
+  expectHeapFull();
+  for (i = 0; i < 64; i ++) {
+    heapFree(pointers[i]);
+  }
+  expectHeapEmpty();
+
+  // The free lists should give all of those bytes back when a large
+  // allocation needs them.
+  pointer = (unsigned char *)heapAlloc(HEAP_SIZE - 1);
+  expect(pointer != NULL);
+  expectHeapFull();
+  heapFree(pointer);
+  expectHeapEmpty();
+
+  return 0;
+}
+
+static int alignTest(void)
+{
+  unsigned char *pointers[4];
+  unsigned int alignment;
+
+  heapInit(&fixedConfig);
+
+  // Bad alignments.
+  expect(heapAllocAligned(8, 0) == NULL);
+  expect(heapAllocAligned(8, 3) == NULL);
+  expect(heapAllocAligned(8, HEAP_MAX_ALIGNMENT * 2) == NULL);
+  expectHeapEmpty();
+
+  // Knock the heap off of any alignment.
+  pointers[0] = (unsigned char *)heapAlloc(3);
+  expect(pointers[0] != NULL);
+
+  // Aligned allocations cost the same as any other.
+  for (alignment = 16; alignment <= HEAP_MAX_ALIGNMENT; alignment <<= 1) {
+    pointers[1] = (unsigned char *)heapAllocAligned(5 * sizeof(double),
+                                                    alignment);
+    expect(pointers[1] != NULL);
+    expectAligned(pointers[1], alignment);
+    expectHeapSize(HEAP_SIZE - 3 - 1 - (5 * sizeof(double)) - 1);
+    heapFree(pointers[1]);
+  }
+
+  heapFree(pointers[0]);
+  expectHeapEmpty();
+
+  // The bytes skipped to align an allocation are still usable.
+  heapInit(&fixedConfig);
+  pointers[0] = (unsigned char *)heapAlloc(3);
+  pointers[1] = (unsigned char *)heapAllocAligned(8, HEAP_MAX_ALIGNMENT);
+  expectAligned(pointers[1], HEAP_MAX_ALIGNMENT);
+  pointers[2] = (unsigned char *)heapAlloc(HEAP_MAX_ALIGNMENT - 3 - 1 - 2);
+  expect(pointers[2] != NULL);
+  expect(pointers[2] < pointers[1]);
+  pointers[3] = (unsigned char *)heapAllocAligned(8, HEAP_MAX_ALIGNMENT);
+  expectAligned(pointers[3], HEAP_MAX_ALIGNMENT);
+  heapFree(pointers[0]);
+  heapFree(pointers[1]);
+  heapFree(pointers[2]);
+  heapFree(pointers[3]);
+  expectHeapEmpty();
+
+  return 0;
+}
+
+static int growTest(void)
+{
+  HeapConfig_t config = HEAP_CONFIG_DEFAULT;
+  unsigned char *pointers[64], *pointer;
+  unsigned int i;
+
+  // Bad configs.
+  config.size = 0;
+  expectEquals(heapInit(&config), ANMAT_BAD_ARG);
+
+  // The default heap grows.
+  expectEquals(heapInit(NULL), ANMAT_SUCCESS);
+  expectHeapEmpty();
+
+  // Something bigger than the whole heap should fit in a new region.
+  pointer = (unsigned char *)heapAlloc(HEAP_SIZE * 4);
+  expect(pointer != NULL);
+  pointer[0] = 1;
+  pointer[(HEAP_SIZE * 4) - 1] = 2;
+  expect(heapFreeBytesCount >= HEAP_SIZE - 1);
+
+  // Giving it back should give the region back.
+  heapFree(pointer);
+  expectHeapEmpty();
+
+  // Lots of small allocations should spill over into new regions too.
+  for (i = 0; i < 64; i ++) {
+    pointers[i] = (unsigned char *)heapAlloc(HEAP_SIZE / 16);
+    expect(pointers[i] != NULL);
+  }
+  for (i = 0; i < 64; i ++) {
+    heapFree(pointers[i]);
+  }
+  expectHeapEmpty();
+
+  // A bigger first region.
+  config.size = HEAP_SIZE * 2;
+  config.growable = false;
+  expectEquals(heapInit(&config), ANMAT_SUCCESS);
+  expectEquals(heapFreeBytesCount, HEAP_SIZE * 2);
+  pointer = (unsigned char *)heapAlloc((HEAP_SIZE * 2) - 1);
+  expect(pointer != NULL);
+  expectHeapFull();
+  expect(heapAlloc(1) == NULL);
+  heapFree(pointer);
+  expectEquals(heapFreeBytesCount, HEAP_SIZE * 2);
+
+  // Back to the default heap for everybody else.
+  expectEquals(heapInit(NULL), ANMAT_SUCCESS);
+  expectHeapEmpty();
+
+  return 0;
+}
+
+static int statsTest(void)
+{
+  HeapStats_t stats;
+  unsigned char *pointers[3];
+  char line[1024];
+  FILE *stream;
+
+  // A fresh heap has one free run.
+  expectEquals(heapInit(&fixedConfig), ANMAT_SUCCESS);
+  heapGetStats(&stats);
+  expectEquals(stats.size, HEAP_SIZE);
+  expectEquals(stats.regionCount, 1);
+  expectEquals(stats.freeBytes, HEAP_SIZE);
+  expectEquals(stats.liveBytes, 0);
+  expectEquals(stats.allocCount, 0);
+  expectEquals(stats.largestFreeRun, HEAP_SIZE - 1);
+  expect(stats.fragmentation == 0);
+
+  // These are too big for the free lists, so they come out of the bitmap.
+  pointers[0] = (unsigned char *)heapAlloc(1000);
+  pointers[1] = (unsigned char *)heapAlloc(1000);
+  pointers[2] = (unsigned char *)heapAlloc(1000);
+  expect(pointers[0] && pointers[1] && pointers[2]);
+  heapGetStats(&stats);
+  expectEquals(stats.allocCount, 3);
+  expectEquals(stats.histogram[9], 3); // [512, 1024)
+  expectEquals(stats.liveBytes, 3 * 1001);
+  expectEquals(stats.peakLiveBytes, 3 * 1001);
+  expectEquals(stats.largestFreeRun, HEAP_SIZE - (3 * 1001) - 1);
+
+  // Punch a hole. The peak stays, and the free bytes are split up.
+  heapFree(pointers[1]);
+  heapGetStats(&stats);
+  expectEquals(stats.freeCount, 1);
+  expectEquals(stats.liveBytes, 2 * 1001);
+  expectEquals(stats.peakLiveBytes, 3 * 1001);
+  expectEquals(stats.largestFreeRun, HEAP_SIZE - (3 * 1001) - 1);
+  expect(stats.fragmentation > 0 && stats.fragmentation < 1);
+
+  // Failures are counted.
+  expect(heapAlloc(HEAP_SIZE) == NULL);
+  heapGetStats(&stats);
+  expectEquals(stats.failedAllocCount, 1);
+  expectEquals(stats.allocCount, 3);
+
+  // The stats print as JSON.
+  stream = tmpfile();
+  expect(stream != NULL);
+  heapPrintStats(stream);
+  rewind(stream);
+  expect(fgets(line, sizeof(line), stream) != NULL);
+  expect(line[0] == '{');
+  expect(strstr(line, "\"allocCount\": 3,") != NULL);
+  expect(strstr(line, "\"failedAllocCount\": 1,") != NULL);
+  fclose(stream);
+
+  heapFree(pointers[0]);
+  heapFree(pointers[2]);
+
+  // Back to the default heap for everybody else.
+  expectEquals(heapInit(NULL), ANMAT_SUCCESS);
+  heapGetStats(&stats);
+  expectEquals(stats.allocCount, 0);
+  expectHeapEmpty();
+
+  return 0;
+}
+
+static int reallocTest(void)
+{
+  unsigned char *pointers[2], *pointer;
+  unsigned int i;
+
+  expectEquals(heapInit(&fixedConfig), ANMAT_SUCCESS);
+
+  // NULL is just an allocation.
+  pointers[0] = (unsigned char *)heapRealloc(NULL, 200);
+  expect(pointers[0] != NULL);
+  expectHeapSize(HEAP_SIZE - 201);
+  for (i = 0; i < 200; i ++) {
+    pointers[0][i] = i;
+  }
+
+  // Nothing is after it, so it should grow in place.
+  pointer = (unsigned char *)heapRealloc(pointers[0], 400);
+  expect(pointer == pointers[0]);
+  expectHeapSize(HEAP_SIZE - 401);
+  pointer[399] = 0xAB;
+
+  // Now something is after it, so it has to move.
+  pointers[1] = (unsigned char *)heapAlloc(200);
+  expect(pointers[1] != NULL);
+  pointer = (unsigned char *)heapRealloc(pointers[0], 800);
+  expect(pointer != NULL);
+  expect(pointer != pointers[0]);
+  expectHeapSize(HEAP_SIZE - 801 - 201);
+  for (i = 0; i < 200; i ++) {
+    expectEquals(pointer[i], i);
+  }
+  expectEquals(pointer[399], 0xAB);
+  pointers[0] = pointer;
+
+  // Shrinking never moves.
+  pointer = (unsigned char *)heapRealloc(pointers[0], 300);
+  expect(pointer == pointers[0]);
+  expectHeapSize(HEAP_SIZE - 301 - 201);
+  expectEquals(pointer[199], 199);
+
+  // The space it gave back can be used.
+  pointers[1] = (unsigned char *)heapRealloc(pointers[1], 1000);
+  expect(pointers[1] != NULL);
+  expectHeapSize(HEAP_SIZE - 301 - 1001);
+
+  // Too big, and the old allocation is left alone.
+  expect(heapRealloc(pointers[0], HEAP_SIZE) == NULL);
+  expectHeapSize(HEAP_SIZE - 301 - 1001);
+  expectEquals(pointers[0][100], 100);
+
+  // 0 is just a free.
+  expect(heapRealloc(pointers[0], 0) == NULL);
+  expect(heapRealloc(pointers[1], 0) == NULL);
+  expectHeapEmpty();
+
+  // Back to the default heap for everybody else.
+  expectEquals(heapInit(NULL), ANMAT_SUCCESS);
+  expectHeapEmpty();
+
+  return 0;
+}
+
+#ifdef ANMAT_HEAP_THREAD_SAFE
+
+#define THREAD_COUNT (4)
+#define THREAD_ALLOCATION_COUNT (16)
+
+// Each thread allocates and frees its own memory for a while and then leaves
+// some allocations behind for another thread to free.
+static void *threadAllocations[THREAD_COUNT][THREAD_ALLOCATION_COUNT];
+
+static void *allocThread(void *arg)
+{
+  void **pointers = (void **)arg;
+  unsigned int round, i;
+
+  for (round = 0; round < 1000; round ++) {
+    for (i = 0; i < THREAD_ALLOCATION_COUNT; i ++) {
+      pointers[i] = heapAlloc(sizeof(double) * (1 + (i % 4)));
+    }
+    for (i = 0; i < THREAD_ALLOCATION_COUNT; i ++) {
+      if (pointers[i]) {
+        *(double *)pointers[i] = round;
+      }
+    }
+    if (round != 999) {
+      for (i = 0; i < THREAD_ALLOCATION_COUNT; i ++) {
+        heapFree(pointers[i]);
+      }
+    }
+  }
+
+  return NULL;
+}
+
+static void *freeThread(void *arg)
+{
+  void **pointers = (void **)arg;
+  unsigned int i;
+
+  for (i = 0; i < THREAD_ALLOCATION_COUNT; i ++) {
+    heapFree(pointers[i]);
+  }
+
+  return NULL;
+}
+
+static int threadTest(void)
+{
+  pthread_t threads[THREAD_COUNT];
+  unsigned int threadI, i;
+
+  heapInit(&fixedConfig);
+  expectHeapEmpty();
+
+  for (threadI = 0; threadI < THREAD_COUNT; threadI ++) {
+    expectEquals(pthread_create(&threads[threadI], NULL, allocThread,
+                                threadAllocations[threadI]),
+                 0);
+  }
+  for (threadI = 0; threadI < THREAD_COUNT; threadI ++) {
+    expectEquals(pthread_join(threads[threadI], NULL), 0);
+  }
+
+  // Every thread should have gotten all of its memory.
+  for (threadI = 0; threadI < THREAD_COUNT; threadI ++) {
+    for (i = 0; i < THREAD_ALLOCATION_COUNT; i ++) {
+      expect(threadAllocations[threadI][i] != NULL);
+    }
+  }
+
+  // Free each thread's leftovers from a different thread.
+  for (threadI = 0; threadI < THREAD_COUNT; threadI ++) {
+    expectEquals(pthread_create(&threads[threadI], NULL, freeThread,
+                                threadAllocations[(threadI + 1)
+                                                  % THREAD_COUNT]),
+                 0);
+  }
+  for (threadI = 0; threadI < THREAD_COUNT; threadI ++) {
+    expectEquals(pthread_join(threads[threadI], NULL), 0);
+  }
+  expectHeapEmpty();
+
+  // All of that memory should be usable again.
+  threadAllocations[0][0] = heapAlloc(HEAP_SIZE - 1);
+  expect(threadAllocations[0][0] != NULL);
+  heapFree(threadAllocations[0][0]);
+  expectHeapEmpty();
+
+  return 0;
+}
+
+#endif /* ANMAT_HEAP_THREAD_SAFE */
+
+#ifdef ANMAT_HEAP_CHECK
+
+// Returns true iff calling heapFree on the pointers, in order, aborts.
+static bool freeAborts(void *first, void *second)
+{
+  pid_t pid;
+  int status;
+
+  if ((pid = fork()) == 0) {
+    freopen("/dev/null", "w", stderr);
+    heapFree(first);
+    heapFree(second);
+    _exit(0);
+  }
+
+  return (pid > 0
+          && waitpid(pid, &status, 0) == pid
+          && WIFSIGNALED(status)
+          && WTERMSIG(status) == SIGABRT);
+}
+
+static int checkTest(void)
+{
+  unsigned char *small, *big, notHeap;
+
+  expectEquals(heapInit(&fixedConfig), ANMAT_SUCCESS);
+
+  small = (unsigned char *)heapAlloc(16);
+  big = (unsigned char *)heapAlloc(1000);
+  expect(small != NULL && big != NULL);
+
+  // Double frees, both from a free list and from refCounts.
+  expect(freeAborts(small, small));
+  expect(freeAborts(big, big));
+
+  // Pointers that are not the start of an allocation.
+  expect(freeAborts(small + 1, NULL));
+  expect(freeAborts(big + 500, NULL));
+  expect(freeAborts(&notHeap, NULL));
+
+  // The real thing is fine.
+  expect(!freeAborts(small, big));
+  heapFree(small);
+  heapFree(big);
+  expectHeapEmpty();
+
+  // Back to the default heap for everybody else.
+  expectEquals(heapInit(NULL), ANMAT_SUCCESS);
+  expectHeapEmpty();
+
+  return 0;
+}
+
+#endif /* ANMAT_HEAP_CHECK */
+
 int main(void)
 {
   announce();
@@ -214,6 +656,17 @@ int main(void)
   run(stressTest);
   run(structTest);
   run(arrayTest);
+  run(freeListTest);
+  run(alignTest);
+  run(growTest);
+  run(statsTest);
+  run(reallocTest);
+#ifdef ANMAT_HEAP_THREAD_SAFE
+  run(threadTest);
+#endif
+#ifdef ANMAT_HEAP_CHECK
+  run(checkTest);
+#endif
 
   return 0;
 }
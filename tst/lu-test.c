@@ -0,0 +1,404 @@
+//
+// lu-test.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// LU unit test.
+//
+
+#include <unit-test.h>
+#include <stdlib.h>   // srand()
+
+#include "lu.h"
+#include "matrix.h"
+#include "stat.h"
+#include "thread.h"
+
+#include "./test-util.h"
+
+static int expectClose(AnmatMatrix_t *matrixA,
+                       AnmatMatrix_t *matrixB,
+                       double epsilon)
+{
+  unsigned int rowI, colI;
+
+  expectEquals(matrixA->rows, matrixB->rows);
+  expectEquals(matrixA->cols, matrixB->cols);
+  for (rowI = 0; rowI < matrixA->rows; rowI ++) {
+    for (colI = 0; colI < matrixA->cols; colI ++) {
+      expectNeighborhood(anmatMatrixData(matrixA, rowI, colI),
+                         anmatMatrixData(matrixB, rowI, colI),
+                         epsilon);
+    }
+  }
+
+  return 0;
+}
+
+// Factor a random n x n matrix, and check that A * X = B for the solution to
+// nrhs right hand sides, both into another matrix and in place.
+static int checkSolve(unsigned int n, unsigned int nrhs)
+{
+  AnmatMatrix_t matrixA, matrixB, matrixX, matrixAX;
+  AnmatLu_t lu;
+
+  expectEquals(anmatMatrixAlloc(&matrixA, n, n), ANMAT_SUCCESS);
+  randomFill(&matrixA);
+  expectEquals(anmatMatrixAlloc(&matrixB, n, nrhs), ANMAT_SUCCESS);
+  randomFill(&matrixB);
+  expectEquals(anmatMatrixAlloc(&matrixX, n, nrhs), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&matrixAX, n, nrhs), ANMAT_SUCCESS);
+
+  expectEquals(anmatLuFactor(&lu, &matrixA), ANMAT_SUCCESS);
+  expect(!lu.singular);
+
+  expectEquals(anmatLuSolve(&lu, &matrixB, &matrixX), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixMultiply(&matrixA, &matrixX, &matrixAX),
+               ANMAT_SUCCESS);
+  expect(!expectClose(&matrixAX, &matrixB, 1e-8));
+
+  expectEquals(anmatLuSolve(&lu, &matrixB, &matrixB), ANMAT_SUCCESS);
+  expect(anmatMatrixEquals(&matrixB, &matrixX));
+
+  anmatLuFree(&lu);
+  anmatMatrixFree(&matrixA);
+  anmatMatrixFree(&matrixB);
+  anmatMatrixFree(&matrixX);
+  anmatMatrixFree(&matrixAX);
+
+  return 0;
+}
+
+static int badArgTest(void)
+{
+  AnmatMatrix_t matrix, square, other;
+  AnmatVector_t vector;
+  AnmatLu_t lu;
+
+  expectEquals(anmatMatrixAlloc(&matrix, 3, 4), ANMAT_SUCCESS);
+  expectEquals(anmatLuFactor(&lu, &matrix), ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixSolveTriangular(ANMAT_LOWER, false,
+                                          &matrix, &matrix),
+               ANMAT_BAD_ARG);
+
+  expectEquals(anmatMatrixAlloc(&square, 4, 4), ANMAT_SUCCESS);
+  randomFill(&square);
+  expectEquals(anmatLuFactor(&lu, &square), ANMAT_SUCCESS);
+  expectEquals(anmatLuSolve(&lu, &matrix, &matrix), ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixAlloc(&other, 4, 3), ANMAT_SUCCESS);
+  expectEquals(anmatLuSolve(&lu, &other, &square), ANMAT_BAD_ARG);
+  expectEquals(anmatLuSolve(&lu, &other, &other), ANMAT_SUCCESS);
+  expectEquals(anmatLuInverse(&lu, &matrix), ANMAT_BAD_ARG);
+  expectEquals(anmatVectorAlloc(&vector, 3), ANMAT_SUCCESS);
+  expectEquals(anmatLuSolveVector(&lu, &vector, &vector), ANMAT_BAD_ARG);
+  anmatLuFree(&lu);
+
+  expectEquals(anmatMatrixSolveTriangular(ANMAT_UPPER, false,
+                                          &square, &matrix),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixSolveTriangular((AnmatTriangle_t)2, false,
+                                          &square, &other),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixSolveTriangular(ANMAT_UPPER, false,
+                                          &square, &other),
+               ANMAT_SUCCESS);
+
+  anmatMatrixFree(&matrix);
+  anmatMatrixFree(&square);
+  anmatMatrixFree(&other);
+  anmatVectorFree(&vector);
+
+  return 0;
+}
+
+static int factorTest(void)
+{
+  AnmatMatrix_t matrixA, matrixL, matrixU, matrixLU;
+  unsigned int n = 150, rowI, colI, i;
+  double value, *rowA, *rowB;
+  AnmatLu_t lu;
+
+  srand(1);
+
+  // P * L * U = A, so L * U is A with the rows swapped.
+  expectEquals(anmatMatrixAlloc(&matrixA, n, n), ANMAT_SUCCESS);
+  randomFill(&matrixA);
+  expectEquals(anmatLuFactor(&lu, &matrixA), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&matrixL, n, n), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&matrixU, n, n), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&matrixLU, n, n), ANMAT_SUCCESS);
+  for (rowI = 0; rowI < n; rowI ++) {
+    for (colI = 0; colI < n; colI ++) {
+      value = anmatMatrixData(&lu.factors, rowI, colI);
+      if (colI < rowI) {
+        anmatMatrixData(&matrixL, rowI, colI) = value;
+        expect(value >= -1 && value <= 1);
+      } else {
+        anmatMatrixData(&matrixU, rowI, colI) = value;
+      }
+    }
+    anmatMatrixData(&matrixL, rowI, rowI) = 1;
+  }
+  expectEquals(anmatMatrixMultiply(&matrixL, &matrixU, &matrixLU),
+               ANMAT_SUCCESS);
+
+  for (i = 0; i < n; i ++) {
+    expect(lu.pivots[i] >= i && lu.pivots[i] < n);
+    rowA = anmatMatrixRow(&matrixA, i);
+    rowB = anmatMatrixRow(&matrixA, lu.pivots[i]);
+    for (colI = 0; colI < n; colI ++) {
+      value = rowA[colI];
+      rowA[colI] = rowB[colI];
+      rowB[colI] = value;
+    }
+  }
+  expect(!expectClose(&matrixLU, &matrixA, 1e-9));
+
+  anmatLuFree(&lu);
+  anmatMatrixFree(&matrixA);
+  anmatMatrixFree(&matrixL);
+  anmatMatrixFree(&matrixU);
+  anmatMatrixFree(&matrixLU);
+
+  return 0;
+}
+
+static int solveTest(void)
+{
+  AnmatMatrix_t matrixA;
+  AnmatVector_t vectorB, vectorX;
+  unsigned int n = 70, i, k;
+  double total;
+  AnmatLu_t lu;
+
+  srand(2);
+
+  expect(!checkSolve(1, 1));
+  expect(!checkSolve(3, 2));
+  expect(!checkSolve(64, 5));
+  expect(!checkSolve(65, 1));
+  expect(!checkSolve(200, 33));
+
+  // One right hand side.
+  expectEquals(anmatMatrixAlloc(&matrixA, n, n), ANMAT_SUCCESS);
+  randomFill(&matrixA);
+  expectEquals(anmatVectorAlloc(&vectorB, n), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAlloc(&vectorX, n), ANMAT_SUCCESS);
+  for (i = 0; i < n; i ++) {
+    anmatVectorData(&vectorB, i) = randomValue();
+  }
+  expectEquals(anmatLuFactor(&lu, &matrixA), ANMAT_SUCCESS);
+  expectEquals(anmatLuSolveVector(&lu, &vectorB, &vectorX), ANMAT_SUCCESS);
+  for (i = 0; i < n; i ++) {
+    total = 0;
+    for (k = 0; k < n; k ++) {
+      total += (anmatMatrixData(&matrixA, i, k)
+                * anmatVectorData(&vectorX, k));
+    }
+    expectNeighborhood(total, anmatVectorData(&vectorB, i), 1e-8);
+  }
+  expectEquals(anmatLuSolveVector(&lu, &vectorB, &vectorB), ANMAT_SUCCESS);
+  for (i = 0; i < n; i ++) {
+    expectEquals(anmatVectorData(&vectorB, i), anmatVectorData(&vectorX, i));
+  }
+
+  anmatLuFree(&lu);
+  anmatMatrixFree(&matrixA);
+  anmatVectorFree(&vectorB);
+  anmatVectorFree(&vectorX);
+
+  return 0;
+}
+
+static int determinantTest(void)
+{
+  AnmatMatrix_t matrix;
+  AnmatLu_t lu;
+
+  expectEquals(anmatMatrixAlloc(&matrix, 3, 3), ANMAT_SUCCESS);
+
+  // A permutation, which takes two swaps.
+  anmatMatrixData(&matrix, 0, 1) = 1;
+  anmatMatrixData(&matrix, 1, 2) = 1;
+  anmatMatrixData(&matrix, 2, 0) = 1;
+  expectEquals(anmatLuFactor(&lu, &matrix), ANMAT_SUCCESS);
+  expectEquals(lu.sign, 1);
+  expectNeighborhood(anmatLuDeterminant(&lu), 1, 1e-12);
+  anmatLuFree(&lu);
+
+  // One swap.
+  anmatMatrixData(&matrix, 0, 1) = 0;
+  anmatMatrixData(&matrix, 1, 2) = 0;
+  anmatMatrixData(&matrix, 2, 0) = 0;
+  anmatMatrixData(&matrix, 0, 2) = 1;
+  anmatMatrixData(&matrix, 1, 1) = 1;
+  anmatMatrixData(&matrix, 2, 0) = 1;
+  expectEquals(anmatLuFactor(&lu, &matrix), ANMAT_SUCCESS);
+  expectEquals(lu.sign, -1);
+  expectNeighborhood(anmatLuDeterminant(&lu), -1, 1e-12);
+  anmatLuFree(&lu);
+
+  // [ 2 -1 0 ]
+  // [ 4  1 3 ]  has a determinant of 2(1 * 5 - 3 * -2) + 1(4 * 5 - 3 * 1)
+  // [ 1 -2 5 ]  = 22 + 17 = 39.
+  anmatMatrixData(&matrix, 0, 0) = 2;
+  anmatMatrixData(&matrix, 0, 1) = -1;
+  anmatMatrixData(&matrix, 0, 2) = 0;
+  anmatMatrixData(&matrix, 1, 0) = 4;
+  anmatMatrixData(&matrix, 1, 1) = 1;
+  anmatMatrixData(&matrix, 1, 2) = 3;
+  anmatMatrixData(&matrix, 2, 0) = 1;
+  anmatMatrixData(&matrix, 2, 1) = -2;
+  anmatMatrixData(&matrix, 2, 2) = 5;
+  expectEquals(anmatLuFactor(&lu, &matrix), ANMAT_SUCCESS);
+  expectNeighborhood(anmatLuDeterminant(&lu), 39, 1e-12);
+  anmatLuFree(&lu);
+
+  // Make the last row twice the first.
+  anmatMatrixData(&matrix, 2, 0) = 4;
+  anmatMatrixData(&matrix, 2, 1) = -2;
+  anmatMatrixData(&matrix, 2, 2) = 0;
+  expectEquals(anmatLuFactor(&lu, &matrix), ANMAT_SUCCESS);
+  expect(lu.singular);
+  expectNeighborhood(anmatLuDeterminant(&lu), 0, 1e-12);
+  expectEquals(anmatLuSolve(&lu, &matrix, &matrix), ANMAT_BAD_ARG);
+  expectEquals(anmatLuInverse(&lu, &matrix), ANMAT_BAD_ARG);
+  anmatLuFree(&lu);
+
+  anmatMatrixFree(&matrix);
+
+  return 0;
+}
+
+static int inverseTest(void)
+{
+  AnmatMatrix_t matrix, inverse, product, identity;
+  unsigned int n = 100, i;
+  AnmatLu_t lu;
+
+  srand(3);
+
+  expectEquals(anmatMatrixAlloc(&matrix, n, n), ANMAT_SUCCESS);
+  randomFill(&matrix);
+  expectEquals(anmatMatrixAlloc(&inverse, n, n), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&product, n, n), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&identity, n, n), ANMAT_SUCCESS);
+  for (i = 0; i < n; i ++) {
+    anmatMatrixData(&identity, i, i) = 1;
+  }
+
+  expectEquals(anmatLuFactor(&lu, &matrix), ANMAT_SUCCESS);
+  expectEquals(anmatLuInverse(&lu, &inverse), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixMultiply(&matrix, &inverse, &product),
+               ANMAT_SUCCESS);
+  expect(!expectClose(&product, &identity, 1e-9));
+  expectEquals(anmatMatrixMultiply(&inverse, &matrix, &product),
+               ANMAT_SUCCESS);
+  expect(!expectClose(&product, &identity, 1e-9));
+
+  anmatLuFree(&lu);
+  anmatMatrixFree(&matrix);
+  anmatMatrixFree(&inverse);
+  anmatMatrixFree(&product);
+  anmatMatrixFree(&identity);
+
+  return 0;
+}
+
+// Solve with the lower (or upper) triangle of a random n x n matrix, scaled
+// down so that it is well conditioned. The other side of the diagonal is
+// garbage, and so is the diagonal, for a unit triangle.
+static int checkTriangular(AnmatTriangle_t triangle,
+                           bool unit,
+                           unsigned int n,
+                           unsigned int nrhs)
+{
+  AnmatMatrix_t matrixT, matrixX, matrixB;
+  unsigned int rowI, colI, k;
+  double total, t;
+
+  expectEquals(anmatMatrixAlloc(&matrixT, n, n), ANMAT_SUCCESS);
+  randomFill(&matrixT);
+  expectEquals(anmatMatrixAlloc(&matrixX, n, nrhs), ANMAT_SUCCESS);
+  randomFill(&matrixX);
+  expectEquals(anmatMatrixAlloc(&matrixB, n, nrhs), ANMAT_SUCCESS);
+  for (rowI = 0; rowI < n; rowI ++) {
+    for (k = 0; k < n; k ++) {
+      anmatMatrixData(&matrixT, rowI, k) /= (14.0 * n);
+    }
+    anmatMatrixData(&matrixT, rowI, rowI) = (unit ? 1e300 : 2);
+  }
+  for (rowI = 0; rowI < n; rowI ++) {
+    for (colI = 0; colI < nrhs; colI ++) {
+      total = 0;
+      for (k = 0; k < n; k ++) {
+        if (k == rowI) {
+          t = (unit ? 1 : anmatMatrixData(&matrixT, rowI, k));
+        } else if ((triangle == ANMAT_LOWER) == (k < rowI)) {
+          t = anmatMatrixData(&matrixT, rowI, k);
+        } else {
+          t = 0;
+        }
+        total += t * anmatMatrixData(&matrixX, k, colI);
+      }
+      anmatMatrixData(&matrixB, rowI, colI) = total;
+    }
+  }
+
+  expectEquals(anmatMatrixSolveTriangular(triangle, unit, &matrixT, &matrixB),
+               ANMAT_SUCCESS);
+  expect(!expectClose(&matrixB, &matrixX, 1e-9));
+
+  anmatMatrixFree(&matrixT);
+  anmatMatrixFree(&matrixX);
+  anmatMatrixFree(&matrixB);
+
+  return 0;
+}
+
+static int triangularTest(void)
+{
+  srand(4);
+
+  expect(!checkTriangular(ANMAT_LOWER, false, 1, 1));
+  expect(!checkTriangular(ANMAT_UPPER, false, 1, 3));
+  expect(!checkTriangular(ANMAT_LOWER, false, 150, 7));
+  expect(!checkTriangular(ANMAT_UPPER, false, 150, 7));
+  expect(!checkTriangular(ANMAT_LOWER, true, 100, 5));
+  expect(!checkTriangular(ANMAT_UPPER, true, 100, 5));
+
+  return 0;
+}
+
+static int threadTest(void)
+{
+  srand(5);
+
+  // Split every multiply up.
+  anmatThreadCountSet(3);
+  anmatThreadThresholdSet(1);
+
+  expect(!checkSolve(300, 10));
+
+  anmatThreadThresholdSet(0);
+  anmatThreadCountSet(0);
+
+  return 0;
+}
+
+int main(void)
+{
+  announce();
+
+  run(badArgTest);
+  run(factorTest);
+  run(solveTest);
+  run(determinantTest);
+  run(inverseTest);
+  run(triangularTest);
+  run(threadTest);
+
+  return 0;
+}
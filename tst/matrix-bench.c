@@ -0,0 +1,283 @@
+//
+// matrix-bench.c
+//
+// Matrix multiply benchmark.
+//
+// Times anmatMatrixMultiply on square matrices and reports GFLOP/s, next to
+// the transpose and dot product loop that it used to be, next to the float
+// multiply, and next to Strassen-Winograd for big matrices. Then times
+// batches of small multiplies against multiplying the same problems one at a
+// time, and matrix-vector multiplies against multiplying by an n x 1 matrix.
+// Set ANMAT_SIMD_LEVEL to compare the SIMD levels (see simd.h).
+//
+
+#include <stdlib.h> // srand(), rand(), malloc(), free()
+#include <string.h> // memcpy()
+#include <time.h>   // clock_gettime()
+
+#include "anmat.h"
+#include "gemv.h"
+
+static double now(void)
+{
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + (time.tv_nsec / 1e9);
+}
+
+static void fill(AnmatMatrix_t *matrix)
+{
+  unsigned int rowI, colI;
+
+  for (rowI = 0; rowI < anmatMatrixRowCount(matrix); rowI ++) {
+    for (colI = 0; colI < anmatMatrixColCount(matrix); colI ++) {
+      anmatMatrixData(matrix, rowI, colI) = (rand() % 100) / 10.0;
+    }
+  }
+}
+
+// The old multiply: transpose B, then a dot product for every value of C.
+static void naiveMultiply(AnmatMatrix_t *matrixA,
+                          AnmatMatrix_t *matrixB,
+                          AnmatMatrix_t *matrixC)
+{
+  AnmatMatrix_t matrixBT;
+  unsigned int rowI, colI, p;
+  double total, *rowA, *rowBT;
+
+  anmatMatrixAlloc(&matrixBT, matrixB->cols, matrixB->rows);
+  anmatMatrixTranspose(matrixB, &matrixBT);
+  for (rowI = 0; rowI < matrixC->rows; rowI ++) {
+    rowA = anmatMatrixRow(matrixA, rowI);
+    for (colI = 0; colI < matrixC->cols; colI ++) {
+      rowBT = anmatMatrixRow(&matrixBT, colI);
+      total = 0;
+      for (p = 0; p < matrixA->cols; p ++) {
+        total += rowA[p] * rowBT[p];
+      }
+      anmatMatrixData(matrixC, rowI, colI) = total;
+    }
+  }
+  anmatMatrixFree(&matrixBT);
+}
+
+typedef enum {
+  NAIVE,
+  GEMM,
+  GEMM_FLOAT,
+  STRASSEN,
+} Method_t;
+
+static const char *methodNames[] = { "naive", "gemm", "gemmF", "strassen", };
+
+static void bench(unsigned int size, Method_t method)
+{
+  AnmatStrassenConfig_t config = ANMAT_STRASSEN_CONFIG_DEFAULT;
+  AnmatMatrix_t matrixA, matrixB, matrixC;
+  AnmatMatrixF_t matrixAF, matrixBF, matrixCF;
+  double start, elapsed, flops;
+  unsigned int runs = 0;
+
+  anmatMatrixAlloc(&matrixA, size, size);
+  anmatMatrixAlloc(&matrixB, size, size);
+  anmatMatrixAlloc(&matrixC, size, size);
+  anmatMatrixAllocF(&matrixAF, size, size);
+  anmatMatrixAllocF(&matrixBF, size, size);
+  anmatMatrixAllocF(&matrixCF, size, size);
+  fill(&matrixA);
+  fill(&matrixB);
+  anmatMatrixToFloat(&matrixA, &matrixAF);
+  anmatMatrixToFloat(&matrixB, &matrixBF);
+
+  config.enabled = (method == STRASSEN);
+  anmatMatrixStrassenSet(&config);
+
+  start = now();
+  do {
+    if (method == NAIVE) {
+      naiveMultiply(&matrixA, &matrixB, &matrixC);
+    } else if (method == GEMM_FLOAT) {
+      anmatMatrixMultiplyF(&matrixAF, &matrixBF, &matrixCF);
+    } else {
+      anmatMatrixMultiply(&matrixA, &matrixB, &matrixC);
+    }
+    runs ++;
+    elapsed = now() - start;
+  } while (elapsed < 0.5);
+
+  flops = 2.0 * size * size * size * runs;
+  printf("  %-8s %5u x %-5u %8.2f GFLOP/s\n",
+         methodNames[method], size, size, flops / elapsed / 1e9);
+
+  anmatMatrixFree(&matrixA);
+  anmatMatrixFree(&matrixB);
+  anmatMatrixFree(&matrixC);
+  anmatMatrixFreeF(&matrixAF);
+  anmatMatrixFreeF(&matrixBF);
+  anmatMatrixFreeF(&matrixCF);
+}
+
+// A batch of this many small problems.
+#define BATCH_COUNT (10000)
+
+typedef enum {
+  ONE_AT_A_TIME,
+  BATCH_AOS,
+  BATCH_SOA,
+} BatchMethod_t;
+
+static const char *batchMethodNames[] = { "one", "aos", "soa", };
+
+static void benchBatch(unsigned int size, BatchMethod_t method)
+{
+  size_t values = (size_t)BATCH_COUNT * size * size, i;
+  double *a = (double *)malloc(values * sizeof(double));
+  double *b = (double *)malloc(values * sizeof(double));
+  double *c = (double *)malloc(values * sizeof(double));
+  AnmatMatrix_t matrixA, matrixB, matrixC;
+  double start, elapsed;
+  unsigned int runs = 0, p;
+
+  for (i = 0; i < values; i ++) {
+    a[i] = (rand() % 100) / 10.0;
+    b[i] = (rand() % 100) / 10.0;
+  }
+
+  // The problems one at a time get the benefit of the doubt: their matrices
+  // are only allocated once, and just the values are copied in and out.
+  anmatMatrixAlloc(&matrixA, size, size);
+  anmatMatrixAlloc(&matrixB, size, size);
+  anmatMatrixAlloc(&matrixC, size, size);
+
+  start = now();
+  do {
+    if (method == ONE_AT_A_TIME) {
+      for (p = 0; p < BATCH_COUNT; p ++) {
+        for (i = 0; i < size; i ++) {
+          memcpy(anmatMatrixRow(&matrixA, i),
+                 a + ((p * size) + i) * size,
+                 size * sizeof(double));
+          memcpy(anmatMatrixRow(&matrixB, i),
+                 b + ((p * size) + i) * size,
+                 size * sizeof(double));
+        }
+        anmatMatrixMultiply(&matrixA, &matrixB, &matrixC);
+        for (i = 0; i < size; i ++) {
+          memcpy(c + ((p * size) + i) * size,
+                 anmatMatrixRow(&matrixC, i),
+                 size * sizeof(double));
+        }
+      }
+    } else {
+      anmatBatchMultiply((method == BATCH_AOS
+                          ? ANMAT_BATCH_AOS
+                          : ANMAT_BATCH_SOA),
+                         BATCH_COUNT, size, size, size, a, b, c);
+    }
+    runs ++;
+    elapsed = now() - start;
+  } while (elapsed < 0.5);
+
+  printf("  %-8s %5u x %-5u %8.2f M multiplies/s\n",
+         batchMethodNames[method], size, size,
+         (double)BATCH_COUNT * runs / elapsed / 1e6);
+
+  anmatMatrixFree(&matrixA);
+  anmatMatrixFree(&matrixB);
+  anmatMatrixFree(&matrixC);
+  free(a);
+  free(b);
+  free(c);
+}
+
+typedef enum {
+  GEMV_MATRIX,
+  GEMV_NORMAL,
+  GEMV_TRANSPOSE,
+} GemvMethod_t;
+
+static const char *gemvMethodNames[] = { "n x 1", "gemv", "gemvT", };
+
+static void benchGemv(unsigned int size, GemvMethod_t method)
+{
+  AnmatMatrix_t matrixA, matrixX, matrixY;
+  AnmatVector_t vectorX, vectorY;
+  double start, elapsed;
+  unsigned int runs = 0, i;
+
+  anmatMatrixAlloc(&matrixA, size, size);
+  anmatMatrixAlloc(&matrixX, size, 1);
+  anmatMatrixAlloc(&matrixY, size, 1);
+  anmatVectorAlloc(&vectorX, size);
+  anmatVectorAlloc(&vectorY, size);
+  fill(&matrixA);
+  fill(&matrixX);
+  for (i = 0; i < size; i ++) {
+    anmatVectorData(&vectorX, i) = anmatMatrixData(&matrixX, i, 0);
+  }
+
+  start = now();
+  do {
+    if (method == GEMV_MATRIX) {
+      anmatMatrixMultiply(&matrixA, &matrixX, &matrixY);
+    } else {
+      anmatMatrixVectorMultiply((method == GEMV_TRANSPOSE
+                                 ? ANMAT_TRANSPOSE
+                                 : ANMAT_NO_TRANSPOSE),
+                                1, &matrixA, &vectorX, 0, &vectorY);
+    }
+    runs ++;
+    elapsed = now() - start;
+  } while (elapsed < 0.5);
+
+  printf("  %-8s %5u x %-5u %8.2f GFLOP/s\n",
+         gemvMethodNames[method], size, size,
+         2.0 * size * size * runs / elapsed / 1e9);
+
+  anmatMatrixFree(&matrixA);
+  anmatMatrixFree(&matrixX);
+  anmatMatrixFree(&matrixY);
+  anmatVectorFree(&vectorX);
+  anmatVectorFree(&vectorY);
+}
+
+int main(void)
+{
+  static const unsigned int batchSizes[] = { 3, 4, 8, };
+  unsigned int sizeI;
+  unsigned int size;
+
+  printf("matrix-bench: multiply (simd: %s)\n",
+         anmatSimdLevelName(anmatSimdLevelGet()));
+
+  srand(1);
+  for (size = 128; size <= 1024; size <<= 1) {
+    bench(size, NAIVE);
+    bench(size, GEMM);
+    bench(size, GEMM_FLOAT);
+  }
+
+  // Strassen-Winograd only pays off for big matrices. Its GFLOP/s are
+  // counted as if it did all 2n^3 flops, so that the two compare directly.
+  for (size = 2048; size <= 4096; size <<= 1) {
+    bench(size, GEMM);
+    bench(size, STRASSEN);
+  }
+
+  printf("matrix-bench: batched multiply (%u problems)\n", BATCH_COUNT);
+  for (sizeI = 0; sizeI < sizeof(batchSizes) / sizeof(batchSizes[0]);
+       sizeI ++) {
+    benchBatch(batchSizes[sizeI], ONE_AT_A_TIME);
+    benchBatch(batchSizes[sizeI], BATCH_AOS);
+    benchBatch(batchSizes[sizeI], BATCH_SOA);
+  }
+
+  printf("matrix-bench: matrix-vector multiply\n");
+  for (size = 256; size <= 4096; size <<= 2) {
+    benchGemv(size, GEMV_MATRIX);
+    benchGemv(size, GEMV_NORMAL);
+    benchGemv(size, GEMV_TRANSPOSE);
+  }
+
+  return 0;
+}
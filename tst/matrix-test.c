@@ -27,6 +27,8 @@ static void failureHandler(void)
 static int allocTest(void)
 {
   AnmatMatrix_t matrix1, matrix2;
+  HeapStats_t stats;
+  unsigned long allocCount;
 
   // Heap should be fresh.
   expectHeapEmpty();
@@ -40,14 +42,24 @@ static int allocTest(void)
   expectHeapEmpty();
 
   // Rows and cols is good.
+  heapGetStats(&stats);
   expectEquals(anmatMatrixAlloc(&matrix1, 5, 5), ANMAT_SUCCESS);
 
+  // One allocation for all of it.
+  allocCount = stats.allocCount;
+  heapGetStats(&stats);
+  expectEquals(stats.allocCount - allocCount, 1);
+
+  // The data should be aligned.
+  expectAligned(anmatMatrixRow(&matrix1, 0), ANMAT_DATA_ALIGNMENT);
+
+  // Rows shorter than the alignment are not padded.
+  expectEquals(matrix1.stride, 5);
+
   // Heap should be missing some bytes.
   expectHeapSize(HEAP_SIZE
                  // 5 rows, with 1 alloc byte
-                 - (5 * sizeof(double *)) - 1
-                 // 5 rows with 5 doubles plus an alloc byte each
-                 - 5 * ((5 * sizeof(double)) + 1)
+                 - (5 * matrix1.stride * sizeof(double)) - 1
                  - 0);
 
   // Free.
@@ -89,10 +101,10 @@ static int dataTest(void)
 
   // Data.
   anmatMatrixData(&matrixA, 0, 0) = 5;
-  expectEquals(matrixA.data[0][0], 5);
+  expectEquals(matrixA.data[0], 5);
   expectEquals(anmatMatrixData(&matrixA, 0, 0), 5);
   anmatMatrixData(&matrixB, 1, 4) = 10.123;
-  expectEquals(matrixB.data[1][4], 10.123);
+  expectEquals(matrixB.data[matrixB.stride + 4], 10.123);
   expectEquals(anmatMatrixData(&matrixB, 1, 4), 10.123);
 
   // Free.
@@ -172,6 +184,16 @@ static int elemOpTest(void)
   expect(anmatMatrixData(&matrixE, 2, 0) == -1);
   expect(anmatMatrixData(&matrixE, 2, 2) == -1);
 
+  // Multiplication works when nothing is square.
+  anmatMatrixFree(&matrixE);
+  expectEquals(anmatMatrixAlloc(&matrixE, 3, 3), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixMultiply(&matrixA, &matrixD, &matrixE), ANMAT_SUCCESS);
+  anmatMatrixData(&matrixD, 3, 0) = 2;
+  anmatMatrixData(&matrixA, 1, 3) = 4;
+  expectEquals(anmatMatrixMultiply(&matrixA, &matrixD, &matrixE), ANMAT_SUCCESS);
+  expect(anmatMatrixData(&matrixE, 1, 0) == 4 * 2);
+  expect(anmatMatrixData(&matrixE, 0, 0) == 0);
+
   // Free.
   anmatMatrixFree(&matrixA);
   anmatMatrixFree(&matrixB);
@@ -185,6 +207,99 @@ static int elemOpTest(void)
   return 0;
 }
 
+static int fusedOpTest(void)
+{
+  AnmatMatrix_t matrixA, matrixB, matrixC, matrixD;
+
+  // Heap should be full.
+  expectHeapEmpty();
+
+  expectEquals(anmatMatrixAlloc(&matrixA, 2, 3), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&matrixB, 2, 3), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&matrixC, 2, 3), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&matrixD, 3, 2), ANMAT_SUCCESS);
+
+  // Can't do things with wrong dimensions.
+  expectEquals(anmatMatrixScale(&matrixA, 2, &matrixD), ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixAxpy(2, &matrixA, &matrixD, &matrixC), ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixAxpby(2, &matrixA, 3, &matrixB, &matrixD),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixHadamardMultiply(&matrixD, &matrixB, &matrixC),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixHadamardDivide(&matrixA, &matrixD, &matrixC),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixClamp(&matrixA, 0, 1, &matrixD), ANMAT_BAD_ARG);
+
+  // A = [1 2 3; 4 5 6], B = [-2 4 -8; 0.5 1 2].
+  anmatMatrixData(&matrixA, 0, 0) = 1;
+  anmatMatrixData(&matrixA, 0, 1) = 2;
+  anmatMatrixData(&matrixA, 0, 2) = 3;
+  anmatMatrixData(&matrixA, 1, 0) = 4;
+  anmatMatrixData(&matrixA, 1, 1) = 5;
+  anmatMatrixData(&matrixA, 1, 2) = 6;
+  anmatMatrixData(&matrixB, 0, 0) = -2;
+  anmatMatrixData(&matrixB, 0, 1) = 4;
+  anmatMatrixData(&matrixB, 0, 2) = -8;
+  anmatMatrixData(&matrixB, 1, 0) = 0.5;
+  anmatMatrixData(&matrixB, 1, 1) = 1;
+  anmatMatrixData(&matrixB, 1, 2) = 2;
+
+  // Scale.
+  expectEquals(anmatMatrixScale(&matrixA, -3, &matrixC), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixData(&matrixC, 0, 0), -3);
+  expectEquals(anmatMatrixData(&matrixC, 1, 2), -18);
+
+  // Axpy.
+  expectEquals(anmatMatrixAxpy(2, &matrixA, &matrixB, &matrixC), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixData(&matrixC, 0, 0), 0);
+  expectEquals(anmatMatrixData(&matrixC, 0, 2), -2);
+  expectEquals(anmatMatrixData(&matrixC, 1, 0), 8.5);
+
+  // Axpby.
+  expectEquals(anmatMatrixAxpby(0.5, &matrixA, -2, &matrixB, &matrixC),
+               ANMAT_SUCCESS);
+  expectEquals(anmatMatrixData(&matrixC, 0, 0), 4.5);
+  expectEquals(anmatMatrixData(&matrixC, 0, 1), -7);
+  expectEquals(anmatMatrixData(&matrixC, 1, 2), -1);
+
+  // Hadamard multiply and divide.
+  expectEquals(anmatMatrixHadamardMultiply(&matrixA, &matrixB, &matrixC),
+               ANMAT_SUCCESS);
+  expectEquals(anmatMatrixData(&matrixC, 0, 2), -24);
+  expectEquals(anmatMatrixData(&matrixC, 1, 0), 2);
+  expectEquals(anmatMatrixHadamardDivide(&matrixA, &matrixB, &matrixC),
+               ANMAT_SUCCESS);
+  expectEquals(anmatMatrixData(&matrixC, 0, 1), 0.5);
+  expectEquals(anmatMatrixData(&matrixC, 1, 0), 8);
+
+  // Clamp, and only to a range that makes sense.
+  expectEquals(anmatMatrixClamp(&matrixB, -1, 1, &matrixC), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixData(&matrixC, 0, 0), -1);
+  expectEquals(anmatMatrixData(&matrixC, 0, 1), 1);
+  expectEquals(anmatMatrixData(&matrixC, 1, 0), 0.5);
+  expectEquals(anmatMatrixClamp(&matrixB, 1, -1, &matrixC), ANMAT_BAD_ARG);
+
+  // Any of them can happen in place.
+  expectEquals(anmatMatrixAxpby(1, &matrixA, 1, &matrixB, &matrixA),
+               ANMAT_SUCCESS);
+  expectEquals(anmatMatrixData(&matrixA, 0, 2), -5);
+  expectEquals(anmatMatrixHadamardMultiply(&matrixA, &matrixB, &matrixB),
+               ANMAT_SUCCESS);
+  expectEquals(anmatMatrixData(&matrixB, 0, 2), 40);
+  expectEquals(anmatMatrixScale(&matrixB, 0.25, &matrixB), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixData(&matrixB, 0, 2), 10);
+
+  anmatMatrixFree(&matrixA);
+  anmatMatrixFree(&matrixB);
+  anmatMatrixFree(&matrixC);
+  anmatMatrixFree(&matrixD);
+
+  // Heap should be full.
+  expectHeapEmpty();
+
+  return 0;
+}
+
 static int transposeTest(void)
 {
   AnmatMatrix_t matrixA, matrixB, matrixC, matrixD;
@@ -229,6 +344,128 @@ static int transposeTest(void)
   return 0;
 }
 
+// Fill a matrix with values that say where they are.
+static void fillPositions(AnmatMatrix_t *matrix)
+{
+  unsigned int rowI, colI;
+
+  for (rowI = 0; rowI < anmatMatrixRowCount(matrix); rowI ++) {
+    for (colI = 0; colI < anmatMatrixColCount(matrix); colI ++) {
+      anmatMatrixData(matrix, rowI, colI) = (rowI * 1000.0) + colI;
+    }
+  }
+}
+
+// Whether a matrix is a rows x cols matrix filled by fillPositions, or the
+// transpose of one.
+static bool isPositions(AnmatMatrix_t *matrix,
+                        unsigned int rows,
+                        unsigned int cols,
+                        bool transposed)
+{
+  unsigned int rowI, colI;
+  double expected;
+
+  if (anmatMatrixRowCount(matrix) != (transposed ? cols : rows)
+      || anmatMatrixColCount(matrix) != (transposed ? rows : cols)) {
+    return false;
+  }
+  for (rowI = 0; rowI < anmatMatrixRowCount(matrix); rowI ++) {
+    for (colI = 0; colI < anmatMatrixColCount(matrix); colI ++) {
+      expected = (transposed
+                  ? (colI * 1000.0) + rowI
+                  : (rowI * 1000.0) + colI);
+      if (anmatMatrixData(matrix, rowI, colI) != expected) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+static int bigTransposeTest(void)
+{
+  // Bigger than the blocks that the transpose splits into, and not a
+  // multiple of them.
+  static const unsigned int sizes[][2] = {
+    { 100, 77, }, { 77, 100, }, { 33, 300, }, { 1, 129, }, { 64, 64, },
+  };
+  AnmatMatrix_t matrixA, matrixB;
+  unsigned int sizeI, rows, cols;
+
+  for (sizeI = 0; sizeI < sizeof(sizes) / sizeof(sizes[0]); sizeI ++) {
+    rows = sizes[sizeI][0];
+    cols = sizes[sizeI][1];
+    expectEquals(anmatMatrixAlloc(&matrixA, rows, cols), ANMAT_SUCCESS);
+    expectEquals(anmatMatrixAlloc(&matrixB, cols, rows), ANMAT_SUCCESS);
+    fillPositions(&matrixA);
+    expectEquals(anmatMatrixTranspose(&matrixA, &matrixB), ANMAT_SUCCESS);
+    expect(isPositions(&matrixB, rows, cols, true));
+    anmatMatrixFree(&matrixA);
+    anmatMatrixFree(&matrixB);
+  }
+
+  return 0;
+}
+
+static int transposeInPlaceTest(void)
+{
+  static const unsigned int sizes[][2] = {
+    // Square.
+    { 1, 1, }, { 5, 5, }, { 32, 32, }, { 75, 75, },
+    // Not square, with and without room for padded rows afterwards.
+    { 2, 3, }, { 3, 9, }, { 9, 3, }, { 37, 20, }, { 1, 13, }, { 13, 1, },
+    { 64, 8, }, { 100, 77, },
+  };
+  AnmatMatrix_t matrix, view;
+  unsigned int sizeI, rows, cols, rowI;
+
+  for (sizeI = 0; sizeI < sizeof(sizes) / sizeof(sizes[0]); sizeI ++) {
+    rows = sizes[sizeI][0];
+    cols = sizes[sizeI][1];
+    expectEquals(anmatMatrixAlloc(&matrix, rows, cols), ANMAT_SUCCESS);
+    fillPositions(&matrix);
+    expectEquals(anmatMatrixTransposeInPlace(&matrix), ANMAT_SUCCESS);
+    expect(isPositions(&matrix, rows, cols, true));
+    expect(matrix.stride >= matrix.cols);
+
+    // And back again.
+    expectEquals(anmatMatrixTransposeInPlace(&matrix), ANMAT_SUCCESS);
+    expect(isPositions(&matrix, rows, cols, false));
+    anmatMatrixFree(&matrix);
+  }
+
+  // Padded rows still start on the alignment, with 0's in the padding.
+  expectEquals(anmatMatrixAlloc(&matrix, 37, 20), ANMAT_SUCCESS);
+  fillPositions(&matrix);
+  expectEquals(anmatMatrixTransposeInPlace(&matrix), ANMAT_SUCCESS);
+  expectEquals(matrix.stride, 40);
+  for (rowI = 0; rowI < matrix.rows; rowI ++) {
+    expectAligned(anmatMatrixRow(&matrix, rowI), ANMAT_DATA_ALIGNMENT);
+    expectEquals(anmatMatrixRow(&matrix, rowI)[39], 0);
+  }
+  anmatMatrixFree(&matrix);
+
+  // A square view is transposed inside of its matrix, but other views are not
+  // allowed.
+  expectEquals(anmatMatrixAlloc(&matrix, 50, 50), ANMAT_SUCCESS);
+  fillPositions(&matrix);
+  expectEquals(anmatMatrixView(&view, &matrix, 10, 5, 40, 40), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixTransposeInPlace(&view), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixData(&matrix, 10, 6), (11 * 1000.0) + 5);
+  expectEquals(anmatMatrixData(&matrix, 49, 44), (49 * 1000.0) + 44);
+  expectEquals(anmatMatrixData(&matrix, 9, 6), (9 * 1000.0) + 6);
+  expectEquals(anmatMatrixView(&view, &matrix, 0, 0, 20, 30), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixTransposeInPlace(&view), ANMAT_BAD_ARG);
+  anmatMatrixFree(&matrix);
+
+  // Heap should be full.
+  expectHeapEmpty();
+
+  return 0;
+}
+
 static int ioTest(void)
 {
   AnmatMatrix_t matrixA, matrixB;
@@ -242,10 +479,8 @@ static int ioTest(void)
 
   // We should be missing some bytes from the heap.
   expectHeapSize(HEAP_SIZE
-                 // 11 rows, with 1 alloc byte
-                 - (11 * sizeof(double)) - 1
-                 // 11 numbers in each row, each with an alloc byte
-                 - (11 * ((11 * sizeof(double)) + 1))
+                 // 11 rows of 11 numbers padded out to 16, with 1 alloc byte
+                 - (11 * 16 * sizeof(double)) - 1
                  - 0);
 
   // Set data.
@@ -287,6 +522,89 @@ static int ioTest(void)
   return 0;
 }
 
+static int viewTest(void)
+{
+  AnmatMatrix_t matrix, viewA, viewB, matrixC, matrixD;
+  unsigned int rowI, colI;
+  FILE *stream;
+
+  // Heap should be full.
+  expectHeapEmpty();
+
+  expectEquals(anmatMatrixAlloc(&matrix, 4, 5), ANMAT_SUCCESS);
+  for (rowI = 0; rowI < 4; rowI ++) {
+    for (colI = 0; colI < 5; colI ++) {
+      anmatMatrixData(&matrix, rowI, colI) = (rowI * 10) + colI;
+    }
+  }
+
+  // Blocks that don't fit are bad.
+  expectEquals(anmatMatrixView(&viewA, &matrix, 0, 0, 0, 1), ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixView(&viewA, &matrix, 4, 0, 1, 1), ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixView(&viewA, &matrix, 0, 3, 1, 3), ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixRowRange(&viewA, &matrix, 2, 3), ANMAT_BAD_ARG);
+
+  // A view looks at the matrix, and writes go through to it.
+  expectEquals(anmatMatrixView(&viewA, &matrix, 1, 2, 2, 3), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixRowCount(&viewA), 2);
+  expectEquals(anmatMatrixColCount(&viewA), 3);
+  expectEquals(anmatMatrixData(&viewA, 0, 0), 12);
+  expectEquals(anmatMatrixData(&viewA, 1, 2), 24);
+  anmatMatrixData(&viewA, 1, 1) = -1;
+  expectEquals(anmatMatrixData(&matrix, 2, 3), -1);
+
+  // Row and column ranges.
+  expectEquals(anmatMatrixRowRange(&viewA, &matrix, 3, 1), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixColCount(&viewA), 5);
+  expectEquals(anmatMatrixData(&viewA, 0, 4), 34);
+  expectEquals(anmatMatrixColRange(&viewB, &matrix, 4, 1), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixRowCount(&viewB), 4);
+  expectEquals(anmatMatrixData(&viewB, 2, 0), 24);
+
+  // Operations take views.
+  expectEquals(anmatMatrixView(&viewA, &matrix, 0, 0, 2, 2), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixView(&viewB, &matrix, 2, 3, 2, 2), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&matrixC, 2, 2), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAdd(&viewA, &viewB, &matrixC), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixData(&matrixC, 0, 0), 0 + -1);
+  expectEquals(anmatMatrixData(&matrixC, 1, 1), 11 + 34);
+  expectEquals(anmatMatrixTranspose(&viewB, &matrixC), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixData(&matrixC, 0, 1), 33);
+  expectEquals(anmatMatrixData(&matrixC, 1, 0), 24);
+  expectEquals(anmatMatrixMultiply(&viewA, &viewB, &matrixC), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixData(&matrixC, 0, 0), (0 * -1) + (1 * 33));
+  expectEquals(anmatMatrixData(&matrixC, 1, 1), (10 * 24) + (11 * 34));
+
+  // Writing into a view of a bigger matrix.
+  expectEquals(anmatMatrixView(&viewA, &matrix, 2, 0, 2, 2), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAdd(&matrixC, &matrixC, &viewA), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixData(&matrix, 2, 0), 2 * 33);
+  expectEquals(anmatMatrixData(&matrix, 2, 2), 22);
+
+  // Printing a view prints just the block.
+  stream = tmpfile();
+  expect(stream != NULL);
+  expectEquals(anmatMatrixPrint(&viewB, stream), ANMAT_SUCCESS);
+  rewind(stream);
+  expectEquals(anmatMatrixScan(&matrixD, stream), ANMAT_SUCCESS);
+  fclose(stream);
+  expect(anmatMatrixEquals(&matrixD, &viewB));
+
+  // Freeing a view does nothing.
+  anmatMatrixFree(&viewA);
+  anmatMatrixFree(&viewB);
+  expectEquals(anmatMatrixData(&matrix, 3, 4), 34);
+
+  anmatMatrixFree(&matrix);
+  anmatMatrixFree(&matrixC);
+  anmatMatrixFree(&matrixD);
+
+  // Heap should be full.
+  expectHeapEmpty();
+
+  return 0;
+}
+
 int main(void)
 {
   announce();
@@ -296,8 +614,12 @@ int main(void)
   run(allocTest);
   run(dataTest);
   run(elemOpTest);
+  run(fusedOpTest);
   run(transposeTest);
+  run(bigTransposeTest);
+  run(transposeInPlaceTest);
   run(ioTest);
+  run(viewTest);
 
   return 0;
 }
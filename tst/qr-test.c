@@ -0,0 +1,335 @@
+//
+// qr-test.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// QR unit test.
+//
+
+#include <unit-test.h>
+#include <stdlib.h>   // srand()
+
+#include "qr.h"
+#include "matrix.h"
+#include "stat.h"
+#include "thread.h"
+
+#include "./test-util.h"
+
+// Check that Q * R is the matrix, by applying H(n - 1), ..., H(0) to each
+// column of R.
+static int checkFactor(AnmatQr_t *qr, AnmatMatrix_t *matrix)
+{
+  AnmatMatrix_t *factors = &qr->factors;
+  unsigned int m = factors->rows, n = factors->cols, i, j, col;
+  double column[300], total;
+
+  expect(m <= 300);
+
+  for (col = 0; col < n; col ++) {
+    for (i = 0; i < m; i ++) {
+      column[i] = (i <= col ? anmatMatrixData(factors, i, col) : 0);
+    }
+    for (j = n; j-- > 0; ) {
+      total = column[j];
+      for (i = j + 1; i < m; i ++) {
+        total += anmatMatrixData(factors, i, j) * column[i];
+      }
+      total *= qr->tau[j];
+      column[j] -= total;
+      for (i = j + 1; i < m; i ++) {
+        column[i] -= total * anmatMatrixData(factors, i, j);
+      }
+    }
+    for (i = 0; i < m; i ++) {
+      expectNeighborhood(column[i], anmatMatrixData(matrix, i, col), 1e-9);
+    }
+  }
+
+  return 0;
+}
+
+// Check that A' * (A * X - B) is 0, which is what makes X the least squares
+// solution.
+static int checkSolution(AnmatMatrix_t *matrixA,
+                         AnmatMatrix_t *matrixB,
+                         AnmatMatrix_t *matrixX)
+{
+  unsigned int m = matrixA->rows, n = matrixA->cols, k = matrixB->cols;
+  unsigned int i, j, l;
+  double residual[300], total;
+
+  expect(m <= 300);
+
+  for (l = 0; l < k; l ++) {
+    for (i = 0; i < m; i ++) {
+      residual[i] = -anmatMatrixData(matrixB, i, l);
+      for (j = 0; j < n; j ++) {
+        residual[i] += (anmatMatrixData(matrixA, i, j)
+                        * anmatMatrixData(matrixX, j, l));
+      }
+    }
+    for (j = 0; j < n; j ++) {
+      total = 0;
+      for (i = 0; i < m; i ++) {
+        total += anmatMatrixData(matrixA, i, j) * residual[i];
+      }
+      expectNeighborhood(total, 0, 1e-8);
+    }
+  }
+
+  return 0;
+}
+
+static int badArgTest(void)
+{
+  AnmatMatrix_t matrixA, matrixB, matrixX;
+  AnmatVector_t vectorB, vectorX;
+  AnmatQr_t qr;
+
+  // More cols than rows.
+  expectEquals(anmatMatrixAlloc(&matrixA, 3, 4), ANMAT_SUCCESS);
+  randomFill(&matrixA);
+  expectEquals(anmatQrFactor(&qr, &matrixA), ANMAT_BAD_ARG);
+  expectEquals(anmatMatrixAlloc(&matrixB, 3, 2), ANMAT_SUCCESS);
+  randomFill(&matrixB);
+  expectEquals(anmatMatrixAlloc(&matrixX, 4, 2), ANMAT_SUCCESS);
+  expectEquals(anmatLeastSquares(ANMAT_QR_BLOCKED,
+                                 &matrixA, &matrixB, &matrixX),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatLeastSquares(ANMAT_QR_TSQR,
+                                 &matrixA, &matrixB, &matrixX),
+               ANMAT_BAD_ARG);
+  anmatMatrixFree(&matrixA);
+  anmatMatrixFree(&matrixB);
+  anmatMatrixFree(&matrixX);
+
+  expectEquals(anmatMatrixAlloc(&matrixA, 5, 3), ANMAT_SUCCESS);
+  randomFill(&matrixA);
+  expectEquals(anmatMatrixAlloc(&matrixB, 5, 2), ANMAT_SUCCESS);
+  randomFill(&matrixB);
+  expectEquals(anmatMatrixAlloc(&matrixX, 3, 2), ANMAT_SUCCESS);
+  expectEquals(anmatLeastSquares((AnmatQrMode_t)2,
+                                 &matrixA, &matrixB, &matrixX),
+               ANMAT_BAD_ARG);
+
+  // Dimensions that do not match.
+  expectEquals(anmatQrFactor(&qr, &matrixA), ANMAT_SUCCESS);
+  expectEquals(anmatQrSolve(&qr, &matrixX, &matrixX), ANMAT_BAD_ARG);
+  expectEquals(anmatQrSolve(&qr, &matrixB, &matrixB), ANMAT_BAD_ARG);
+  expectEquals(anmatLeastSquares(ANMAT_QR_TSQR,
+                                 &matrixA, &matrixX, &matrixX),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatVectorAlloc(&vectorB, 4), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAlloc(&vectorX, 3), ANMAT_SUCCESS);
+  expectEquals(anmatQrSolveVector(&qr, &vectorB, &vectorX), ANMAT_BAD_ARG);
+  anmatQrFree(&qr);
+
+  // Rank deficient: a column of 0's.
+  anmatMatrixData(&matrixA, 0, 0) = 0;
+  anmatMatrixData(&matrixA, 1, 0) = 0;
+  anmatMatrixData(&matrixA, 2, 0) = 0;
+  anmatMatrixData(&matrixA, 3, 0) = 0;
+  anmatMatrixData(&matrixA, 4, 0) = 0;
+  expectEquals(anmatQrFactor(&qr, &matrixA), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixData(&qr.factors, 0, 0), 0);
+  expectEquals(anmatQrSolve(&qr, &matrixB, &matrixX), ANMAT_BAD_ARG);
+  anmatQrFree(&qr);
+  expectEquals(anmatLeastSquares(ANMAT_QR_BLOCKED,
+                                 &matrixA, &matrixB, &matrixX),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatLeastSquares(ANMAT_QR_TSQR,
+                                 &matrixA, &matrixB, &matrixX),
+               ANMAT_BAD_ARG);
+
+  anmatMatrixFree(&matrixA);
+  anmatMatrixFree(&matrixB);
+  anmatMatrixFree(&matrixX);
+  anmatVectorFree(&vectorB);
+  anmatVectorFree(&vectorX);
+
+  return 0;
+}
+
+static int factorTest(void)
+{
+  // Less than a block, across blocks, and square.
+  unsigned int sizes[][2] = { { 1, 1 }, { 5, 3 }, { 150, 70 }, { 200, 200 } };
+  AnmatMatrix_t matrix;
+  unsigned int i;
+  AnmatQr_t qr;
+
+  srand(1);
+
+  for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i ++) {
+    expectEquals(anmatMatrixAlloc(&matrix, sizes[i][0], sizes[i][1]),
+                 ANMAT_SUCCESS);
+    randomFill(&matrix);
+    expectEquals(anmatQrFactor(&qr, &matrix), ANMAT_SUCCESS);
+    expect(!checkFactor(&qr, &matrix));
+    anmatQrFree(&qr);
+    anmatMatrixFree(&matrix);
+  }
+
+  return 0;
+}
+
+static int solveTest(void)
+{
+  AnmatMatrix_t matrixA, matrixB, matrixX;
+  AnmatVector_t vectorB, vectorX;
+  unsigned int m = 250, n = 90, nrhs = 7, i, j, k;
+  double total;
+  AnmatQr_t qr;
+
+  srand(2);
+
+  expectEquals(anmatMatrixAlloc(&matrixA, m, n), ANMAT_SUCCESS);
+  randomFill(&matrixA);
+  expectEquals(anmatMatrixAlloc(&matrixB, m, nrhs), ANMAT_SUCCESS);
+  randomFill(&matrixB);
+  expectEquals(anmatMatrixAlloc(&matrixX, n, nrhs), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAlloc(&vectorB, m), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAlloc(&vectorX, n), ANMAT_SUCCESS);
+  for (i = 0; i < m; i ++) {
+    anmatVectorData(&vectorB, i) = anmatMatrixData(&matrixB, i, 0);
+  }
+
+  expectEquals(anmatQrFactor(&qr, &matrixA), ANMAT_SUCCESS);
+  expectEquals(anmatQrSolve(&qr, &matrixB, &matrixX), ANMAT_SUCCESS);
+  expect(!checkSolution(&matrixA, &matrixB, &matrixX));
+
+  expectEquals(anmatQrSolveVector(&qr, &vectorB, &vectorX), ANMAT_SUCCESS);
+  for (i = 0; i < n; i ++) {
+    expectNeighborhood(anmatVectorData(&vectorX, i),
+                       anmatMatrixData(&matrixX, i, 0),
+                       1e-12);
+  }
+
+  // When B is in the range of A, the solution is exact.
+  for (i = 0; i < m; i ++) {
+    for (j = 0; j < nrhs; j ++) {
+      total = 0;
+      for (k = 0; k < n; k ++) {
+        total += anmatMatrixData(&matrixA, i, k) * (k + j);
+      }
+      anmatMatrixData(&matrixB, i, j) = total;
+    }
+  }
+  expectEquals(anmatQrSolve(&qr, &matrixB, &matrixX), ANMAT_SUCCESS);
+  for (k = 0; k < n; k ++) {
+    for (j = 0; j < nrhs; j ++) {
+      expectNeighborhood(anmatMatrixData(&matrixX, k, j), k + j, 1e-9);
+    }
+  }
+
+  anmatQrFree(&qr);
+  anmatMatrixFree(&matrixA);
+  anmatMatrixFree(&matrixB);
+  anmatMatrixFree(&matrixX);
+  anmatVectorFree(&vectorB);
+  anmatVectorFree(&vectorX);
+
+  return 0;
+}
+
+static int leastSquaresTest(void)
+{
+  AnmatMatrix_t matrixA, matrixB, matrixX, matrixY;
+  unsigned int m = 300, n = 40, nrhs = 3, i, j;
+
+  srand(3);
+
+  expectEquals(anmatMatrixAlloc(&matrixA, m, n), ANMAT_SUCCESS);
+  randomFill(&matrixA);
+  expectEquals(anmatMatrixAlloc(&matrixB, m, nrhs), ANMAT_SUCCESS);
+  randomFill(&matrixB);
+  expectEquals(anmatMatrixAlloc(&matrixX, n, nrhs), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&matrixY, n, nrhs), ANMAT_SUCCESS);
+
+  expectEquals(anmatLeastSquares(ANMAT_QR_BLOCKED,
+                                 &matrixA, &matrixB, &matrixX),
+               ANMAT_SUCCESS);
+  expect(!checkSolution(&matrixA, &matrixB, &matrixX));
+  expectEquals(anmatLeastSquares(ANMAT_QR_TSQR,
+                                 &matrixA, &matrixB, &matrixY),
+               ANMAT_SUCCESS);
+  expect(!checkSolution(&matrixA, &matrixB, &matrixY));
+  for (i = 0; i < n; i ++) {
+    for (j = 0; j < nrhs; j ++) {
+      expectNeighborhood(anmatMatrixData(&matrixX, i, j),
+                         anmatMatrixData(&matrixY, i, j),
+                         1e-10);
+    }
+  }
+
+  anmatMatrixFree(&matrixA);
+  anmatMatrixFree(&matrixB);
+  anmatMatrixFree(&matrixX);
+  anmatMatrixFree(&matrixY);
+
+  return 0;
+}
+
+static int threadTest(void)
+{
+  AnmatMatrix_t matrixA, matrixB, matrixX, matrixY;
+  unsigned int m = 300, n = 40, nrhs = 3, i, j;
+  AnmatQr_t qr;
+
+  srand(4);
+
+  // Split every multiply up, and the rows of A into blocks for TSQR.
+  anmatThreadCountSet(3);
+  anmatThreadThresholdSet(1);
+
+  expectEquals(anmatMatrixAlloc(&matrixA, m, n), ANMAT_SUCCESS);
+  randomFill(&matrixA);
+  expectEquals(anmatMatrixAlloc(&matrixB, m, nrhs), ANMAT_SUCCESS);
+  randomFill(&matrixB);
+  expectEquals(anmatMatrixAlloc(&matrixX, n, nrhs), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&matrixY, n, nrhs), ANMAT_SUCCESS);
+
+  expectEquals(anmatQrFactor(&qr, &matrixA), ANMAT_SUCCESS);
+  expect(!checkFactor(&qr, &matrixA));
+  expectEquals(anmatQrSolve(&qr, &matrixB, &matrixX), ANMAT_SUCCESS);
+  expect(!checkSolution(&matrixA, &matrixB, &matrixX));
+  anmatQrFree(&qr);
+
+  expectEquals(anmatLeastSquares(ANMAT_QR_TSQR,
+                                 &matrixA, &matrixB, &matrixY),
+               ANMAT_SUCCESS);
+  expect(!checkSolution(&matrixA, &matrixB, &matrixY));
+  for (i = 0; i < n; i ++) {
+    for (j = 0; j < nrhs; j ++) {
+      expectNeighborhood(anmatMatrixData(&matrixX, i, j),
+                         anmatMatrixData(&matrixY, i, j),
+                         1e-10);
+    }
+  }
+
+  anmatMatrixFree(&matrixA);
+  anmatMatrixFree(&matrixB);
+  anmatMatrixFree(&matrixX);
+  anmatMatrixFree(&matrixY);
+
+  anmatThreadThresholdSet(0);
+  anmatThreadCountSet(0);
+
+  return 0;
+}
+
+int main(void)
+{
+  announce();
+
+  run(badArgTest);
+  run(factorTest);
+  run(solveTest);
+  run(leastSquaresTest);
+  run(threadTest);
+
+  return 0;
+}
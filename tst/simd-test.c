@@ -0,0 +1,259 @@
+//
+// simd-test.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// SIMD unit test.
+//
+// Every kernel at every level that this processor supports is checked against
+// the textbook loop, on sizes that are not a multiple of any vector or tile.
+//
+
+#include <unit-test.h>
+#include <string.h>   // strcmp()
+#include <stdlib.h>   // srand()
+
+#include "simd.h"
+#include "src/kernels.h"
+#include "src/gemm.h"
+
+#include "./test-util.h"
+
+#define MAX_ROWS (45)
+#define MAX_COLS (37)
+#define PAD      (3)
+
+static double a[MAX_ROWS * (MAX_COLS + PAD)];
+static double b[MAX_ROWS * (MAX_COLS + PAD)];
+static double c[MAX_ROWS * (MAX_COLS + PAD)];
+static double expected[MAX_ROWS * (MAX_COLS + PAD)];
+
+static const AnmatSimdLevel_t levels[] = {
+  ANMAT_SIMD_PORTABLE,
+  ANMAT_SIMD_AVX2,
+  ANMAT_SIMD_AVX512,
+};
+#define LEVEL_COUNT (sizeof(levels) / sizeof(levels[0]))
+
+#define FOR_SUPPORTED_LEVEL(levelI)                             \
+  for (levelI = 0; levelI < LEVEL_COUNT; levelI ++)             \
+    if (anmatSimdLevelSupported(levels[levelI])                 \
+        && anmatSimdLevelSet(levels[levelI]) == ANMAT_SUCCESS)
+
+static int levelTest(void)
+{
+  AnmatSimdLevel_t best;
+  unsigned int levelI;
+
+  // Something is always picked, and it is never auto.
+  best = anmatSimdLevelGet();
+  expect(best != ANMAT_SIMD_AUTO);
+  expect(anmatSimdLevelSupported(best));
+
+  // Portable C works everywhere.
+  expect(anmatSimdLevelSupported(ANMAT_SIMD_PORTABLE));
+  expectEquals(anmatSimdLevelSet(ANMAT_SIMD_PORTABLE), ANMAT_SUCCESS);
+  expectEquals(anmatSimdLevelGet(), ANMAT_SIMD_PORTABLE);
+
+  // Levels that the processor does not have are turned down, and the level
+  // in use stays the same.
+  for (levelI = 0; levelI < LEVEL_COUNT; levelI ++) {
+    if (!anmatSimdLevelSupported(levels[levelI])) {
+      expectEquals(anmatSimdLevelSet(levels[levelI]), ANMAT_BAD_ARG);
+      expectEquals(anmatSimdLevelGet(), ANMAT_SIMD_PORTABLE);
+    }
+  }
+  expectEquals(anmatSimdLevelSet((AnmatSimdLevel_t)42), ANMAT_BAD_ARG);
+
+  // Auto goes back to the best (unless the environment forced something).
+  expectEquals(anmatSimdLevelSet(ANMAT_SIMD_AUTO), ANMAT_SUCCESS);
+  expect(anmatSimdLevelGet() >= best);
+
+  // Names.
+  expectEquals(strcmp(anmatSimdLevelName(ANMAT_SIMD_PORTABLE), "portable"), 0);
+  expectEquals(strcmp(anmatSimdLevelName(ANMAT_SIMD_AVX2), "avx2"), 0);
+  expectEquals(strcmp(anmatSimdLevelName(ANMAT_SIMD_AVX512), "avx512"), 0);
+  expect(anmatSimdLevelName((AnmatSimdLevel_t)42) == NULL);
+
+  return 0;
+}
+
+// Check one element-wise kernel against the loop in expectedValue, at every
+// count up to MAX_COLS, into c and in place into a. Nothing is divided by 0.
+// The kernels may use FMA instructions, so they can be off by a rounding.
+#define checkElementwise(call, inPlaceCall, expectedValue)      \
+  do {                                                          \
+    unsigned int count_, i;                                     \
+    for (count_ = 0; count_ <= MAX_COLS; count_ ++) {           \
+      randomValues(a, count_);                                          \
+      randomValues(b, count_);                                          \
+      for (i = 0; i < count_; i ++) {                           \
+        b[i] = (b[i] == 0 ? 0.5 : b[i]);                        \
+        expected[i] = (expectedValue);                          \
+      }                                                         \
+      call(count_);                                             \
+      for (i = 0; i < count_; i ++) {                           \
+        expectNeighborhood(c[i], expected[i], 1e-12);           \
+      }                                                         \
+      inPlaceCall(count_);                                      \
+      for (i = 0; i < count_; i ++) {                           \
+        expectNeighborhood(a[i], expected[i], 1e-12);           \
+      }                                                         \
+    }                                                           \
+  } while (0)
+
+#define scaleInto(count)      anmatKernels->scale(a, -1.5, c, count)
+#define scaleInPlace(count)   anmatKernels->scale(a, -1.5, a, count)
+#define axpbyInto(count)      anmatKernels->axpby(a, 3, b, -2, c, count)
+#define axpbyInPlace(count)   anmatKernels->axpby(a, 3, b, -2, a, count)
+#define multiplyInto(count)   anmatKernels->multiply(a, b, c, count)
+#define multiplyInPlace(count) anmatKernels->multiply(a, b, a, count)
+#define divideInto(count)     anmatKernels->divide(a, b, c, count)
+#define divideInPlace(count)  anmatKernels->divide(a, b, a, count)
+#define clampInto(count)      anmatKernels->clamp(a, -5, 7.25, c, count)
+#define clampInPlace(count)   anmatKernels->clamp(a, -5, 7.25, a, count)
+
+static int elementwiseTest(void)
+{
+  unsigned int levelI;
+
+  srand(1);
+  FOR_SUPPORTED_LEVEL(levelI) {
+    checkElementwise(scaleInto, scaleInPlace, -1.5 * a[i]);
+    checkElementwise(axpbyInto, axpbyInPlace, (3 * a[i]) + (-2 * b[i]));
+    checkElementwise(multiplyInto, multiplyInPlace, a[i] * b[i]);
+    checkElementwise(divideInto, divideInPlace, a[i] / b[i]);
+    checkElementwise(clampInto, clampInPlace,
+                     (a[i] < -5 ? -5 : (a[i] > 7.25 ? 7.25 : a[i])));
+
+    // NaN's make it through a clamp.
+    a[0] = a[1] = a[2] = a[3] = a[4] = a[5] = a[6] = a[7] = 0.0 / 0.0;
+    anmatKernels->clamp(a, -1, 1, c, 8);
+    expect(c[0] != c[0] && c[7] != c[7]);
+  }
+
+  return 0;
+}
+
+static int transposeTest(void)
+{
+  unsigned int levelI, rows, cols, rowI, colI;
+  unsigned int lda, ldb;
+
+  srand(2);
+  FOR_SUPPORTED_LEVEL(levelI) {
+    for (rows = 1; rows <= MAX_ROWS; rows += 4) {
+      for (cols = 1; cols <= MAX_COLS; cols += 3) {
+        lda = cols + PAD;
+        ldb = rows + PAD;
+        randomValues(a, rows * lda);
+        randomValues(b, cols * ldb);
+
+        // The padding must not be touched.
+        for (colI = 0; colI < cols * ldb; colI ++) {
+          expected[colI] = b[colI];
+        }
+        for (rowI = 0; rowI < rows; rowI ++) {
+          for (colI = 0; colI < cols; colI ++) {
+            expected[(colI * ldb) + rowI] = a[(rowI * lda) + colI];
+          }
+        }
+
+        anmatKernels->transpose(a, lda, b, ldb, rows, cols);
+        for (colI = 0; colI < cols * ldb; colI ++) {
+          expectEquals(b[colI], expected[colI]);
+        }
+      }
+    }
+  }
+
+  return 0;
+}
+
+static int reduceTest(void)
+{
+  unsigned int levelI, count, i;
+  double sum, dot;
+
+  srand(3);
+  FOR_SUPPORTED_LEVEL(levelI) {
+    for (count = 0; count <= MAX_ROWS * MAX_COLS; count += 37) {
+      randomValues(a, count);
+      randomValues(b, count);
+      sum = dot = 0;
+      for (i = 0; i < count; i ++) {
+        sum += a[i];
+        dot += a[i] * b[i];
+      }
+
+      expectNeighborhood(anmatKernels->sum(a, count), sum, 1e-9);
+      expectNeighborhood(anmatKernels->dot(a, b, count), dot, 1e-9);
+    }
+  }
+
+  return 0;
+}
+
+// The micro kernel is only ever called through gemm, so check it that way,
+// on sizes around each level's tile.
+static int gemmTest(void)
+{
+  unsigned int levelI, m, n, k, rowI, colI, p;
+  unsigned int lda, ldb, ldc;
+  double total;
+
+  srand(4);
+  FOR_SUPPORTED_LEVEL(levelI) {
+    for (m = 1; m <= 2 * KERNEL_MAX_MR + 1; m += 3) {
+      for (n = 1; n <= 2 * KERNEL_MAX_NR + 1; n += 5) {
+        k = m + n;
+        lda = k + PAD;
+        ldb = n + PAD;
+        ldc = n + PAD;
+        randomValues(a, m * lda);
+        randomValues(b, k * ldb);
+        randomValues(c, m * ldc);
+
+        for (rowI = 0; rowI < m; rowI ++) {
+          for (colI = 0; colI < n; colI ++) {
+            total = 0;
+            for (p = 0; p < k; p ++) {
+              total += a[(rowI * lda) + p] * b[(p * ldb) + colI];
+            }
+            expected[(rowI * n) + colI] = (total
+                                           - (0.5 * c[(rowI * ldc) + colI]));
+          }
+        }
+
+        expectEquals(anmatGemm(m, n, k, 1, a, lda, b, ldb, -0.5, c, ldc),
+                     ANMAT_SUCCESS);
+        for (rowI = 0; rowI < m; rowI ++) {
+          for (colI = 0; colI < n; colI ++) {
+            expectNeighborhood(c[(rowI * ldc) + colI],
+                               expected[(rowI * n) + colI],
+                               1e-9);
+          }
+        }
+      }
+    }
+  }
+
+  return 0;
+}
+
+int main(void)
+{
+  announce();
+
+  run(levelTest);
+  run(elementwiseTest);
+  run(transposeTest);
+  run(reduceTest);
+  run(gemmTest);
+
+  anmatSimdLevelSet(ANMAT_SIMD_AUTO);
+
+  return 0;
+}
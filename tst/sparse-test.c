@@ -0,0 +1,389 @@
+//
+// sparse-test.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Sparse matrix unit test.
+//
+
+#include <unit-test.h>
+#include <stdlib.h>   // srand(), rand()
+
+#include "matrix.h"
+#include "sparse.h"
+#include "stat.h"
+#include "thread.h"
+
+#include "./test-util.h"
+
+// A rows x cols dense matrix with about one value in density that is not 0.
+static int fill(AnmatMatrix_t *matrix,
+                unsigned int rows,
+                unsigned int cols,
+                unsigned int density)
+{
+  unsigned int rowI, colI;
+
+  expectEquals(anmatMatrixAlloc(matrix, rows, cols), ANMAT_SUCCESS);
+  for (rowI = 0; rowI < rows; rowI ++) {
+    for (colI = 0; colI < cols; colI ++) {
+      if (rand() % density == 0) {
+        anmatMatrixData(matrix, rowI, colI) = randomValue();
+      }
+    }
+  }
+
+  return 0;
+}
+
+// Check that a sparse matrix is well formed, and holds the same values as a
+// dense one.
+static int check(AnmatSparse_t *sparse, AnmatMatrix_t *matrix)
+{
+  AnmatMatrix_t dense;
+  unsigned int majors, majorI;
+  size_t valueI;
+
+  majors = (sparse->format == ANMAT_SPARSE_CSR ? sparse->rows : sparse->cols);
+  expectEquals(sparse->starts[0], 0);
+  expectEquals(sparse->starts[majors], anmatSparseCount(sparse));
+  for (majorI = 0; majorI < majors; majorI ++) {
+    for (valueI = sparse->starts[majorI] + 1;
+         valueI < sparse->starts[majorI + 1];
+         valueI ++) {
+      expect(sparse->indices[valueI - 1] < sparse->indices[valueI]);
+    }
+  }
+
+  expectEquals(anmatMatrixAlloc(&dense, sparse->rows, sparse->cols),
+               ANMAT_SUCCESS);
+  expectEquals(anmatSparseToDense(sparse, &dense), ANMAT_SUCCESS);
+  expect(anmatMatrixEquals(&dense, matrix));
+  anmatMatrixFree(&dense);
+
+  return 0;
+}
+
+static int badArgTest(void)
+{
+  unsigned int rowIs[] = { 0, 1, }, colIs[] = { 0, 2, };
+  double values[] = { 1, 2, };
+  AnmatSparse_t sparse, other, product;
+  AnmatMatrix_t matrix;
+  AnmatVector_t vector;
+
+  expectEquals(anmatSparseFromTriplets(&sparse, (AnmatSparseFormat_t)2,
+                                       2, 3, 2, rowIs, colIs, values),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatSparseFromTriplets(&sparse, ANMAT_SPARSE_CSR,
+                                       0, 3, 2, rowIs, colIs, values),
+               ANMAT_BAD_ARG);
+
+  // A triplet outside of the matrix.
+  expectEquals(anmatSparseFromTriplets(&sparse, ANMAT_SPARSE_CSR,
+                                       2, 2, 2, rowIs, colIs, values),
+               ANMAT_BAD_ARG);
+
+  // Nothing was allocated.
+  expectHeapEmpty();
+
+  expectEquals(anmatSparseFromTriplets(&sparse, ANMAT_SPARSE_CSR,
+                                       2, 3, 2, rowIs, colIs, values),
+               ANMAT_SUCCESS);
+  expectEquals(anmatSparseFromTriplets(&other, ANMAT_SPARSE_CSC,
+                                       3, 2, 2, colIs, rowIs, values),
+               ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&matrix, 3, 3), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAlloc(&vector, 2), ANMAT_SUCCESS);
+
+  expectEquals(anmatSparseToDense(&sparse, &matrix), ANMAT_BAD_ARG);
+  expectEquals(anmatSparseMultiplyVector(&sparse, &vector, &vector),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatSparseMultiplyDense(&sparse, &matrix, &matrix),
+               ANMAT_BAD_ARG);
+  expectEquals(anmatSparseConvert(&sparse, (AnmatSparseFormat_t)2, &other),
+               ANMAT_BAD_ARG);
+
+  // The formats have to match.
+  expectEquals(anmatSparseMultiply(&sparse, &other, &product), ANMAT_BAD_ARG);
+
+  anmatSparseFree(&sparse);
+  anmatSparseFree(&other);
+  anmatMatrixFree(&matrix);
+  anmatVectorFree(&vector);
+
+  expectHeapEmpty();
+
+  return 0;
+}
+
+static int tripletTest(void)
+{
+  // [ 1 0 0 2 ]
+  // [ 0 0 0 0 ]
+  // [ 0 3 4 0 ]
+  // in no order, with (2, 1) in two pieces and a 0 at (1, 1).
+  unsigned int rowIs[] = { 2, 0, 2, 1, 0, 2, };
+  unsigned int colIs[] = { 2, 3, 1, 1, 0, 1, };
+  double values[] = { 4, 2, 1, 0, 1, 2, };
+  AnmatSparse_t sparse;
+
+  // CSR.
+  expectEquals(anmatSparseFromTriplets(&sparse, ANMAT_SPARSE_CSR,
+                                       3, 4, 6, rowIs, colIs, values),
+               ANMAT_SUCCESS);
+  expectEquals(anmatSparseRowCount(&sparse), 3);
+  expectEquals(anmatSparseColCount(&sparse), 4);
+  expectEquals(anmatSparseCount(&sparse), 5);
+  expectEquals(sparse.starts[1], 2);
+  expectEquals(sparse.starts[2], 3);
+  expectEquals(sparse.starts[3], 5);
+  expectEquals(sparse.indices[0], 0);
+  expectEquals(sparse.indices[1], 3);
+  expectEquals(sparse.indices[2], 1);
+  expectEquals(sparse.indices[3], 1);
+  expectEquals(sparse.indices[4], 2);
+  expectEquals(sparse.values[1], 2);
+  expectEquals(sparse.values[2], 0);
+  expectEquals(sparse.values[3], 3);
+  anmatSparseFree(&sparse);
+
+  // CSC.
+  expectEquals(anmatSparseFromTriplets(&sparse, ANMAT_SPARSE_CSC,
+                                       3, 4, 6, rowIs, colIs, values),
+               ANMAT_SUCCESS);
+  expectEquals(anmatSparseCount(&sparse), 5);
+  expectEquals(sparse.starts[1], 1);
+  expectEquals(sparse.starts[2], 3);
+  expectEquals(sparse.starts[3], 4);
+  expectEquals(sparse.starts[4], 5);
+  expectEquals(sparse.indices[1], 1);
+  expectEquals(sparse.indices[2], 2);
+  expectEquals(sparse.values[2], 3);
+  expectEquals(sparse.values[4], 2);
+  anmatSparseFree(&sparse);
+
+  // No triplets at all.
+  expectEquals(anmatSparseFromTriplets(&sparse, ANMAT_SPARSE_CSR,
+                                       3, 4, 0, NULL, NULL, NULL),
+               ANMAT_SUCCESS);
+  expectEquals(anmatSparseCount(&sparse), 0);
+  expectEquals(sparse.starts[3], 0);
+  anmatSparseFree(&sparse);
+
+  expectHeapEmpty();
+
+  return 0;
+}
+
+static int denseTest(void)
+{
+  AnmatMatrix_t matrix;
+  AnmatSparse_t csr, csc, converted;
+
+  srand(1);
+  expect(!fill(&matrix, 37, 53, 5));
+
+  expectEquals(anmatSparseFromDense(&csr, ANMAT_SPARSE_CSR, &matrix),
+               ANMAT_SUCCESS);
+  expect(!check(&csr, &matrix));
+  expectEquals(anmatSparseFromDense(&csc, ANMAT_SPARSE_CSC, &matrix),
+               ANMAT_SUCCESS);
+  expect(!check(&csc, &matrix));
+  expectEquals(anmatSparseCount(&csc), anmatSparseCount(&csr));
+
+  expectEquals(anmatSparseConvert(&csr, ANMAT_SPARSE_CSC, &converted),
+               ANMAT_SUCCESS);
+  expectEquals(converted.format, ANMAT_SPARSE_CSC);
+  expect(!check(&converted, &matrix));
+  anmatSparseFree(&converted);
+  expectEquals(anmatSparseConvert(&csc, ANMAT_SPARSE_CSR, &converted),
+               ANMAT_SUCCESS);
+  expect(!check(&converted, &matrix));
+  anmatSparseFree(&converted);
+  expectEquals(anmatSparseConvert(&csc, ANMAT_SPARSE_CSC, &converted),
+               ANMAT_SUCCESS);
+  expect(!check(&converted, &matrix));
+  anmatSparseFree(&converted);
+
+  anmatSparseFree(&csr);
+  anmatSparseFree(&csc);
+  anmatMatrixFree(&matrix);
+
+  expectHeapEmpty();
+
+  return 0;
+}
+
+// Check every multiply, in both formats, against the dense ones.
+static int checkMultiplies(unsigned int m,
+                           unsigned int n,
+                           unsigned int k,
+                           unsigned int density)
+{
+  AnmatSparseFormat_t format;
+  AnmatMatrix_t matrixA, matrixB, expected, actual, matrixX;
+  AnmatVector_t vectorX, vectorY;
+  AnmatSparse_t sparseA, sparseB, sparseC;
+  unsigned int rowI;
+  double dot;
+
+  expect(!fill(&matrixA, m, k, density));
+  expect(!fill(&matrixB, k, n, density));
+  expectEquals(anmatMatrixAlloc(&expected, m, n), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&actual, m, n), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixMultiply(&matrixA, &matrixB, &expected),
+               ANMAT_SUCCESS);
+
+  // x is the first column of B.
+  expectEquals(anmatVectorAlloc(&vectorX, k), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAlloc(&vectorY, m), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixColRange(&matrixX, &matrixB, 0, 1), ANMAT_SUCCESS);
+  for (rowI = 0; rowI < k; rowI ++) {
+    anmatVectorData(&vectorX, rowI) = anmatMatrixData(&matrixX, rowI, 0);
+  }
+
+  for (format = ANMAT_SPARSE_CSR; format <= ANMAT_SPARSE_CSC; format ++) {
+    expectEquals(anmatSparseFromDense(&sparseA, format, &matrixA),
+                 ANMAT_SUCCESS);
+    expectEquals(anmatSparseFromDense(&sparseB, format, &matrixB),
+                 ANMAT_SUCCESS);
+
+    expectEquals(anmatSparseMultiplyVector(&sparseA, &vectorX, &vectorY),
+                 ANMAT_SUCCESS);
+    for (rowI = 0; rowI < m; rowI ++) {
+      dot = anmatMatrixData(&expected, rowI, 0);
+      expectNeighborhood(anmatVectorData(&vectorY, rowI), dot, 1e-9);
+    }
+
+    expectEquals(anmatSparseMultiplyDense(&sparseA, &matrixB, &actual),
+                 ANMAT_SUCCESS);
+    expect(anmatMatrixEquals(&actual, &expected));
+
+    expectEquals(anmatSparseMultiply(&sparseA, &sparseB, &sparseC),
+                 ANMAT_SUCCESS);
+    expectEquals(sparseC.format, format);
+    expect(!check(&sparseC, &expected));
+
+    anmatSparseFree(&sparseA);
+    anmatSparseFree(&sparseB);
+    anmatSparseFree(&sparseC);
+  }
+
+  anmatMatrixFree(&matrixA);
+  anmatMatrixFree(&matrixB);
+  anmatMatrixFree(&expected);
+  anmatMatrixFree(&actual);
+  anmatVectorFree(&vectorX);
+  anmatVectorFree(&vectorY);
+
+  return 0;
+}
+
+static int multiplyTest(void)
+{
+  srand(2);
+
+  expect(!checkMultiplies(1, 1, 1, 1));
+  expect(!checkMultiplies(5, 7, 3, 2));
+  expect(!checkMultiplies(37, 53, 41, 4));
+  expect(!checkMultiplies(64, 17, 80, 10));
+
+  // Rows and columns with nothing in them.
+  expect(!checkMultiplies(30, 30, 30, 50));
+
+  expectHeapEmpty();
+
+  return 0;
+}
+
+static int threadTest(void)
+{
+  srand(3);
+
+  // Split every multiply up.
+  anmatThreadCountSet(3);
+  anmatThreadThresholdSet(1);
+
+  expect(!checkMultiplies(37, 53, 41, 4));
+  expect(!checkMultiplies(2, 100, 3, 2));
+
+  anmatThreadThresholdSet(0);
+  anmatThreadCountSet(0);
+
+  return 0;
+}
+
+// Too big to be dense: a 100k x 100k tridiagonal matrix, with 2's on the
+// diagonal and -1's next to it.
+#define BIG (100000)
+
+static int bigTest(void)
+{
+  static unsigned int rowIs[3 * BIG], colIs[3 * BIG];
+  static double values[3 * BIG];
+  AnmatSparse_t sparse, squared;
+  AnmatVector_t vectorX, vectorY;
+  unsigned int i, count = 0;
+
+  for (i = 0; i < BIG; i ++) {
+    rowIs[count] = i, colIs[count] = i, values[count ++] = 2;
+    if (i > 0) {
+      rowIs[count] = i, colIs[count] = i - 1, values[count ++] = -1;
+    }
+    if (i < BIG - 1) {
+      rowIs[count] = i, colIs[count] = i + 1, values[count ++] = -1;
+    }
+  }
+  expectEquals(anmatSparseFromTriplets(&sparse, ANMAT_SPARSE_CSR, BIG, BIG,
+                                       count, rowIs, colIs, values),
+               ANMAT_SUCCESS);
+  expectEquals(anmatSparseCount(&sparse), (3 * BIG) - 2);
+
+  // It takes a straight line to 0, except at the ends.
+  expectEquals(anmatVectorAlloc(&vectorX, BIG), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAlloc(&vectorY, BIG), ANMAT_SUCCESS);
+  for (i = 0; i < BIG; i ++) {
+    anmatVectorData(&vectorX, i) = i + 1;
+  }
+  expectEquals(anmatSparseMultiplyVector(&sparse, &vectorX, &vectorY),
+               ANMAT_SUCCESS);
+  expectEquals(anmatVectorData(&vectorY, 0), 0);
+  expectEquals(anmatVectorData(&vectorY, BIG / 2), 0);
+  expectEquals(anmatVectorData(&vectorY, BIG - 1), BIG + 1);
+
+  // The square is pentadiagonal: 1, -4, 6, -4, 1.
+  expectEquals(anmatSparseMultiply(&sparse, &sparse, &squared),
+               ANMAT_SUCCESS);
+  expectEquals(anmatSparseCount(&squared), (5 * BIG) - 6);
+  expectEquals(squared.starts[BIG / 2 + 1] - squared.starts[BIG / 2], 5);
+  expectEquals(squared.indices[squared.starts[BIG / 2]], BIG / 2 - 2);
+  expectEquals(squared.values[squared.starts[BIG / 2]], 1);
+  expectEquals(squared.values[squared.starts[BIG / 2] + 1], -4);
+  expectEquals(squared.values[squared.starts[BIG / 2] + 2], 6);
+
+  anmatSparseFree(&sparse);
+  anmatSparseFree(&squared);
+  anmatVectorFree(&vectorX);
+  anmatVectorFree(&vectorY);
+
+  expectHeapEmpty();
+
+  return 0;
+}
+
+int main(void)
+{
+  announce();
+
+  run(badArgTest);
+  run(tripletTest);
+  run(denseTest);
+  run(multiplyTest);
+  run(threadTest);
+  run(bigTest);
+
+  return 0;
+}
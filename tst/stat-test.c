@@ -26,6 +26,7 @@ static int allocTest(void)
 
   // Allocate a vector for real.
   expectEquals(anmatVectorAlloc(&vector, 5), ANMAT_SUCCESS);
+  expectAligned(vector.data, ANMAT_DATA_ALIGNMENT);
 
   // Some bytes should be gone from heap.
   expectHeapSize(HEAP_SIZE
@@ -119,6 +120,42 @@ static int averageTest(void)
   return 0;
 }
 
+static int dotTest(void)
+{
+  AnmatVector_t vectorA, vectorB, vectorC;
+  unsigned int valueI;
+  double dot = 0;
+
+  // Heap should be full.
+  expectHeapEmpty();
+
+  // Alloc.
+  expectEquals(anmatVectorAlloc(&vectorA, 19), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAlloc(&vectorB, 19), ANMAT_SUCCESS);
+  expectEquals(anmatVectorAlloc(&vectorC, 5), ANMAT_SUCCESS);
+
+  // Lengths have to match.
+  expectEquals(anmatVectorDot(&vectorA, &vectorC, &dot), ANMAT_BAD_ARG);
+
+  // 1*19 + 2*18 + ... + 19*1.
+  for (valueI = 0; valueI < 19; valueI ++) {
+    anmatVectorData(&vectorA, valueI) = valueI + 1;
+    anmatVectorData(&vectorB, valueI) = 19 - valueI;
+  }
+  expectEquals(anmatVectorDot(&vectorA, &vectorB, &dot), ANMAT_SUCCESS);
+  expectEquals(dot, 1330);
+
+  // Free.
+  anmatVectorFree(&vectorA);
+  anmatVectorFree(&vectorB);
+  anmatVectorFree(&vectorC);
+
+  // Heap should be full.
+  expectHeapEmpty();
+
+  return 0;
+}
+
 int main(void)
 {
   announce();
@@ -126,6 +163,7 @@ int main(void)
   run(allocTest);
   run(dataTest);
   run(averageTest);
+  run(dotTest);
 
   return 0;
 }
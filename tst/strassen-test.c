@@ -0,0 +1,148 @@
+//
+// strassen-test.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Strassen-Winograd matrix multiply test.
+//
+
+#include <unit-test.h>
+#include <stdlib.h>   // srand()
+
+#include "matrix.h"
+#include "src/gemm.h"
+#include "src/strassen.h"
+
+#include "./test-util.h"
+
+// Multiply m x k by k x n with Strassen-Winograd, and check it against gemm.
+static int check(unsigned int m, unsigned int n, unsigned int k)
+{
+  AnmatMatrix_t matrixA, matrixB, expected, actual;
+  AnmatArena_t *scratch = anmatArenaScratch();
+  AnmatArenaMark_t mark;
+  AnmatStrassenConfig_t config = { true, ANMAT_STRASSEN_CROSSOVER_MIN, };
+  unsigned int rowI, colI;
+  double bound, gemmBound;
+
+  expectEquals(anmatMatrixAlloc(&matrixA, m, k), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&matrixB, k, n), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&expected, m, n), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&actual, m, n), ANMAT_SUCCESS);
+  randomFill(&matrixA);
+  randomFill(&matrixB);
+  randomFill(&actual);
+
+  expectEquals(anmatGemm(m, n, k,
+                    1, matrixA.data, matrixA.stride,
+                    matrixB.data, matrixB.stride,
+                    0, expected.data, expected.stride),
+               ANMAT_SUCCESS);
+  gemmBound = anmatMatrixMultiplyErrorBound(&matrixA, &matrixB);
+
+  // The temporaries all go back to the scratch arena.
+  mark = anmatArenaMark(scratch);
+  expectEquals(anmatMatrixStrassenSet(&config), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixMultiply(&matrixA, &matrixB, &actual),
+               ANMAT_SUCCESS);
+  expect(anmatArenaMark(scratch).chunk == mark.chunk);
+  expect(anmatArenaMark(scratch).used == mark.used);
+
+  // Both results are within their bounds of the exact one, so they are
+  // within the sum of the bounds of each other.
+  bound = anmatMatrixMultiplyErrorBound(&matrixA, &matrixB);
+  expect(bound >= gemmBound);
+  for (rowI = 0; rowI < m; rowI ++) {
+    for (colI = 0; colI < n; colI ++) {
+      expectNeighborhood(anmatMatrixData(&actual, rowI, colI),
+                         anmatMatrixData(&expected, rowI, colI),
+                         bound + gemmBound);
+    }
+  }
+
+  expectEquals(anmatMatrixStrassenSet(NULL), ANMAT_SUCCESS);
+
+  anmatMatrixFree(&matrixA);
+  anmatMatrixFree(&matrixB);
+  anmatMatrixFree(&expected);
+  anmatMatrixFree(&actual);
+
+  return 0;
+}
+
+static int configTest(void)
+{
+  AnmatStrassenConfig_t config;
+
+  // Off by default.
+  anmatMatrixStrassenGet(&config);
+  expect(!config.enabled);
+  expectEquals(config.crossover, ANMAT_STRASSEN_CROSSOVER_DEFAULT);
+
+  // The crossover cannot be too small.
+  config.enabled = true;
+  config.crossover = ANMAT_STRASSEN_CROSSOVER_MIN - 1;
+  expectEquals(anmatMatrixStrassenSet(&config), ANMAT_BAD_ARG);
+  anmatMatrixStrassenGet(&config);
+  expect(!config.enabled);
+
+  config.enabled = true;
+  config.crossover = 100;
+  expectEquals(anmatMatrixStrassenSet(&config), ANMAT_SUCCESS);
+  anmatMatrixStrassenGet(&config);
+  expect(config.enabled);
+  expectEquals(config.crossover, 100);
+
+  // NULL is the default.
+  expectEquals(anmatMatrixStrassenSet(NULL), ANMAT_SUCCESS);
+  anmatMatrixStrassenGet(&config);
+  expect(!config.enabled);
+  expectEquals(config.crossover, ANMAT_STRASSEN_CROSSOVER_DEFAULT);
+
+  return 0;
+}
+
+static int levelsTest(void)
+{
+  unsigned int leafK;
+
+  // Split while everything is bigger than the crossover.
+  expectEquals(anmatStrassenLevels(16, 100, 100, 100, &leafK), 3);
+  expectEquals(leafK, 12);
+  expectEquals(anmatStrassenLevels(16, 100, 16, 100, &leafK), 0);
+  expectEquals(leafK, 100);
+  expectEquals(anmatStrassenLevels(16, 17, 1000, 1000, NULL), 1);
+
+  return 0;
+}
+
+static int multiplyTest(void)
+{
+  srand(1);
+
+  // Too small to split.
+  expect(!check(9, 9, 9));
+
+  // Even all the way down.
+  expect(!check(64, 64, 64));
+
+  // Odd rows, cols and inner dimension to peel off, at more than one level.
+  expect(!check(67, 83, 45));
+  expect(!check(100, 37, 50));
+  expect(!check(35, 35, 35));
+
+  return 0;
+}
+
+int main(void)
+{
+  announce();
+
+  run(configTest);
+  run(levelsTest);
+  run(multiplyTest);
+
+  return 0;
+}
@@ -18,7 +18,43 @@
 #define expectHeapFull()     (expectEquals(heapFreeBytesCount, 0))
 #define expectHeapEmpty()    (expectEquals(heapFreeBytesCount, HEAP_SIZE))
 
+#define expectAligned(pointer, alignment) \
+  (expectEquals(((uintptr_t)(pointer)) & ((alignment) - 1), 0))
+
 // -----------------------------------------------------------------------------
 // Util
 
 #define expectNeighborhood(a, b, e) expect(anmatUtilNeighborhood(a, b, e))
+
+// -----------------------------------------------------------------------------
+// Random
+
+#include <stdlib.h> // rand()
+
+// Get a random value in [-14, 14), from rand() (so seed it with srand()).
+static inline double randomValue(void)
+{
+  return (rand() % 200) / 7.0 - 14.0;
+}
+
+// Fill count values with random values.
+static inline void randomValues(double *values, size_t count)
+{
+  while (count--) {
+    values[count] = randomValue();
+  }
+}
+
+#include "matrix.h"
+
+// Fill a matrix with random values.
+static inline void randomFill(AnmatMatrix_t *matrix)
+{
+  unsigned int rowI, colI;
+
+  for (rowI = 0; rowI < anmatMatrixRowCount(matrix); rowI ++) {
+    for (colI = 0; colI < anmatMatrixColCount(matrix); colI ++) {
+      anmatMatrixData(matrix, rowI, colI) = randomValue();
+    }
+  }
+}
@@ -0,0 +1,224 @@
+//
+// thread-test.c
+//
+// Andrew Keesler
+//
+// October 17, 2026
+//
+// Thread unit test.
+//
+// The threshold is turned all the way down so that even small matrices are
+// split up, and results are checked to be exactly the same (not just close)
+// for every thread count.
+//
+
+#include <unit-test.h>
+#include <stdlib.h>   // srand()
+#include <string.h>   // memcmp()
+
+#include "matrix.h"
+#include "thread.h"
+#include "src/pool.h"
+
+#include "./test-util.h"
+
+static const unsigned int threadCounts[] = { 1, 2, 3, 4, 7, 16, };
+#define THREAD_COUNT_COUNT (sizeof(threadCounts) / sizeof(threadCounts[0]))
+
+// Whether two matrices have exactly the same values.
+static bool same(AnmatMatrix_t *matrixA, AnmatMatrix_t *matrixB)
+{
+  unsigned int rowI;
+
+  for (rowI = 0; rowI < anmatMatrixRowCount(matrixA); rowI ++) {
+    if (memcmp(anmatMatrixRow(matrixA, rowI),
+               anmatMatrixRow(matrixB, rowI),
+               anmatMatrixColCount(matrixA) * sizeof(double))) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static int countTest(void)
+{
+  // There is always at least one.
+  expect(anmatThreadCountGet() >= 1);
+
+  expectEquals(anmatThreadCountSet(4), ANMAT_SUCCESS);
+  expectEquals(anmatThreadCountGet(), 4);
+  expectEquals(anmatThreadCountSet(ANMAT_THREAD_MAX + 1), ANMAT_BAD_ARG);
+  expectEquals(anmatThreadCountGet(), 4);
+
+  // 0 is one per processor.
+  expectEquals(anmatThreadCountSet(0), ANMAT_SUCCESS);
+  expect(anmatThreadCountGet() >= 1);
+
+  // 0 is the default threshold.
+  anmatThreadThresholdSet(10);
+  expectEquals(anmatThreadThresholdGet(), 10);
+  anmatThreadThresholdSet(0);
+  expectEquals(anmatThreadThresholdGet(), ANMAT_THREAD_THRESHOLD_DEFAULT);
+
+  // Small work stays serial, and nothing is split across more threads than
+  // there are.
+  expectEquals(anmatThreadCountSet(4), ANMAT_SUCCESS);
+  anmatThreadThresholdSet(100);
+  expectEquals(anmatPoolTaskCount(199), 1);
+  expectEquals(anmatPoolTaskCount(300), 3);
+  expectEquals(anmatPoolTaskCount(1 << 20), 4);
+  expectEquals(anmatThreadCountSet(1), ANMAT_SUCCESS);
+  expectEquals(anmatPoolTaskCount(1 << 20), 1);
+
+  return 0;
+}
+
+static int splitTest(void)
+{
+  unsigned int taskI, start, end, last;
+
+  // Every row is covered once, and ranges start on multiples.
+  last = 0;
+  for (taskI = 0; taskI < 5; taskI ++) {
+    anmatPoolSplit(37, 8, taskI, 5, &start, &end);
+    expectEquals(start, last);
+    expectEquals(start % 8, 0);
+    last = end;
+  }
+  expectEquals(last, 37);
+
+  // More tasks than things to do.
+  anmatPoolSplit(3, 1, 9, 10, &start, &end);
+  expectEquals(end - start, 1);
+  anmatPoolSplit(3, 1, 0, 10, &start, &end);
+  expectEquals(end - start, 0);
+
+  return 0;
+}
+
+static int multiplyTest(void)
+{
+  AnmatMatrix_t matrixA, matrixB, expected, actual;
+  unsigned int countI;
+
+  srand(1);
+  anmatThreadThresholdSet(1);
+
+  // Not a multiple of any tile, so that blocks have edges.
+  expectEquals(anmatMatrixAlloc(&matrixA, 67, 45), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&matrixB, 45, 83), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&expected, 67, 83), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&actual, 67, 83), ANMAT_SUCCESS);
+  randomFill(&matrixA);
+  randomFill(&matrixB);
+
+  expectEquals(anmatThreadCountSet(1), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixMultiply(&matrixA, &matrixB, &expected),
+               ANMAT_SUCCESS);
+
+  for (countI = 0; countI < THREAD_COUNT_COUNT; countI ++) {
+    expectEquals(anmatThreadCountSet(threadCounts[countI]), ANMAT_SUCCESS);
+    randomFill(&actual);
+    expectEquals(anmatMatrixMultiply(&matrixA, &matrixB, &actual),
+                 ANMAT_SUCCESS);
+    expect(same(&actual, &expected));
+  }
+
+  anmatMatrixFree(&matrixA);
+  anmatMatrixFree(&matrixB);
+  anmatMatrixFree(&expected);
+  anmatMatrixFree(&actual);
+
+  return 0;
+}
+
+static int elementTest(void)
+{
+  AnmatMatrix_t matrixA, matrixB, sum, difference, transpose;
+  AnmatMatrix_t expectedSum, expectedDifference, expectedTranspose;
+  unsigned int countI;
+
+  srand(2);
+  anmatThreadThresholdSet(1);
+
+  expectEquals(anmatMatrixAlloc(&matrixA, 29, 19), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&matrixB, 29, 19), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&sum, 29, 19), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&difference, 29, 19), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&transpose, 19, 29), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&expectedSum, 29, 19), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&expectedDifference, 29, 19), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAlloc(&expectedTranspose, 19, 29), ANMAT_SUCCESS);
+  randomFill(&matrixA);
+  randomFill(&matrixB);
+
+  expectEquals(anmatThreadCountSet(1), ANMAT_SUCCESS);
+  expectEquals(anmatMatrixAdd(&matrixA, &matrixB, &expectedSum),
+               ANMAT_SUCCESS);
+  expectEquals(anmatMatrixSubtract(&matrixA, &matrixB, &expectedDifference),
+               ANMAT_SUCCESS);
+  expectEquals(anmatMatrixTranspose(&matrixA, &expectedTranspose),
+               ANMAT_SUCCESS);
+
+  for (countI = 0; countI < THREAD_COUNT_COUNT; countI ++) {
+    expectEquals(anmatThreadCountSet(threadCounts[countI]), ANMAT_SUCCESS);
+    expectEquals(anmatMatrixAdd(&matrixA, &matrixB, &sum), ANMAT_SUCCESS);
+    expectEquals(anmatMatrixSubtract(&matrixA, &matrixB, &difference),
+                 ANMAT_SUCCESS);
+    expectEquals(anmatMatrixTranspose(&matrixA, &transpose), ANMAT_SUCCESS);
+    expect(same(&sum, &expectedSum));
+    expect(same(&difference, &expectedDifference));
+    expect(same(&transpose, &expectedTranspose));
+  }
+
+  anmatMatrixFree(&matrixA);
+  anmatMatrixFree(&matrixB);
+  anmatMatrixFree(&sum);
+  anmatMatrixFree(&difference);
+  anmatMatrixFree(&transpose);
+  anmatMatrixFree(&expectedSum);
+  anmatMatrixFree(&expectedDifference);
+  anmatMatrixFree(&expectedTranspose);
+
+  return 0;
+}
+
+// A task that starts a job of its own, which has to run serially.
+static unsigned int nestedCounts[8];
+
+static void innerTask(void *context, unsigned int taskI)
+{
+  __atomic_add_fetch(&nestedCounts[(uintptr_t)context], 1, __ATOMIC_RELAXED);
+}
+
+static void outerTask(void *context, unsigned int taskI)
+{
+  anmatPoolRun(innerTask, (void *)(uintptr_t)taskI, 5);
+}
+
+static int nestedTest(void)
+{
+  unsigned int taskI;
+
+  expectEquals(anmatThreadCountSet(4), ANMAT_SUCCESS);
+  anmatPoolRun(outerTask, NULL, 8);
+  for (taskI = 0; taskI < 8; taskI ++) {
+    expectEquals(nestedCounts[taskI], 5);
+  }
+
+  return 0;
+}
+
+int main(void)
+{
+  announce();
+
+  run(countTest);
+  run(splitTest);
+  run(multiplyTest);
+  run(elementTest);
+  run(nestedTest);
+
+  return 0;
+}